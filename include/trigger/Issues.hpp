@@ -37,6 +37,35 @@ ERS_DECLARE_ISSUE(trigger, TriggerEndOfRun, "End of run " << runno, ((int64_t)ru
 
 ERS_DECLARE_ISSUE(trigger, UnknownGeoID, "Unknown SourceID: " << source_id, ((daqdataformats::SourceID)source_id))
 ERS_DECLARE_ISSUE(trigger, InvalidSystemType, "Unknown system type " << type, ((std::string)type))
+ERS_DECLARE_ISSUE(trigger,
+                  BadTPReplayFile,
+                  "Problem with TP replay file " << filename << ": " << reason,
+                  ((std::string)filename)((std::string)reason))
+ERS_DECLARE_ISSUE(trigger, BadFlatTPSet, "Can't decode flat-encoded TPSet: " << reason, ((std::string)reason))
+ERS_DECLARE_ISSUE(trigger,
+                  BadCompactTPSet,
+                  "Can't decode compact-encoded TPSet: " << reason,
+                  ((std::string)reason))
+ERS_DECLARE_ISSUE(trigger,
+                  ShmRingError,
+                  "Problem with shared-memory ring " << ring_name << ": " << reason,
+                  ((std::string)ring_name)((std::string)reason))
+
+ERS_DECLARE_ISSUE(trigger,
+                  BadExecutorThreads,
+                  "Can't use DUNEDAQ_TRIGGER_EXECUTOR_THREADS=\"" << value << "\" as a number of threads, using "
+                                                                  << n_threads,
+                  ((std::string)value)((size_t)n_threads))
+
+ERS_DECLARE_ISSUE(trigger,
+                  InvalidThreadPlacement,
+                  "Invalid thread placement: " << reason,
+                  ((std::string)reason))
+
+ERS_DECLARE_ISSUE(trigger,
+                  ThreadPlacementFailed,
+                  who << ": couldn't apply thread placement: " << reason,
+                  ((std::string)who)((std::string)reason))
 
 ERS_DECLARE_ISSUE_BASE(trigger,
                        SignalTypeError,
@@ -142,6 +171,20 @@ ERS_DECLARE_ISSUE_BASE(trigger,
                        ((std::string)name),
                        ((std::string)filename))
 
+ERS_DECLARE_ISSUE_BASE(trigger,
+                       InvalidSpeedProfile,
+                       appfwk::GeneralDAQModuleIssue,
+                       "Invalid replay speed profile: " << reason,
+                       ((std::string)name),
+                       ((std::string)reason))
+
+ERS_DECLARE_ISSUE_BASE(trigger,
+                       InvalidLoadProfile,
+                       appfwk::GeneralDAQModuleIssue,
+                       "Invalid TC load profile: " << reason,
+                       ((std::string)name),
+                       ((std::string)reason))
+
 ERS_DECLARE_ISSUE_BASE(trigger,
                        UnsortedTP,
                        appfwk::GeneralDAQModuleIssue,
@@ -176,6 +219,28 @@ ERS_DECLARE_ISSUE_BASE(trigger,
                        ((std::string)name),
                        ((size_t)received)((size_t)expected)((size_t)ts)((size_t)seq))
 
+ERS_DECLARE_ISSUE_BASE(trigger,
+                       ShmSetTooLarge,
+                       appfwk::GeneralDAQModuleIssue,
+                       "Set with seqno " << seqno << " doesn't fit in a slot of " << slot_size
+                                         << " bytes of shared-memory ring " << ring_name << ", and was dropped",
+                       ((std::string)name),
+                       ((uint64_t)seqno)((size_t)slot_size)((std::string)ring_name)) // NOLINT(build/unsigned)
+
+ERS_DECLARE_ISSUE_BASE(trigger,
+                       BadShmSet,
+                       appfwk::GeneralDAQModuleIssue,
+                       "Can't decode a set from shared-memory ring " << ring_name << ", which was dropped",
+                       ((std::string)name),
+                       ((std::string)ring_name))
+
+ERS_DECLARE_ISSUE_BASE(trigger,
+                       TCDropped,
+                       appfwk::GeneralDAQModuleIssue,
+                       "Dropped TC with time_candidate " << time_candidate << ": " << reason,
+                       ((std::string)name),
+                       ((triggeralgs::timestamp_t)time_candidate)((std::string)reason))
+
 } // namespace dunedaq
 
 #endif // TRIGGER_INCLUDE_TRIGGER_ISSUES_HPP_
@@ -0,0 +1,112 @@
+/**
+ * @file ShmRing.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_SHMRING_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_SHMRING_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief A ring of fixed-size slots in shared memory, for passing encoded sets between two processes on one host
+ *
+ * One process writes and one reads. The writer encodes an object
+ * straight into the next free slot and commits it; the reader decodes
+ * straight out of the oldest committed slot and then frees it, so an
+ * object crosses between the processes without any other copy. A side
+ * only sleeps, on a futex in the shared memory, once the ring is full
+ * or empty, and the other side only makes the system call to wake it if
+ * it's asleep.
+ *
+ * The shared memory outlives both processes, so either can be restarted
+ * and attach again. A slot is only visible to the reader once it has
+ * been committed, so a writer that dies part way through writing one
+ * loses that object and nothing else, and a slot is only reused once
+ * the reader has committed reading it, so a reader that dies part way
+ * through reading one gets it again when it's restarted. A role can be
+ * taken over from a process that has died, but not from one that's
+ * still running. remove() deletes the shared memory for good
+ */
+class ShmRing
+{
+public:
+  using duration_t = std::chrono::milliseconds;
+
+  enum class Role
+  {
+    kWriter,
+    kReader
+  };
+
+  // Attach to the ring called name, making it if it doesn't exist. The
+  // geometry must match that of an existing ring. Throws ShmRingError
+  // if that fails or another live process, or another ShmRing in this
+  // process, has the role
+  ShmRing(const std::string& name, Role role, size_t n_slots, size_t slot_size);
+  ~ShmRing();
+
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+  ShmRing(ShmRing&&) = delete;
+  ShmRing& operator=(ShmRing&&) = delete;
+
+  const std::string& get_name() const { return m_name; }
+  size_t n_slots() const { return m_n_slots; }
+  // The most bytes an object can take in a slot
+  size_t slot_size() const { return m_slot_size; }
+  // The number of committed slots that haven't been read
+  size_t size() const;
+
+  // Writer only. The next free slot, waiting up to timeout for one, or
+  // nullptr if the ring stayed full. Nothing is sent until commit_write()
+  uint8_t* begin_write(duration_t timeout); // NOLINT(build/unsigned)
+  // Writer only. Make the slot from begin_write(), holding size bytes, visible to the reader
+  void commit_write(size_t size);
+
+  // Reader only. The oldest committed slot, waiting up to timeout for
+  // one, or nullptr if the ring stayed empty. The slot stays valid, and
+  // begin_read() returns it again, until commit_read()
+  const uint8_t* begin_read(size_t& size, duration_t timeout); // NOLINT(build/unsigned)
+  // Reader only. Free the slot from begin_read()
+  void commit_read();
+
+  // Delete the shared memory of the ring called name. Processes still
+  // attached keep their mapping, but nothing new can attach to it
+  static void remove(const std::string& name);
+
+private:
+  struct Header;
+
+  uint8_t* slot(uint32_t pos) const; // NOLINT(build/unsigned)
+  // Wait until value isn't expected any more, or the deadline passes.
+  // waiting tells the other side that it has to wake us
+  bool wait_while(const std::atomic<uint32_t>& value, // NOLINT(build/unsigned)
+                  uint32_t expected,                  // NOLINT(build/unsigned)
+                  std::atomic<uint32_t>& waiting,     // NOLINT(build/unsigned)
+                  std::chrono::steady_clock::time_point deadline);
+  static void wake(std::atomic<uint32_t>& value, const std::atomic<uint32_t>& waiting); // NOLINT(build/unsigned)
+
+  std::string m_name;
+  Role m_role;
+  size_t m_n_slots;
+  size_t m_slot_size;
+  size_t m_slot_stride{ 0 };
+  size_t m_map_size{ 0 };
+  void* m_map{ nullptr };
+  Header* m_header{ nullptr };
+  uint8_t* m_slots{ nullptr }; // NOLINT(build/unsigned)
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_SHMRING_HPP_
@@ -0,0 +1,46 @@
+/**
+ * @file ShmSetCodec.hpp
+ *
+ * How sets are encoded in the slots of a ShmRing. Each set is written
+ * straight into its slot and read straight out of it, so the slot is
+ * the only buffer between the two processes
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_SHMSETCODEC_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_SHMSETCODEC_HPP_
+
+#include "trigger/TASet.hpp"
+#include "trigger/TPSet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dunedaq::trigger {
+
+// TPSets use the flat encoding, so decoding one is a single copy of its
+// TPs into the set's objects vector. Returns the number of bytes
+// written, or 0 if the TPSet doesn't fit
+size_t
+encode_shm_set(const TPSet& tpset, uint8_t* buffer, size_t capacity); // NOLINT(build/unsigned)
+
+// Reuses the TPSet's objects vector. Throws BadFlatTPSet if the data isn't a flat-encoded TPSet
+void
+decode_shm_set(const uint8_t* data, size_t size, TPSet& tpset); // NOLINT(build/unsigned)
+
+// TASets use the msgpack encoding with shared TPs from
+// TASetSharedTPs.hpp, packed straight into the slot. Returns the number
+// of bytes written, or 0 if the TASet doesn't fit
+size_t
+encode_shm_set(const TASet& taset, uint8_t* buffer, size_t capacity); // NOLINT(build/unsigned)
+
+// Throws a msgpack exception if the data isn't a msgpack-encoded TASet
+void
+decode_shm_set(const uint8_t* data, size_t size, TASet& taset); // NOLINT(build/unsigned)
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_SHMSETCODEC_HPP_
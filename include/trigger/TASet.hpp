@@ -12,9 +12,12 @@
 #include "dfmessages/SourceID_serialization.hpp"
 #include "serialization/Serialization.hpp"
 #include "trigger/Set.hpp"
+#include "trigger/TASetSharedTPs.hpp"
 #include "trigger/TriggerActivity_serialization.hpp"
 #include "triggeralgs/TriggerActivity.hpp"
 
+#include <vector>
+
 namespace dunedaq::trigger {
 
 using TASet = Set<triggeralgs::TriggerActivity>;
@@ -22,6 +25,142 @@ using TASet = Set<triggeralgs::TriggerActivity>;
 } // namespace dunedaq::trigger
 
 MSGPACK_ADD_ENUM(dunedaq::trigger::TASet::Type)
-DUNE_DAQ_SERIALIZE_NON_INTRUSIVE(dunedaq::trigger, TASet, seqno, run_number, origin, type, start_time, end_time, objects)
+
+// This is what DUNE_DAQ_SERIALIZE_NON_INTRUSIVE would give for TASet,
+// except that the msgpack encoding can be that of TASetSharedTPs, chosen
+// for each output connection with a WireFormatSender. The two are told apart by the number of
+// fields: 7 for the TASet, and 10 for the TASetSharedTPs. Either can be
+// deserialized as either class
+
+namespace dunedaq::trigger {
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TASet, seqno, run_number, origin, type, start_time, end_time, objects)
+} // namespace dunedaq::trigger
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+{
+  namespace adaptor {
+
+  template<>
+  struct pack<dunedaq::trigger::TASetSharedTPs>
+  {
+    template<typename Stream>
+    packer<Stream>& operator()(msgpack::packer<Stream>& o, dunedaq::trigger::TASetSharedTPs const& m) const
+    {
+      o.pack_array(10);
+      o.pack(m.seqno);
+      o.pack(m.run_number);
+      o.pack(m.origin);
+      o.pack(m.type);
+      o.pack(m.start_time);
+      o.pack(m.end_time);
+      o.pack(m.activities);
+      o.pack(m.tps);
+      // The number of inputs of each TA is smaller to send than the offsets
+      o.pack_array(m.size());
+      for (size_t i = 0; i < m.size(); ++i) {
+        o.pack(m.get_n_inputs(i));
+      }
+      o.pack(m.input_indices);
+      return o;
+    }
+  };
+
+  template<>
+  struct pack<dunedaq::trigger::TASet>
+  {
+    template<typename Stream>
+    packer<Stream>& operator()(msgpack::packer<Stream>& o, dunedaq::trigger::TASet const& m) const
+    {
+      if (dunedaq::trigger::get_taset_wire_format() == dunedaq::trigger::TASetWireFormat::kSharedTPs) {
+        o.pack(dunedaq::trigger::TASetSharedTPs::from_taset(m));
+        return o;
+      }
+      o.pack_array(7);
+      o.pack(m.seqno);
+      o.pack(m.run_number);
+      o.pack(m.origin);
+      o.pack(m.type);
+      o.pack(m.start_time);
+      o.pack(m.end_time);
+      o.pack(m.objects);
+      return o;
+    }
+  };
+
+  // Each of these can decode the other's format, so both are declared before either is defined
+  template<>
+  struct convert<dunedaq::trigger::TASet>
+  {
+    msgpack::object const& operator()(msgpack::object const& o, dunedaq::trigger::TASet& m) const;
+  };
+
+  template<>
+  struct convert<dunedaq::trigger::TASetSharedTPs>
+  {
+    msgpack::object const& operator()(msgpack::object const& o, dunedaq::trigger::TASetSharedTPs& m) const;
+  };
+
+  inline msgpack::object const&
+  convert<dunedaq::trigger::TASet>::operator()(msgpack::object const& o, dunedaq::trigger::TASet& m) const
+  {
+    if (o.type != msgpack::type::ARRAY) {
+      throw msgpack::type_error();
+    }
+    if (o.via.array.size == 10) {
+      m = o.as<dunedaq::trigger::TASetSharedTPs>().to_taset();
+      return o;
+    }
+    if (o.via.array.size != 7) {
+      throw msgpack::type_error();
+    }
+    o.via.array.ptr[0].convert(m.seqno);
+    o.via.array.ptr[1].convert(m.run_number);
+    o.via.array.ptr[2].convert(m.origin);
+    o.via.array.ptr[3].convert(m.type);
+    o.via.array.ptr[4].convert(m.start_time);
+    o.via.array.ptr[5].convert(m.end_time);
+    o.via.array.ptr[6].convert(m.objects);
+    return o;
+  }
+
+  inline msgpack::object const&
+  convert<dunedaq::trigger::TASetSharedTPs>::operator()(msgpack::object const& o,
+                                                        dunedaq::trigger::TASetSharedTPs& m) const
+  {
+    if (o.type != msgpack::type::ARRAY) {
+      throw msgpack::type_error();
+    }
+    if (o.via.array.size == 7) {
+      m = dunedaq::trigger::TASetSharedTPs::from_taset(o.as<dunedaq::trigger::TASet>());
+      return o;
+    }
+    if (o.via.array.size != 10) {
+      throw msgpack::type_error();
+    }
+    o.via.array.ptr[0].convert(m.seqno);
+    o.via.array.ptr[1].convert(m.run_number);
+    o.via.array.ptr[2].convert(m.origin);
+    o.via.array.ptr[3].convert(m.type);
+    o.via.array.ptr[4].convert(m.start_time);
+    o.via.array.ptr[5].convert(m.end_time);
+    o.via.array.ptr[6].convert(m.activities);
+    o.via.array.ptr[7].convert(m.tps);
+    std::vector<dunedaq::trigger::TASetSharedTPs::index_t> n_inputs;
+    o.via.array.ptr[8].convert(n_inputs);
+    o.via.array.ptr[9].convert(m.input_indices);
+    m.input_offsets.assign(1, 0);
+    for (auto n : n_inputs) {
+      m.input_offsets.push_back(m.input_offsets.back() + n);
+    }
+    if (!m.is_consistent()) {
+      throw msgpack::type_error();
+    }
+    return o;
+  }
+
+  } // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
 
 #endif // TRIGGER_INCLUDE_TRIGGER_TASET_HPP_
@@ -0,0 +1,139 @@
+/**
+ * @file TASetSharedTPs.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_TASETSHAREDTPS_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_TASETSHAREDTPS_HPP_
+
+#include "detdataformats/trigger/TriggerActivityData.hpp"
+#include "trigger/Set.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief How TASets are encoded when they're serialized with msgpack
+ *
+ * kMsgPack encodes each TA with a full copy of each of its input TPs.
+ * kSharedTPs encodes the TASet as a TASetSharedTPs, so a TP that is an
+ * input to several TAs is only sent once. Deserialization accepts
+ * either
+ */
+enum class TASetWireFormat
+{
+  kMsgPack,
+  kSharedTPs
+};
+
+// The format used for TASets serialized on this thread. kMsgPack unless
+// changed by a TASetWireFormatScope. Modules choose the format for an
+// output connection with a WireFormatSender, not by reading or setting this
+TASetWireFormat
+get_taset_wire_format();
+
+/**
+ * @brief Sets the TASet wire format for this thread for the lifetime of the object
+ *
+ * As with TPSetWireFormatScope, this only passes the format configured
+ * for a connection down to the msgpack adaptor, so it should only be held
+ * around a single send or serialization. WireFormatSender does that for
+ * module outputs, and ShmSetCodec for TASets written to shared memory
+ */
+class TASetWireFormatScope
+{
+public:
+  explicit TASetWireFormatScope(TASetWireFormat format);
+  ~TASetWireFormatScope();
+
+  TASetWireFormatScope(const TASetWireFormatScope&) = delete;
+  TASetWireFormatScope& operator=(const TASetWireFormatScope&) = delete;
+  TASetWireFormatScope(TASetWireFormatScope&&) = delete;
+  TASetWireFormatScope& operator=(TASetWireFormatScope&&) = delete;
+
+private:
+  TASetWireFormat m_previous_format;
+};
+
+/**
+ * @brief A TASet in which each distinct input TP is stored once
+ *
+ * TAs made from overlapping windows share many of their input TPs, so a
+ * TASet with a full copy of every TA's inputs can be bigger than the
+ * TPSets it was made from. Here, the TAs are stored without their
+ * inputs, the distinct TPs are stored once in `tps`, and TA i's inputs
+ * are tps[input_indices[j]] for j in [ input_offsets[i], input_offsets[i+1] ).
+ * The inputs are only put back together when they're asked for.
+ *
+ * The msgpack serialization of this class, and of TASet in this format,
+ * is in TASet.hpp
+ */
+class TASetSharedTPs
+{
+public:
+  using TriggerActivity = triggeralgs::TriggerActivity;
+  using TriggerActivityData = detdataformats::trigger::TriggerActivityData;
+  using TriggerPrimitive = triggeralgs::TriggerPrimitive;
+  using index_t = uint32_t; // NOLINT(build/unsigned)
+
+  // The fields of the TASet
+  Set<TriggerActivity>::seqno_t seqno{ 0 };
+  daqdataformats::run_number_t run_number{ 0 };
+  Set<TriggerActivity>::origin_t origin{
+    daqdataformats::SourceID(daqdataformats::SourceID::Subsystem::kTrigger, daqdataformats::SourceID::s_invalid_id)
+  };
+  Set<TriggerActivity>::Type type{ Set<TriggerActivity>::kUnknown };
+  Set<TriggerActivity>::timestamp_t start_time{ 0 };
+  Set<TriggerActivity>::timestamp_t end_time{ 0 };
+
+  // The TAs, without their inputs
+  std::vector<TriggerActivityData> activities;
+  // The distinct input TPs of all of the TAs
+  std::vector<TriggerPrimitive> tps;
+  // activities.size() + 1 offsets into input_indices
+  std::vector<index_t> input_offsets{ 0 };
+  std::vector<index_t> input_indices;
+
+  // Make one from a TASet, finding the TPs that are shared between its TAs
+  static TASetSharedTPs from_taset(const Set<TriggerActivity>& taset);
+
+  // The TASet with each TA's inputs filled in
+  Set<TriggerActivity> to_taset() const;
+
+  // The number of TAs
+  size_t size() const { return activities.size(); }
+
+  // The number of inputs of TA i
+  size_t get_n_inputs(size_t i) const { return input_offsets[i + 1] - input_offsets[i]; }
+
+  // The inputs of TA i
+  std::vector<TriggerPrimitive> get_inputs(size_t i) const;
+
+  // TA i, with its inputs
+  TriggerActivity get_activity(size_t i) const;
+
+  // Call f(const TriggerPrimitive&) for each of the inputs of TA i, without copying them
+  template<class F>
+  void for_each_input(size_t i, F&& f) const
+  {
+    for (index_t j = input_offsets[i]; j < input_offsets[i + 1]; ++j) {
+      f(tps[input_indices[j]]);
+    }
+  }
+
+  // Whether the offsets and indices are consistent with each other and
+  // with the TAs and TPs, as they must be before the inputs can be used
+  bool is_consistent() const;
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_TASETSHAREDTPS_HPP_
@@ -12,9 +12,14 @@
 #include "dfmessages/SourceID_serialization.hpp"
 #include "serialization/Serialization.hpp"
 #include "trigger/Set.hpp"
+#include "trigger/TPSetCompactSerialization.hpp"
+#include "trigger/TPSetFlatSerialization.hpp"
 #include "trigger/TriggerPrimitive_serialization.hpp"
 #include "detdataformats/trigger/TriggerPrimitive.hpp"
 
+#include <cstdint>
+#include <vector>
+
 namespace dunedaq::trigger {
 
 using TPSet = Set<detdataformats::trigger::TriggerPrimitive>;
@@ -22,6 +27,85 @@ using TPSet = Set<detdataformats::trigger::TriggerPrimitive>;
 } // namespace dunedaq::trigger
 
 MSGPACK_ADD_ENUM(dunedaq::trigger::TPSet::Type)
-DUNE_DAQ_SERIALIZE_NON_INTRUSIVE(dunedaq::trigger, TPSet, seqno, run_number, origin, type, start_time, end_time, objects)
+
+// This is what DUNE_DAQ_SERIALIZE_NON_INTRUSIVE would give, except that
+// the msgpack encoding can be the flat or compact one, chosen for each
+// output connection with a WireFormatSender. Those are packed as a msgpack bin object, so
+// they can be told apart from the field-by-field array, and from each
+// other by their magic numbers, when they're read back
+
+namespace dunedaq::trigger {
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TPSet, seqno, run_number, origin, type, start_time, end_time, objects)
+} // namespace dunedaq::trigger
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+{
+  namespace adaptor {
+
+  template<>
+  struct pack<dunedaq::trigger::TPSet>
+  {
+    template<typename Stream>
+    packer<Stream>& operator()(msgpack::packer<Stream>& o, dunedaq::trigger::TPSet const& m) const
+    {
+      auto const wire_format = dunedaq::trigger::get_tpset_wire_format();
+      if (wire_format == dunedaq::trigger::TPSetWireFormat::kCompact) {
+        std::vector<uint8_t> bytes = dunedaq::trigger::serialize_compact_tpset(m); // NOLINT(build/unsigned)
+        o.pack_bin(bytes.size());
+        o.pack_bin_body(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return o;
+      }
+      if (wire_format == dunedaq::trigger::TPSetWireFormat::kFlat) {
+        auto header = dunedaq::trigger::make_flat_tpset_header(m);
+        auto tp_bytes = m.objects.size() * sizeof(dunedaq::trigger::TPSet::element_t);
+        o.pack_bin(sizeof(header) + tp_bytes);
+        o.pack_bin_body(reinterpret_cast<const char*>(&header), sizeof(header));
+        o.pack_bin_body(reinterpret_cast<const char*>(m.objects.data()), tp_bytes);
+        return o;
+      }
+      o.pack_array(7);
+      o.pack(m.seqno);
+      o.pack(m.run_number);
+      o.pack(m.origin);
+      o.pack(m.type);
+      o.pack(m.start_time);
+      o.pack(m.end_time);
+      o.pack(m.objects);
+      return o;
+    }
+  };
+
+  template<>
+  struct convert<dunedaq::trigger::TPSet>
+  {
+    msgpack::object const& operator()(msgpack::object const& o, dunedaq::trigger::TPSet& m) const
+    {
+      if (o.type == msgpack::type::BIN) {
+        auto data = reinterpret_cast<const uint8_t*>(o.via.bin.ptr); // NOLINT
+        if (dunedaq::trigger::is_compact_tpset(data, o.via.bin.size)) {
+          m = dunedaq::trigger::deserialize_compact_tpset(data, o.via.bin.size);
+        } else {
+          m = dunedaq::trigger::deserialize_flat_tpset(data, o.via.bin.size);
+        }
+        return o;
+      }
+      if (o.type != msgpack::type::ARRAY || o.via.array.size != 7) {
+        throw msgpack::type_error();
+      }
+      o.via.array.ptr[0].convert(m.seqno);
+      o.via.array.ptr[1].convert(m.run_number);
+      o.via.array.ptr[2].convert(m.origin);
+      o.via.array.ptr[3].convert(m.type);
+      o.via.array.ptr[4].convert(m.start_time);
+      o.via.array.ptr[5].convert(m.end_time);
+      o.via.array.ptr[6].convert(m.objects);
+      return o;
+    }
+  };
+
+  } // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
 
 #endif // TRIGGER_INCLUDE_TRIGGER_TPSET_HPP_
@@ -0,0 +1,77 @@
+/**
+ * @file TPSetCompactSerialization.hpp
+ *
+ * A compact encoding of TPSets for sending between hosts, where
+ * network bandwidth matters more than CPU
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_TPSETCOMPACTSERIALIZATION_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_TPSETCOMPACTSERIALIZATION_HPP_
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+#include "trigger/Set.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief The compact TPSet encoding
+ *
+ * A 4-byte magic number and a 1-byte version, followed by the TPSet's
+ * fields and then each TP's fields, all as LEB128 varints. Most of the
+ * values are small once they're made relative to something nearby:
+ *
+ *  - time_start is relative to the TPSet's start_time, time_peak to
+ *    time_start, and the TPSet's end_time to its start_time
+ *  - channel is relative to the previous TP's channel, so channel-sorted
+ *    TPs cost a byte or so
+ *  - The ADC values, time over threshold and small fields are varints
+ *    as they are
+ *
+ * Signed differences are zigzag-encoded, so TPs that start before the
+ * TPSet or channels that go down still round-trip exactly. Unlike the
+ * flat encoding, this one doesn't depend on byte order or on the
+ * TriggerPrimitive layout
+ */
+struct CompactTPSetFormat
+{
+  static constexpr uint32_t s_magic = 0x43535054; // NOLINT(build/unsigned) "TPSC" in little-endian
+  static constexpr uint8_t s_version = 1;         // NOLINT(build/unsigned)
+  static constexpr size_t s_preamble_size = 5;
+
+  // Upper bounds on the encoded sizes, used to size the output buffer
+  static constexpr size_t s_max_header_size = s_preamble_size + 8 * 10;
+  static constexpr size_t s_max_tp_size = 3 * 10 + 5 + 5 + 3 + 3 + 5 + 5 + 3 + 3;
+};
+
+// An upper bound on the size in bytes of the compact encoding of a TPSet with n_tps TPs
+size_t
+get_max_compact_tpset_size(size_t n_tps);
+
+// Append the compact encoding of the TPSet to `bytes`, and return the number of bytes appended
+size_t
+serialize_compact_tpset(const Set<detdataformats::trigger::TriggerPrimitive>& tpset,
+                        std::vector<uint8_t>& bytes); // NOLINT(build/unsigned)
+
+// The compact encoding of the TPSet
+std::vector<uint8_t> // NOLINT(build/unsigned)
+serialize_compact_tpset(const Set<detdataformats::trigger::TriggerPrimitive>& tpset);
+
+// Whether the data starts with the compact encoding's magic number and a version we can read
+bool
+is_compact_tpset(const uint8_t* data, size_t size); // NOLINT(build/unsigned)
+
+// Decode a compact-encoded TPSet. Throws BadCompactTPSet if the data isn't one
+Set<detdataformats::trigger::TriggerPrimitive>
+deserialize_compact_tpset(const uint8_t* data, size_t size); // NOLINT(build/unsigned)
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_TPSETCOMPACTSERIALIZATION_HPP_
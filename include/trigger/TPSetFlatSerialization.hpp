@@ -0,0 +1,168 @@
+/**
+ * @file TPSetFlatSerialization.hpp
+ *
+ * A flat binary encoding of TPSets: a fixed-size header followed by
+ * the TPs as one contiguous array, which is written and read back with
+ * a single bulk copy of the TPs
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_TPSETFLATSERIALIZATION_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_TPSETFLATSERIALIZATION_HPP_
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+#include "trigger/Set.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief How TPSets are encoded when they're serialized with msgpack
+ *
+ * kMsgPack encodes each field of each TP separately. kFlat encodes the
+ * whole TPSet as a single msgpack bin object holding the flat encoding
+ * below, and kCompact as one holding the compact encoding from
+ * TPSetCompactSerialization.hpp. Deserialization accepts any of them,
+ * so senders can switch format without their receivers knowing
+ */
+enum class TPSetWireFormat
+{
+  kMsgPack,
+  kFlat,
+  kCompact
+};
+
+// The format used for TPSets serialized on this thread. kMsgPack unless
+// changed by a TPSetWireFormatScope. Modules choose the format for an
+// output connection with a WireFormatSender, not by reading or setting this
+TPSetWireFormat
+get_tpset_wire_format();
+
+/**
+ * @brief Sets the TPSet wire format for this thread for the lifetime of the object
+ *
+ * The msgpack adaptor for TPSet can't see which connection it's
+ * serializing for, so this is how WireFormatSender, which holds the
+ * format configured for a connection, passes it down. It affects
+ * everything serialized on the thread while it exists, so it should only
+ * be held around a single send, as WireFormatSender does, or in tests
+ * and benchmarks of the encodings
+ */
+class TPSetWireFormatScope
+{
+public:
+  explicit TPSetWireFormatScope(TPSetWireFormat format);
+  ~TPSetWireFormatScope();
+
+  TPSetWireFormatScope(const TPSetWireFormatScope&) = delete;
+  TPSetWireFormatScope& operator=(const TPSetWireFormatScope&) = delete;
+  TPSetWireFormatScope(TPSetWireFormatScope&&) = delete;
+  TPSetWireFormatScope& operator=(TPSetWireFormatScope&&) = delete;
+
+private:
+  TPSetWireFormat m_previous_format;
+};
+
+static_assert(std::is_trivially_copyable_v<detdataformats::trigger::TriggerPrimitive>,
+              "The flat TPSet encoding copies TPs bytewise");
+
+/**
+ * @brief The header of a flat-encoded TPSet. It is followed immediately by n_tps TPs
+ *
+ * Everything is in the byte order of the host that wrote it. A reader
+ * with the other byte order, or a different TriggerPrimitive layout,
+ * sees a bad magic number or tp_size and rejects the data
+ */
+struct FlatTPSetHeader
+{
+  static constexpr uint32_t s_magic = 0x46535054; // NOLINT(build/unsigned) "TPSF" in little-endian
+  static constexpr uint16_t s_version = 1;        // NOLINT(build/unsigned)
+
+  uint32_t magic{ s_magic };     // NOLINT(build/unsigned)
+  uint16_t version{ s_version }; // NOLINT(build/unsigned)
+  uint16_t tp_size{ sizeof(detdataformats::trigger::TriggerPrimitive) }; // NOLINT(build/unsigned)
+  uint64_t seqno{ 0 };            // NOLINT(build/unsigned)
+  uint32_t run_number{ 0 };       // NOLINT(build/unsigned)
+  uint32_t origin_subsystem{ 0 }; // NOLINT(build/unsigned)
+  uint32_t origin_id{ 0 };        // NOLINT(build/unsigned)
+  uint32_t type{ 0 };             // NOLINT(build/unsigned)
+  uint64_t start_time{ 0 };       // NOLINT(build/unsigned)
+  uint64_t end_time{ 0 };         // NOLINT(build/unsigned)
+  uint64_t n_tps{ 0 };            // NOLINT(build/unsigned)
+};
+
+// No padding, and the TPs that follow the header stay 8-byte aligned
+static_assert(sizeof(FlatTPSetHeader) == 56, "Unexpected FlatTPSetHeader layout");
+
+// The header for the given TPSet
+FlatTPSetHeader
+make_flat_tpset_header(const Set<detdataformats::trigger::TriggerPrimitive>& tpset);
+
+// The size in bytes of the flat encoding of the TPSet
+size_t
+get_flat_tpset_size(const Set<detdataformats::trigger::TriggerPrimitive>& tpset);
+
+// The flat encoding of the TPSet
+std::vector<uint8_t> // NOLINT(build/unsigned)
+serialize_flat_tpset(const Set<detdataformats::trigger::TriggerPrimitive>& tpset);
+
+// Write the flat encoding of the TPSet to buffer, which has room for
+// capacity bytes. Returns the number of bytes written, or 0, having
+// written nothing, if the encoding doesn't fit
+size_t
+serialize_flat_tpset(const Set<detdataformats::trigger::TriggerPrimitive>& tpset,
+                     uint8_t* buffer, // NOLINT(build/unsigned)
+                     size_t capacity);
+
+// Whether the data starts with a flat TPSet header of a version we can read
+bool
+is_flat_tpset(const uint8_t* data, size_t size); // NOLINT(build/unsigned)
+
+// Decode a flat-encoded TPSet. Throws BadFlatTPSet if the data isn't one
+Set<detdataformats::trigger::TriggerPrimitive>
+deserialize_flat_tpset(const uint8_t* data, size_t size); // NOLINT(build/unsigned)
+
+/**
+ * @brief Read access to a flat-encoded TPSet without decoding it
+ *
+ * The view refers to the data it was made from, which must outlive it.
+ * The data needn't be aligned: TPs are copied out one at a time
+ */
+class FlatTPSetView
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+
+  // Throws BadFlatTPSet if the data isn't a flat-encoded TPSet
+  FlatTPSetView(const uint8_t* data, size_t size); // NOLINT(build/unsigned)
+
+  const FlatTPSetHeader& header() const { return m_header; }
+  size_t size() const { return m_header.n_tps; }
+  bool empty() const { return m_header.n_tps == 0; }
+
+  TriggerPrimitive operator[](size_t i) const;
+
+  // The encoded TPs, sizeof(TriggerPrimitive) bytes each
+  const uint8_t* tp_data() const { return m_tp_data; } // NOLINT(build/unsigned)
+
+  // Decode the whole TPSet
+  Set<TriggerPrimitive> to_tpset() const;
+
+  // Decode the whole TPSet into an existing one, reusing its objects vector
+  void to_tpset(Set<TriggerPrimitive>& tpset) const;
+
+private:
+  FlatTPSetHeader m_header;
+  const uint8_t* m_tp_data; // NOLINT(build/unsigned)
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_TPSETFLATSERIALIZATION_HPP_
@@ -0,0 +1,137 @@
+/**
+ * @file TPSetSoA.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_TPSETSOA_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_TPSETSOA_HPP_
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+#include "trigger/Set.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief A TPSet stored as one contiguous array per TP field
+ *
+ * Set<TriggerPrimitive> stores whole TPs one after another, so a loop
+ * over, say, the TPs' times and channels brings every other field of
+ * every TP into the cache too. Here each field has its own array, so
+ * such a loop only touches the arrays it reads, and the compiler can
+ * vectorize it. The TPs are in the same order as in the TPSet they came
+ * from, and column[i] is a field of TP i for each of the columns
+ */
+class TPSetSoA
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+
+  // The fields of the TPSet
+  Set<TriggerPrimitive>::seqno_t seqno{ 0 };
+  daqdataformats::run_number_t run_number{ 0 };
+  Set<TriggerPrimitive>::origin_t origin{
+    daqdataformats::SourceID(daqdataformats::SourceID::Subsystem::kTrigger, daqdataformats::SourceID::s_invalid_id)
+  };
+  Set<TriggerPrimitive>::Type type{ Set<TriggerPrimitive>::kUnknown };
+  Set<TriggerPrimitive>::timestamp_t start_time{ 0 };
+  Set<TriggerPrimitive>::timestamp_t end_time{ 0 };
+
+  // The columns, one per field of TriggerPrimitive
+  std::vector<decltype(TriggerPrimitive::time_start)> time_start;
+  std::vector<decltype(TriggerPrimitive::time_peak)> time_peak;
+  std::vector<decltype(TriggerPrimitive::time_over_threshold)> time_over_threshold;
+  std::vector<decltype(TriggerPrimitive::channel)> channel;
+  std::vector<decltype(TriggerPrimitive::adc_integral)> adc_integral;
+  std::vector<decltype(TriggerPrimitive::adc_peak)> adc_peak;
+  std::vector<decltype(TriggerPrimitive::detid)> detid;
+  std::vector<decltype(TriggerPrimitive::type)> tp_type;
+  std::vector<decltype(TriggerPrimitive::algorithm)> algorithm;
+  std::vector<decltype(TriggerPrimitive::version)> version;
+  std::vector<decltype(TriggerPrimitive::flag)> flag;
+
+  static TPSetSoA from_tpset(const Set<TriggerPrimitive>& tpset);
+
+  // The TPSet with the same fields and TPs
+  Set<TriggerPrimitive> to_tpset() const;
+
+  // The number of TPs
+  size_t size() const { return time_start.size(); }
+  bool empty() const { return time_start.empty(); }
+
+  // Remove the TPs. The columns keep their capacity, so a TPSetSoA that's
+  // reused for each slice stops allocating once it's big enough
+  void clear();
+  void reserve(size_t n);
+
+  // Replace the TPs with the given ones, leaving the set fields alone
+  void assign(const TriggerPrimitive* tps, size_t n);
+  void assign(const std::vector<TriggerPrimitive>& tps) { assign(tps.data(), tps.size()); }
+
+  void push_back(const TriggerPrimitive& tp);
+
+  // TP i, put back together from the columns
+  TriggerPrimitive get_tp(size_t i) const;
+
+  // Append the TPs to tps
+  void append_to(std::vector<TriggerPrimitive>& tps) const;
+
+  // Whether all of the columns are the same length, as they must be
+  bool is_consistent() const;
+};
+
+/**
+ * @brief Interface for TA algorithms that can process a time slice of TPs as columns
+ *
+ * A TA maker algorithm that also derives from this class gets each time
+ * slice in TriggerActivityMaker as a TPSetSoA, through
+ * operator()(const TPSetSoA&, ...), instead of one TP at a time through
+ * triggeralgs::TriggerActivityMaker::operator(). The slice holds the TPs
+ * in time order, as they would have been passed one by one. flush() and
+ * configure() are still called through the triggeralgs interface
+ */
+class TPSliceActivityMaker
+{
+public:
+  virtual ~TPSliceActivityMaker();
+
+  virtual void operator()(const TPSetSoA& slice, std::vector<triggeralgs::TriggerActivity>& output_tas) = 0;
+};
+
+/**
+ * @brief Hands time slices of TPs to a TA algorithm that takes them as columns
+ *
+ * Each slice is transposed into the same TPSetSoA, so its columns stop
+ * being reallocated once they're big enough for the largest slice
+ */
+class TPSliceDispatcher
+{
+public:
+  // Use maker's slice interface, if it has one
+  template<class MAKER>
+  void set_maker(MAKER* maker)
+  {
+    m_slice_maker = dynamic_cast<TPSliceActivityMaker*>(maker);
+  }
+
+  // Whether the maker takes slices. If not, it has to be given one TP at a time
+  bool takes_slices() const { return m_slice_maker != nullptr; }
+
+  // Pass a time-ordered slice to the maker. Only call this if takes_slices()
+  void operator()(const std::vector<TPSetSoA::TriggerPrimitive>& slice,
+                  std::vector<triggeralgs::TriggerActivity>& output_tas);
+
+private:
+  TPSliceActivityMaker* m_slice_maker{ nullptr };
+  TPSetSoA m_columns;
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_TPSETSOA_HPP_
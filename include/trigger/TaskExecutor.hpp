@@ -0,0 +1,215 @@
+/**
+ * @file TaskExecutor.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_TASKEXECUTOR_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_TASKEXECUTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+// The CPU time used by the calling thread so far
+std::chrono::nanoseconds
+get_thread_cpu_time();
+
+// Counters of what a task has done since it was made
+struct TaskStats
+{
+  uint64_t runs{ 0 }; // NOLINT(build/unsigned)
+  std::chrono::nanoseconds cpu_time{ 0 };
+};
+
+inline std::ostream&
+operator<<(std::ostream& os, const TaskStats& stats)
+{
+  return os << stats.runs << " runs, " << std::chrono::duration<double, std::milli>(stats.cpu_time).count()
+            << " ms CPU time";
+}
+
+// Counters of what the executor has done since it was made
+struct TaskExecutorStats
+{
+  size_t n_threads{ 0 };
+  uint64_t runs{ 0 };   // NOLINT(build/unsigned)
+  uint64_t steals{ 0 }; // NOLINT(build/unsigned) runs of a task taken from another thread's queue
+  uint64_t sleeps{ 0 }; // NOLINT(build/unsigned) times a thread went to sleep for want of a task
+};
+
+inline std::ostream&
+operator<<(std::ostream& os, const TaskExecutorStats& stats)
+{
+  return os << stats.n_threads << " threads, " << stats.runs << " runs, " << stats.steals << " steals, "
+            << stats.sleeps << " sleeps";
+}
+
+/**
+ * @brief A process-wide pool of threads that runs the work of trigger modules as tasks
+ *
+ * Instead of each module having a thread that mostly waits on its input
+ * with a timeout, a module can make a task that processes whatever input
+ * is ready without waiting, and have it run by the executor when there's
+ * input. A task runs when it's notified, for example by a SetRing when a
+ * set is pushed into it, and also every poll interval while it's idle,
+ * for inputs that can't notify it. A task never runs in two threads at
+ * once, so a module's state needs no more locking than with its own
+ * thread, and a notification while it runs makes it run again after.
+ *
+ * Each thread has a queue of tasks to run. A task notified from one of
+ * the threads goes on that thread's queue, so a chain of modules tends
+ * to stay on one core, and a thread with nothing to do takes tasks from
+ * the others' queues. Threads sleep when there's nothing to run.
+ *
+ * The number of threads is DUNEDAQ_TRIGGER_EXECUTOR_THREADS from the
+ * environment, or four if that's not set, but never more than the CPU
+ * has. The threads are started the first time the executor is used.
+ * A task runs on one of these threads until it returns, so a task that
+ * blocks, for example on a full output, holds up the tasks behind it
+ */
+class TaskExecutor
+{
+public:
+  using duration_t = std::chrono::milliseconds;
+
+  class Task : public std::enable_shared_from_this<Task>
+  {
+  public:
+    // Use TaskExecutor::make_task()
+    Task(TaskExecutor& executor, const std::string& name, std::function<bool()> run, duration_t poll_interval);
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&&) = delete;
+    Task& operator=(Task&&) = delete;
+
+    const std::string& get_name() const { return m_name; }
+
+    // Takes effect from the next time the task goes idle
+    void set_poll_interval(duration_t poll_interval) { m_poll_interval.store(poll_interval); }
+
+    // Run the task as soon as a thread is free, unless it's already due
+    // to run. Cheap if it is, and does nothing while the task is stopped.
+    // Safe from any thread
+    void notify();
+
+    TaskStats get_stats() const;
+
+  private:
+    friend class TaskExecutor;
+
+    enum State : int
+    {
+      kStopped,
+      kIdle,
+      kScheduled,
+      kRunning,
+      kRunningNotified
+    };
+
+    TaskExecutor& m_executor;
+    std::string m_name;
+    std::function<bool()> m_run;
+    std::atomic<duration_t> m_poll_interval;
+
+    std::atomic<int> m_state{ kStopped };
+    std::atomic<bool> m_stopping{ false };
+    // Whether the executor has a poll timer for the task. It has at most one
+    std::atomic<bool> m_timer_pending{ false };
+    std::atomic<uint64_t> m_runs{ 0 };    // NOLINT(build/unsigned)
+    std::atomic<int64_t> m_cpu_ns{ 0 };
+  };
+
+  // The executor shared by every module in the process
+  static TaskExecutor& get();
+
+  // Start n_threads threads, named "<thread_name><i>"
+  TaskExecutor(size_t n_threads, const std::string& thread_name);
+  ~TaskExecutor();
+
+  TaskExecutor(const TaskExecutor&) = delete;
+  TaskExecutor& operator=(const TaskExecutor&) = delete;
+  TaskExecutor(TaskExecutor&&) = delete;
+  TaskExecutor& operator=(TaskExecutor&&) = delete;
+
+  size_t n_threads() const { return m_workers.size(); }
+
+  // A task that calls run when it's notified, and every poll_interval
+  // while it's idle. run must not wait for input, and returns true if it
+  // may have more to do, in which case it's run again once the tasks
+  // ahead of it have had a turn. The task is stopped until start_task()
+  std::shared_ptr<Task> make_task(const std::string& name, std::function<bool()> run, duration_t poll_interval);
+
+  // Let the task run, and run it once straight away
+  void start_task(Task& task);
+
+  // Stop the task from running again, waiting for a run in progress to
+  // finish. Must not be called from the task itself
+  void stop_task(Task& task);
+
+  TaskExecutorStats get_stats() const;
+
+private:
+  struct Worker
+  {
+    std::mutex mutex;
+    std::deque<std::shared_ptr<Task>> tasks;
+    std::thread thread;
+  };
+
+  struct Timer
+  {
+    std::chrono::steady_clock::time_point when;
+    std::weak_ptr<Task> task;
+    bool operator>(const Timer& other) const { return when > other.when; }
+  };
+
+  void schedule(std::shared_ptr<Task> task);
+  void run(std::shared_ptr<Task> task);
+  std::shared_ptr<Task> take(size_t worker_index);
+  void add_timer(const std::shared_ptr<Task>& task);
+  // Notify the tasks whose timers have passed, and return when the next one is due
+  std::chrono::steady_clock::time_point fire_timers();
+  void do_work(size_t worker_index);
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::atomic<size_t> m_next_worker{ 0 };
+  std::atomic<bool> m_running{ true };
+
+  // Tasks in the workers' queues. Sleeping threads wait for this to be nonzero
+  std::atomic<size_t> m_n_queued{ 0 };
+  std::atomic<size_t> m_n_sleeping{ 0 };
+  std::mutex m_sleep_mutex;
+  std::condition_variable m_wake;
+
+  std::mutex m_timer_mutex;
+  std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+  // When the first timer is due, in steady_clock ticks, so threads can check without the lock
+  std::atomic<int64_t> m_next_timer{ std::numeric_limits<int64_t>::max() };
+
+  std::atomic<uint64_t> m_runs{ 0 };   // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_steals{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_sleeps{ 0 }; // NOLINT(build/unsigned)
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_TASKEXECUTOR_HPP_
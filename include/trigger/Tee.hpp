@@ -9,13 +9,48 @@
 #ifndef TRIGGER_PLUGINS_TEE_HPP_
 #define TRIGGER_PLUGINS_TEE_HPP_
 
+#include "trigger/tee/Nljs.hpp"
+#include "trigger/teeinfo/InfoNljs.hpp"
+
+#include "trigger/SetRing.hpp"
+#include "trigger/TaskExecutor.hpp"
+
 #include "appfwk/DAQModule.hpp"
 #include "iomanager/Receiver.hpp"
 #include "iomanager/Sender.hpp"
 #include "utilities/WorkerThread.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 namespace dunedaq {
 namespace trigger {
+
+/**
+ * @brief Tee sends each object from its input to each of its outputs
+ *
+ * The outputs are the connections named output1, output2, ... outputN,
+ * in order. The outputs share one copy of each object. A consumer in
+ * this process that attached a ring of std::shared_ptr<const T> to its
+ * input is passed that copy itself. Any other consumer takes ownership
+ * of what it's sent, so it's sent a copy of its own, unless no other
+ * output still needs the object, in which case the object is moved to it.
+ *
+ * Each output has its own bounded queue and sender thread, so a slow
+ * consumer on one output doesn't hold up the others. What happens when
+ * an output's queue is full is set per output.
+ *
+ * With use_executor, the input and each output are tasks on the shared
+ * TaskExecutor instead of threads. The input task doesn't wait for room
+ * on a kBlock output. It stops taking input while one is full, and that
+ * output's task notifies it once there's room again
+ */
 template<class T>
 class Tee : public dunedaq::appfwk::DAQModule
 {
@@ -28,6 +63,7 @@ public:
   Tee& operator=(Tee&&) = delete;
 
   void init(const nlohmann::json& iniobj) override;
+  void get_info(opmonlib::InfoCollector& ci, int level) override;
 
 private:
   void do_conf(const nlohmann::json& config);
@@ -36,14 +72,73 @@ private:
   void do_scrap(const nlohmann::json& obj);
   void do_work(std::atomic<bool>&);
 
+  using sink_t = dunedaq::iomanager::SenderConcept<T>;
+  using shared_t = std::shared_ptr<const T>;
+  using metric_counter_type = decltype(teeinfo::OutputInfo::sent_count);
+
+  struct Output
+  {
+    std::string name;
+    std::string uid;
+    std::shared_ptr<sink_t> sink;
+    // Used instead of the sink when the consumer is in this process. Set at start
+    std::shared_ptr<SetRing<shared_t>> shared_ring;
+    std::shared_ptr<SetRing<T>> ring;
+    tee::FullQueuePolicy policy{ tee::FullQueuePolicy::kBlock };
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<std::shared_ptr<T>> queue;
+    std::unique_ptr<dunedaq::utilities::WorkerThread> sender_thread;
+    // Used instead of the sender thread with use_executor. Made the first time it's needed
+    std::shared_ptr<TaskExecutor::Task> task;
+
+    std::atomic<metric_counter_type> sent_count{ 0 };
+    std::atomic<metric_counter_type> dropped_queue_full_count{ 0 };
+    std::atomic<metric_counter_type> failed_send_count{ 0 };
+  };
+
+  // Put the object on the output's queue, applying its full queue policy
+  void enqueue(Output& output, const std::shared_ptr<T>& object);
+  // Queue the object on every output
+  void fan_out(T&& object);
+  // The sender thread for an output
+  void send_output(Output& output, std::atomic<bool>& running_flag);
+  // Send up to max_objects from the output's queue, without waiting for
+  // more. Returns how many were taken off the queue
+  size_t send_queued(Output& output, size_t max_objects);
+  // Send the object on the output, and count whether that worked
+  void send_and_count(Output& output, std::shared_ptr<T>&& object);
+  // Pass the object on to the output's consumer. Returns false if that timed out
+  bool send_object(Output& output, std::shared_ptr<T>&& object, std::chrono::milliseconds timeout);
+
+  // The executor's version of do_work(): queue what input is ready, without waiting
+  bool run_input_task();
+  // Whether a kBlock output's queue is full, so the input mustn't be read
+  bool blocking_output_full();
+
   dunedaq::utilities::WorkerThread m_thread;
 
+  // How long a sender waits for its consumer to take an object
+  static constexpr std::chrono::milliseconds s_send_timeout{ 20 };
+  // How often the idle input task polls the input connection, which can't notify it
+  static constexpr std::chrono::milliseconds s_input_poll_interval{ 5 };
+  // Output tasks are notified of everything queued for them, so only poll as a fallback
+  static constexpr std::chrono::milliseconds s_output_poll_interval{ 100 };
+  // The most objects a task handles in one run, so that the others on its thread get a turn
+  static constexpr size_t s_task_batch_size = 16;
+
+  bool m_use_executor{ false };
+  std::shared_ptr<TaskExecutor::Task> m_input_task;
+  bool m_tasks_running{ false };
+
   using source_t = dunedaq::iomanager::ReceiverConcept<T>;
   std::shared_ptr<source_t> m_input_queue;
-  using sink_t = dunedaq::iomanager::SenderConcept<T>;
-  std::shared_ptr<sink_t> m_output_queue1;
-  std::shared_ptr<sink_t> m_output_queue2;
+  std::vector<std::unique_ptr<Output>> m_outputs;
+
+  size_t m_queue_size{ 100 };
 
+  std::atomic<metric_counter_type> m_received_count{ 0 };
 };
 } // namespace trigger
 } // namespace dunedaq
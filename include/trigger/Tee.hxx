@@ -12,7 +12,12 @@
 #include "rcif/cmd/Nljs.hpp"
 #include "trigger/Issues.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 
 namespace dunedaq {
 namespace trigger {
@@ -22,8 +27,6 @@ Tee<T>::Tee(const std::string& name)
   : DAQModule(name)
   , m_thread(std::bind(&Tee<T>::do_work, this, std::placeholders::_1))
   , m_input_queue(nullptr)
-  , m_output_queue1(nullptr)
-  , m_output_queue2(nullptr)
 {
 
   register_command("conf", &Tee<T>::do_conf);
@@ -36,19 +39,75 @@ template<class T>
 void
 Tee<T>::init(const nlohmann::json& iniobj)
 {
+  auto add_output = [this](const std::string& name, const std::string& uid) {
+    auto output = std::make_unique<Output>();
+    output->name = name;
+    output->uid = uid;
+    output->sink = get_iom_sender<T>(uid);
+    Output& output_ref = *output;
+    output->sender_thread = std::make_unique<dunedaq::utilities::WorkerThread>(
+      [this, &output_ref](std::atomic<bool>& running_flag) { send_output(output_ref, running_flag); });
+    m_outputs.push_back(std::move(output));
+  };
+
   try {
     m_input_queue = get_iom_receiver<T>(appfwk::connection_uid(iniobj, "input"));
-    m_output_queue1 = get_iom_sender<T>(appfwk::connection_uid(iniobj, "output1"));
-    m_output_queue2 = get_iom_sender<T>(appfwk::connection_uid(iniobj, "output2"));
+    add_output("output1", appfwk::connection_uid(iniobj, "output1"));
   } catch (const ers::Issue& excpt) {
     throw dunedaq::trigger::InvalidQueueFatalError(ERS_HERE, get_name(), "input/output", excpt);
   }
+
+  // The rest of the outputs are numbered consecutively from output2
+  while (true) {
+    std::string name = "output" + std::to_string(m_outputs.size() + 1);
+    std::string uid;
+    try {
+      uid = appfwk::connection_uid(iniobj, name);
+    } catch (const ers::Issue&) {
+      break;
+    }
+    try {
+      add_output(name, uid);
+    } catch (const ers::Issue& excpt) {
+      throw dunedaq::trigger::InvalidQueueFatalError(ERS_HERE, get_name(), "output", excpt);
+    }
+  }
+  TLOG_DEBUG(2) << get_name() << " has " << m_outputs.size() << " outputs";
 }
 
 template<class T>
 void
-Tee<T>::do_conf(const nlohmann::json&)
+Tee<T>::get_info(opmonlib::InfoCollector& ci, int /*level*/)
 {
+  teeinfo::Info info;
+  info.received_count = m_received_count.load();
+  ci.add(info);
+
+  for (auto& output : m_outputs) {
+    teeinfo::OutputInfo output_info;
+    output_info.sent_count = output->sent_count.load();
+    output_info.dropped_queue_full_count = output->dropped_queue_full_count.load();
+    output_info.failed_send_count = output->failed_send_count.load();
+    {
+      std::lock_guard<std::mutex> lk(output->queue_mutex);
+      output_info.queue_depth = output->queue.size();
+    }
+    opmonlib::InfoCollector output_ci;
+    output_ci.add(output_info);
+    ci.add(output->name, output_ci);
+  }
+}
+
+template<class T>
+void
+Tee<T>::do_conf(const nlohmann::json& config)
+{
+  auto conf = config.get<tee::ConfParams>();
+  m_queue_size = std::max<size_t>(conf.queue_size, 1);
+  m_use_executor = conf.use_executor;
+  for (size_t i = 0; i < m_outputs.size(); ++i) {
+    m_outputs[i]->policy = i < conf.output_policies.size() ? conf.output_policies[i] : conf.default_policy;
+  }
   TLOG_DEBUG(2) << get_name() + " configured.";
 }
 
@@ -56,15 +115,89 @@ template<class T>
 void
 Tee<T>::do_start(const nlohmann::json&)
 {
-  m_thread.start_working_thread("tee");
-  TLOG_DEBUG(2) << get_name() + " successfully started.";
+  m_received_count.store(0);
+  for (size_t i = 0; i < m_outputs.size(); ++i) {
+    auto& output = *m_outputs[i];
+    output.sent_count.store(0);
+    output.dropped_queue_full_count.store(0);
+    output.failed_send_count.store(0);
+    // Every module has been configured by now, so if the consumer takes its input locally, its ring exists
+    output.shared_ring = SetRingRegistry<shared_t>::find(output.uid);
+    output.ring = output.shared_ring ? nullptr : SetRingRegistry<T>::find(output.uid);
+    if (output.shared_ring || output.ring) {
+      TLOG() << get_name() << ": Sending " << output.name << " to " << output.uid << " through a local ring";
+    }
+  }
+
+  if (!m_use_executor) {
+    for (size_t i = 0; i < m_outputs.size(); ++i) {
+      m_outputs[i]->sender_thread->start_working_thread("tee-out" + std::to_string(i + 1));
+    }
+    m_thread.start_working_thread("tee");
+    TLOG_DEBUG(2) << get_name() + " successfully started.";
+    return;
+  }
+
+  // Start the outputs first, so that they're ready for what the input
+  // queues. They may notify the input task, so it's made before them
+  auto& executor = TaskExecutor::get();
+  if (!m_input_task) {
+    m_input_task = executor.make_task(get_name(), [this] { return run_input_task(); }, s_input_poll_interval);
+  }
+  for (auto& output : m_outputs) {
+    if (!output->task) {
+      Output& output_ref = *output;
+      output->task = executor.make_task(
+        get_name() + "-" + output->name,
+        [this, &output_ref] { return send_queued(output_ref, s_task_batch_size) > 0; },
+        s_output_poll_interval);
+    }
+    executor.start_task(*output->task);
+  }
+  executor.start_task(*m_input_task);
+  m_tasks_running = true;
+  TLOG() << get_name() << ": Running as tasks on the shared executor, which has " << executor.n_threads()
+         << " threads";
 }
 
 template<class T>
 void
 Tee<T>::do_stop(const nlohmann::json&)
 {
-  m_thread.stop_working_thread();
+  // Stop taking input first, then let each output send what's left on its queue
+  if (m_tasks_running) {
+    auto& executor = TaskExecutor::get();
+    executor.stop_task(*m_input_task);
+    // As do_work() does, take what's left of the input. The output tasks
+    // are still running, so a full kBlock output makes room
+    size_t n_objects = 0;
+    while (true) {
+      std::optional<T> object = m_input_queue->try_receive(std::chrono::milliseconds(0));
+      if (!object.has_value()) {
+        break;
+      }
+      ++n_objects;
+      ++m_received_count;
+      fan_out(std::move(*object));
+    }
+    TLOG() << get_name() << ": Received " << m_received_count << " objects, " << n_objects << " of them after the stop";
+    for (auto& output : m_outputs) {
+      executor.stop_task(*output->task);
+      while (send_queued(*output, m_queue_size) > 0) {
+      }
+    }
+    m_tasks_running = false;
+  } else {
+    m_thread.stop_working_thread();
+    for (auto& output : m_outputs) {
+      output->sender_thread->stop_working_thread();
+    }
+  }
+  for (auto& output : m_outputs) {
+    TLOG() << get_name() << ": " << output->name << " sent " << output->sent_count << " objects. Dropped "
+           << output->dropped_queue_full_count << " with the queue full and " << output->failed_send_count
+           << " that failed to send";
+  }
   TLOG_DEBUG(2) << get_name() + " successfully stopped.";
 }
 
@@ -73,17 +206,150 @@ void
 Tee<T>::do_scrap(const nlohmann::json&)
 {}
 
+template<class T>
+void
+Tee<T>::enqueue(Output& output, const std::shared_ptr<T>& object)
+{
+  bool dropped = false;
+  {
+    std::unique_lock<std::mutex> lk(output.queue_mutex);
+    bool accepted = true;
+    if (output.queue.size() >= m_queue_size) {
+      switch (output.policy) {
+        case tee::FullQueuePolicy::kBlock:
+          output.queue_cv.wait(lk, [&]() { return output.queue.size() < m_queue_size; });
+          break;
+        case tee::FullQueuePolicy::kDropOldest:
+          output.queue.pop_front();
+          dropped = true;
+          break;
+        case tee::FullQueuePolicy::kDropNewest:
+          accepted = false;
+          dropped = true;
+          break;
+      }
+    }
+    if (accepted) {
+      output.queue.push_back(object);
+    }
+  }
+  output.queue_cv.notify_all();
+  if (output.task) {
+    output.task->notify();
+  }
+  if (dropped) {
+    ++output.dropped_queue_full_count;
+  }
+}
+
+template<class T>
+void
+Tee<T>::send_output(Output& output, std::atomic<bool>& running_flag)
+{
+  // Keep going until we've been stopped and the queue is empty
+  while (true) {
+    std::shared_ptr<T> object;
+    {
+      std::unique_lock<std::mutex> lk(output.queue_mutex);
+      if (!output.queue_cv.wait_for(lk, std::chrono::milliseconds(100), [&]() { return !output.queue.empty(); })) {
+        if (!running_flag.load()) {
+          break;
+        }
+        continue;
+      }
+      object = std::move(output.queue.front());
+      output.queue.pop_front();
+    }
+    output.queue_cv.notify_all();
+    send_and_count(output, std::move(object));
+  }
+}
+
+template<class T>
+size_t
+Tee<T>::send_queued(Output& output, size_t max_objects)
+{
+  size_t n_taken = 0;
+  for (; n_taken < max_objects; ++n_taken) {
+    std::shared_ptr<T> object;
+    bool was_full = false;
+    {
+      std::lock_guard<std::mutex> lk(output.queue_mutex);
+      if (output.queue.empty()) {
+        break;
+      }
+      was_full = output.queue.size() >= m_queue_size;
+      object = std::move(output.queue.front());
+      output.queue.pop_front();
+    }
+    output.queue_cv.notify_all();
+    // The input task may have stopped taking input for want of room here
+    if (was_full && m_input_task) {
+      m_input_task->notify();
+    }
+    send_and_count(output, std::move(object));
+  }
+  return n_taken;
+}
+
+template<class T>
+void
+Tee<T>::send_and_count(Output& output, std::shared_ptr<T>&& object)
+{
+  if (send_object(output, std::move(object), s_send_timeout)) {
+    ++output.sent_count;
+  } else {
+    ++output.failed_send_count;
+    ers::warning(dunedaq::iomanager::TimeoutExpired(
+      ERS_HERE, get_name(), "push to output queue " + output.name, s_send_timeout.count()));
+  }
+}
+
+template<class T>
+bool
+Tee<T>::send_object(Output& output, std::shared_ptr<T>&& object, std::chrono::milliseconds timeout)
+{
+  if (output.shared_ring) {
+    return output.shared_ring->push(shared_t(std::move(object)), timeout);
+  }
+
+  // The consumer will own what it's sent. If the other outputs are done
+  // with the object, it can have the object itself, and otherwise it
+  // gets a copy. Outputs drop their references with release ordering, so
+  // once we see that ours is the only one left, the fence makes their
+  // use of the object happen before we move from it
+  std::optional<T> owned;
+  if (object.use_count() == 1) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    owned.emplace(std::move(*object));
+  } else {
+    owned.emplace(*object);
+  }
+  object.reset();
+
+  if (output.ring) {
+    return output.ring->push(std::move(*owned), timeout);
+  }
+  try {
+    output.sink->send(std::move(*owned), timeout);
+  } catch (const dunedaq::iomanager::TimeoutExpired&) {
+    return false;
+  }
+  return true;
+}
+
 template<class T>
 void
 Tee<T>::do_work(std::atomic<bool>& running_flag)
 {
   size_t n_objects = 0;
-  
+
   while (true) {
     T object;
     try {
       object = m_input_queue->receive(std::chrono::milliseconds(100));
       ++n_objects;
+      ++m_received_count;
     } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
       // The condition to exit the loop is that we've been stopped and
       // there's nothing left on the input queue
@@ -94,24 +360,61 @@ Tee<T>::do_work(std::atomic<bool>& running_flag)
       }
     }
 
-    size_t timeout_ms = 20;
-    try {
-      T object1(object);
-      m_output_queue1->send(std::move(object1), std::chrono::milliseconds(timeout_ms));
-    } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
-      ers::warning(dunedaq::iomanager::TimeoutExpired(ERS_HERE, get_name(), "push to output queue 1", timeout_ms));
-    }
-    try {
-      T object2(object);
-      m_output_queue2->send(std::move(object2), std::chrono::milliseconds(timeout_ms));
-    } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
-      ers::warning(dunedaq::iomanager::TimeoutExpired(ERS_HERE, get_name(), "push to output queue 2", timeout_ms));
-    }
+    fan_out(std::move(object));
   }
 
   TLOG() << get_name() << ": Exiting do_work() method after receiving " << n_objects << " objects";
 }
 
+template<class T>
+void
+Tee<T>::fan_out(T&& object)
+{
+  // The outputs all queue the same object, so fanning out doesn't copy
+  // it. Only an output whose consumer needs an object of its own copies
+  // it, when it sends it. The sending is done by each output's own
+  // thread or task, so only a kBlock output with a full queue can hold
+  // us up here
+  auto shared_object = std::make_shared<T>(std::move(object));
+  for (auto& output : m_outputs) {
+    enqueue(*output, shared_object);
+  }
+}
+
+template<class T>
+bool
+Tee<T>::run_input_task()
+{
+  size_t n_received = 0;
+  while (n_received < s_task_batch_size && !blocking_output_full()) {
+    std::optional<T> object = m_input_queue->try_receive(std::chrono::milliseconds(0));
+    if (!object.has_value()) {
+      break;
+    }
+    ++n_received;
+    ++m_received_count;
+    fan_out(std::move(*object));
+  }
+  return n_received > 0;
+}
+
+template<class T>
+bool
+Tee<T>::blocking_output_full()
+{
+  // Only we add to the queues, so one that has room now still has it when we queue
+  for (auto& output : m_outputs) {
+    if (output->policy != tee::FullQueuePolicy::kBlock) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lk(output->queue_mutex);
+    if (output->queue.size() >= m_queue_size) {
+      return true;
+    }
+  }
+  return false;
+}
+
 } // namespace trigger
 } // namespace dunedaq
 
@@ -0,0 +1,106 @@
+/**
+ * @file ThreadPlacement.hpp
+ *
+ * Pinning trigger module threads to CPUs and their memory to a NUMA
+ * node, and huge-page backing for large buffers
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_THREADPLACEMENT_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_THREADPLACEMENT_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief Where a module wants its threads to run and its memory to be
+ *
+ * The defaults leave everything to the kernel. Modules take the fields
+ * from their conf command, check them with make_thread_placement(), and
+ * call apply_thread_placement() at the top of each thread they start
+ */
+struct ThreadPlacement
+{
+  // CPUs the threads may run on. Empty for any
+  std::vector<int> cpus;
+  // NUMA node to allocate the threads' memory from where possible. -1 for any
+  int numa_node{ -1 };
+  // Back the module's large buffers with huge pages, where the module has a buffer that can be
+  bool huge_pages{ false };
+
+  bool is_default() const { return cpus.empty() && numa_node < 0 && !huge_pages; }
+};
+
+// Parse a CPU list in the kernel's format, such as "0-3,8,10-11". Throws InvalidThreadPlacement
+std::vector<int>
+parse_cpu_list(const std::string& list);
+
+// The inverse of parse_cpu_list()
+std::string
+format_cpu_list(std::vector<int> cpus);
+
+// A placement from the conf fields of a module, checked against this
+// machine. Throws InvalidThreadPlacement if the CPUs or node don't exist
+ThreadPlacement
+make_thread_placement(const std::string& cpus, int numa_node, bool huge_pages = false);
+
+// Run the calling thread on the CPUs of placement and prefer its NUMA
+// node for the memory it allocates from now on, then log where the
+// thread actually ended up, as "<who>: ...". The log notes CPUs that are
+// hyperthread siblings of each other and memory on a node that's remote
+// from the CPUs. Failing to apply the placement is a warning, not an error
+void
+apply_thread_placement(const ThreadPlacement& placement, const std::string& who);
+
+// Where the calling thread is allowed to run and allocate, for the log
+std::string
+describe_thread_placement();
+
+/**
+ * @brief A large, zero-filled block of memory backed by huge pages if possible, on a given NUMA node
+ *
+ * Explicit huge pages from the kernel's reserved pool are used if there
+ * are enough, otherwise transparent huge pages are asked for, which the
+ * kernel gives if it's configured to allow them
+ */
+class HugePageBuffer
+{
+public:
+  enum class Backing
+  {
+    kHugeTLB,     // Reserved huge pages
+    kTransparent, // Transparent huge pages were asked for
+    kNormal       // Ordinary pages
+  };
+
+  // numa_node is -1 for the node of whichever thread first touches each page
+  HugePageBuffer(size_t size, int numa_node);
+  ~HugePageBuffer();
+
+  HugePageBuffer(const HugePageBuffer&) = delete;
+  HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+  HugePageBuffer(HugePageBuffer&&) = delete;
+  HugePageBuffer& operator=(HugePageBuffer&&) = delete;
+
+  void* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  Backing backing() const { return m_backing; }
+  std::string describe() const;
+
+private:
+  void* m_data{ nullptr };
+  size_t m_size{ 0 };
+  size_t m_mapping_size{ 0 };
+  int m_numa_node{ -1 };
+  Backing m_backing{ Backing::kNormal };
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_THREADPLACEMENT_HPP_
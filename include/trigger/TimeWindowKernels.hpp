@@ -0,0 +1,176 @@
+/**
+ * @file TimeWindowKernels.hpp
+ *
+ * Selecting, counting and finding the bounds of trigger objects by their
+ * time_start, with SIMD versions of the loops where the CPU has them
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_TIMEWINDOWKERNELS_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_TIMEWINDOWKERNELS_HPP_
+
+#include "daqdataformats/Types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief The instruction set used by the time window kernels
+ *
+ * The best one the CPU has is chosen the first time the kernels are
+ * used, unless set_time_window_isa() has chosen one before then. kScalar
+ * is plain C++, and is what's used on CPUs other than x86-64
+ */
+enum class TimeWindowIsa
+{
+  kScalar,
+  kAVX2,
+  kAVX512
+};
+
+std::string
+get_time_window_isa_name(TimeWindowIsa isa);
+
+// Whether the CPU, and this build, can run the kernels with isa
+bool
+is_time_window_isa_supported(TimeWindowIsa isa);
+
+// The instruction set the kernels are using
+TimeWindowIsa
+get_time_window_isa();
+
+// Use isa for the kernels from now on, in every thread. Returns false,
+// and changes nothing, if it isn't supported. For tests and benchmarks
+bool
+set_time_window_isa(TimeWindowIsa isa);
+
+// The kernels work on n timestamps at times[0], times[stride],
+// times[2 * stride], ..., so they can read a time_start column, with
+// stride 1, or the time_start fields of an array of objects. A time t is
+// in the window if begin <= t <= end, as in a DataRequest
+
+// Bit i of the result is set if timestamp i is in the window. n must be at most 64
+uint64_t // NOLINT(build/unsigned)
+time_window_mask(const daqdataformats::timestamp_t* times,
+                 size_t stride,
+                 size_t n,
+                 daqdataformats::timestamp_t begin,
+                 daqdataformats::timestamp_t end);
+
+// The number of timestamps in the window
+size_t
+count_in_time_window(const daqdataformats::timestamp_t* times,
+                     size_t stride,
+                     size_t n,
+                     daqdataformats::timestamp_t begin,
+                     daqdataformats::timestamp_t end);
+
+// The index of the first timestamp outside the window, or n if there isn't one
+size_t
+find_outside_time_window(const daqdataformats::timestamp_t* times,
+                         size_t stride,
+                         size_t n,
+                         daqdataformats::timestamp_t begin,
+                         daqdataformats::timestamp_t end);
+
+// The index of the first timestamp that's not less than t, or n if
+// there isn't one. The timestamps must be in increasing order
+size_t
+lower_bound_time(const daqdataformats::timestamp_t* times, size_t stride, size_t n, daqdataformats::timestamp_t t);
+
+// Wrappers for arrays of objects with a time_start, such as TPs and TAs
+
+template<class T>
+const daqdataformats::timestamp_t*
+get_time_start_column(const T* objects)
+{
+  static_assert(std::is_same_v<std::decay_t<decltype(objects->time_start)>, daqdataformats::timestamp_t>,
+                "time_start must be a timestamp_t");
+  static_assert(sizeof(T) % sizeof(daqdataformats::timestamp_t) == 0,
+                "The time_start of consecutive objects must be a whole number of timestamps apart");
+  return &objects->time_start;
+}
+
+template<class T>
+constexpr size_t
+get_time_start_stride()
+{
+  return sizeof(T) / sizeof(daqdataformats::timestamp_t);
+}
+
+template<class T>
+size_t
+count_in_time_window(const T* objects,
+                     size_t n,
+                     daqdataformats::timestamp_t begin,
+                     daqdataformats::timestamp_t end)
+{
+  return n == 0 ? 0 : count_in_time_window(get_time_start_column(objects), get_time_start_stride<T>(), n, begin, end);
+}
+
+// The index of the first object from first onwards whose time_start is
+// outside the window, or n if there isn't one
+template<class T>
+size_t
+find_outside_time_window(const T* objects,
+                         size_t n,
+                         size_t first,
+                         daqdataformats::timestamp_t begin,
+                         daqdataformats::timestamp_t end)
+{
+  if (first >= n) {
+    return n;
+  }
+  return first + find_outside_time_window(
+                   get_time_start_column(objects + first), get_time_start_stride<T>(), n - first, begin, end);
+}
+
+// Append the objects whose time_start is in the window to out, keeping
+// their order. Returns the number appended
+template<class T>
+size_t
+select_in_time_window(const T* objects,
+                      size_t n,
+                      daqdataformats::timestamp_t begin,
+                      daqdataformats::timestamp_t end,
+                      std::vector<T>& out)
+{
+  size_t n_before = out.size();
+  for (size_t i = 0; i < n; i += 64) {
+    size_t n_block = n - i < 64 ? n - i : 64;
+    uint64_t mask = // NOLINT(build/unsigned)
+      time_window_mask(get_time_start_column(objects + i), get_time_start_stride<T>(), n_block, begin, end);
+    // Objects are usually in time order, so most blocks are all in or all out
+    while (mask != 0) {
+      size_t first = __builtin_ctzll(mask);
+      size_t last = first;
+      while (last < n_block && (mask >> last & 1) != 0) {
+        ++last;
+      }
+      out.insert(out.end(), objects + i + first, objects + i + last);
+      mask = last == 64 ? 0 : mask & (~uint64_t(0) << last); // NOLINT(build/unsigned)
+    }
+  }
+  return out.size() - n_before;
+}
+
+// The index of the first object whose time_start is not less than t, or
+// n if there isn't one. The objects must be in time_start order
+template<class T>
+size_t
+lower_bound_time_start(const T* objects, size_t n, daqdataformats::timestamp_t t)
+{
+  return n == 0 ? 0 : lower_bound_time(get_time_start_column(objects), get_time_start_stride<T>(), n, t);
+}
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_TIMEWINDOWKERNELS_HPP_
@@ -0,0 +1,104 @@
+/**
+ * @file WireFormatSender.hpp
+ *
+ * An output connection together with the wire format that Sets sent on
+ * it are serialized with
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_INCLUDE_TRIGGER_WIREFORMATSENDER_HPP_
+#define TRIGGER_INCLUDE_TRIGGER_WIREFORMATSENDER_HPP_
+
+#include "trigger/TASet.hpp"
+#include "trigger/TPSet.hpp"
+
+#include "iomanager/Sender.hpp"
+
+#include <chrono>
+#include <memory>
+#include <utility>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief The wire formats a type has, and how to select one for a send
+ *
+ * Types without alternative encodings have only kMsgPack, and selecting
+ * it does nothing
+ */
+template<class T>
+struct WireFormatTraits
+{
+  enum class format_t
+  {
+    kMsgPack
+  };
+
+  struct scope_t
+  {
+    explicit scope_t(format_t /*format*/) {}
+  };
+};
+
+template<>
+struct WireFormatTraits<TPSet>
+{
+  using format_t = TPSetWireFormat;
+  using scope_t = TPSetWireFormatScope;
+};
+
+template<>
+struct WireFormatTraits<TASet>
+{
+  using format_t = TASetWireFormat;
+  using scope_t = TASetWireFormatScope;
+};
+
+/**
+ * @brief A sender whose Sets are serialized in the format configured for its connection
+ *
+ * The msgpack adaptors can't see which connection they're serializing
+ * for, so the format is passed to them through a thread-local that this
+ * sets for the duration of each send, and only for that send. Other
+ * sends from the same thread, to other connections, aren't affected.
+ * Receivers read every format, so only the sending module needs to be
+ * configured. Sends to a connection in the same process don't serialize,
+ * so the format makes no difference to them
+ */
+template<class T>
+class WireFormatSender
+{
+public:
+  using format_t = typename WireFormatTraits<T>::format_t;
+  using sender_t = iomanager::SenderConcept<T>;
+
+  WireFormatSender() = default;
+  WireFormatSender(std::shared_ptr<sender_t> sender, format_t format)
+    : m_sender(std::move(sender))
+    , m_format(format)
+  {}
+
+  // Throws iomanager::TimeoutExpired, as sender_t::send() does
+  void send(T&& obj, std::chrono::milliseconds timeout)
+  {
+    typename WireFormatTraits<T>::scope_t scope(m_format);
+    m_sender->send(std::move(obj), timeout);
+  }
+
+  format_t get_format() const { return m_format; }
+  void set_format(format_t format) { m_format = format; }
+
+  sender_t* get() const { return m_sender.get(); }
+  explicit operator bool() const { return m_sender != nullptr; }
+
+private:
+  std::shared_ptr<sender_t> m_sender;
+  format_t m_format{ format_t::kMsgPack };
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_INCLUDE_TRIGGER_WIREFORMATSENDER_HPP_
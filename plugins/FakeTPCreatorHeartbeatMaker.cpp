@@ -12,6 +12,9 @@
 #include "iomanager/IOManager.hpp"
 #include "rcif/cmd/Nljs.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <sstream>
 #include <string>
 
 namespace dunedaq {
@@ -49,6 +52,7 @@ FakeTPCreatorHeartbeatMaker::get_info(opmonlib::InfoCollector& ci, int /*level*/
   i.tpset_received_count = m_tpset_received_count.load();
   i.tpset_sent_count = m_tpset_sent_count.load();
   i.heartbeats_sent = m_heartbeats_sent.load();
+  i.timer_heartbeats_sent = m_timer_heartbeats_sent.load();
 
   ci.add(i);
 }
@@ -56,7 +60,8 @@ FakeTPCreatorHeartbeatMaker::get_info(opmonlib::InfoCollector& ci, int /*level*/
 void
 FakeTPCreatorHeartbeatMaker::do_conf(const nlohmann::json& conf)
 {
-  m_heartbeat_interval = conf.get<dunedaq::trigger::faketpcreatorheartbeatmaker::Conf>().heartbeat_interval;
+  m_conf = conf.get<dunedaq::trigger::faketpcreatorheartbeatmaker::Conf>();
+  m_heartbeat_interval = m_conf.heartbeat_interval;
   TLOG_DEBUG(2) << get_name() + " configured.";
 }
 
@@ -88,23 +93,61 @@ FakeTPCreatorHeartbeatMaker::do_work(std::atomic<bool>& running_flag)
   m_tpset_received_count.store(0);
   m_tpset_sent_count.store(0);
   m_heartbeats_sent.store(0);
+  m_timer_heartbeats_sent.store(0);
 
   bool is_first_tpset_received = true;
 
-  daqdataformats::timestamp_t last_sent_heartbeat_time;
+  daqdataformats::timestamp_t last_sent_heartbeat_time = 0;
 
   TPSet::seqno_t sequence_number = 0;
-  
+
+  // With timer heartbeats, heartbeats keep flowing when the input goes
+  // quiet, so downstream doesn't hold data waiting for this input. The
+  // current data time is estimated from the latest data time seen, and
+  // when it was seen, so we must wake up at least once per timer period
+  bool const timer_heartbeats = m_conf.timer_heartbeat_period_ms > 0;
+  auto const timer_period = std::chrono::milliseconds(m_conf.timer_heartbeat_period_ms);
+  auto const receive_timeout = timer_heartbeats ? std::min(m_queue_timeout, timer_period) : m_queue_timeout;
+  daqdataformats::timestamp_t latest_data_time = 0;
+  auto latest_data_wall_time = std::chrono::steady_clock::now();
+  auto next_timer_check = latest_data_wall_time + timer_period;
+
   while (true) {
-    std::optional<TPSet> tpset = m_input_queue->try_receive(m_queue_timeout);
+    std::optional<TPSet> tpset = m_input_queue->try_receive(receive_timeout);
     if(!tpset.has_value()){
       // The condition to exit the loop is that we've been stopped and
       // there's nothing left on the input queue
       if (!running_flag.load()) {
         break;
-      } else {
-        continue;
       }
+      // We need a TPSet's origin before we can send heartbeats for it
+      auto now = std::chrono::steady_clock::now();
+      if (timer_heartbeats && !is_first_tpset_received && now >= next_timer_check) {
+        next_timer_check = now + timer_period;
+        daqdataformats::timestamp_t heartbeat_time =
+          get_timer_heartbeat_time(latest_data_time, now - latest_data_wall_time, last_sent_heartbeat_time);
+        if (heartbeat_time != 0) {
+          TPSet tpset_heartbeat;
+          get_heartbeat(tpset_heartbeat, heartbeat_time);
+          tpset_heartbeat.seqno = sequence_number;
+          // Unlike heartbeats sent with data, a timer heartbeat that times out is
+          // not retried: there will be a later one on the next timer check
+          try {
+            m_output_queue->send(std::move(tpset_heartbeat), m_queue_timeout);
+            ++sequence_number;
+            m_heartbeats_sent++;
+            m_timer_heartbeats_sent++;
+            last_sent_heartbeat_time = heartbeat_time;
+            TLOG_DEBUG(3) << "Sent timer heartbeat at " << heartbeat_time;
+          } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
+            std::ostringstream oss_warn;
+            oss_warn << "push to output queue \"" << m_output_queue->get_name() << "\"";
+            ers::warning(
+              dunedaq::iomanager::TimeoutExpired(ERS_HERE, get_name(), oss_warn.str(), m_queue_timeout.count()));
+          }
+        }
+      }
+      continue;
     }
 
     // We got a TPSet
@@ -115,6 +158,11 @@ FakeTPCreatorHeartbeatMaker::do_work(std::atomic<bool>& running_flag)
     TLOG_DEBUG(3) << "Activity received.";
 
     daqdataformats::timestamp_t current_tpset_start_time = tpset->start_time;
+    if (tpset->end_time > latest_data_time) {
+      latest_data_time = tpset->end_time;
+      latest_data_wall_time = std::chrono::steady_clock::now();
+      next_timer_check = latest_data_wall_time + timer_period;
+    }
 
     bool send_heartbeat =
       should_send_heartbeat(last_sent_heartbeat_time, current_tpset_start_time, is_first_tpset_received);
@@ -160,7 +208,8 @@ FakeTPCreatorHeartbeatMaker::do_work(std::atomic<bool>& running_flag)
   }
 
   TLOG() << "Received " << m_tpset_received_count << " and sent " << m_tpset_sent_count << " real TPSets. Sent "
-         << m_heartbeats_sent << " fake heartbeats." << std::endl;
+         << m_heartbeats_sent << " fake heartbeats, " << m_timer_heartbeats_sent << " of them on the timer."
+         << std::endl;
   TLOG_DEBUG(2) << "Exiting do_work() method";
 }
 
@@ -179,6 +228,34 @@ FakeTPCreatorHeartbeatMaker::should_send_heartbeat(daqdataformats::timestamp_t c
     return last_sent_heartbeat_time + m_heartbeat_interval < current_tpset_start_time;
 }
 
+daqdataformats::timestamp_t
+FakeTPCreatorHeartbeatMaker::get_timer_heartbeat_time(daqdataformats::timestamp_t const& latest_data_time,
+                                                      std::chrono::steady_clock::duration const& since_latest_data,
+                                                      daqdataformats::timestamp_t const& last_sent_heartbeat_time)
+{
+  // The latest data time was seen some time after the data was taken, so
+  // this estimate lags the true data time by the input latency, and
+  // heartbeats at the estimate are not overtaken by data still on its way
+  double since_latest_data_s = std::chrono::duration<double>(since_latest_data).count();
+  daqdataformats::timestamp_t estimate =
+    latest_data_time + static_cast<daqdataformats::timestamp_t>(since_latest_data_s * m_conf.clock_frequency_hz);
+  if (estimate < m_conf.timer_heartbeat_margin) {
+    return 0;
+  }
+  estimate -= m_conf.timer_heartbeat_margin;
+
+  // Line the heartbeat up with the downstream windows, so it completes them
+  daqdataformats::timestamp_t alignment = m_conf.window_time > 0 ? m_conf.window_time : m_heartbeat_interval;
+  daqdataformats::timestamp_t heartbeat_time = alignment > 0 ? (estimate / alignment) * alignment : estimate;
+
+  // Only send a heartbeat when it tells downstream something new: it's after
+  // all of the data we've sent, and a heartbeat interval after the last one
+  if (heartbeat_time <= latest_data_time || heartbeat_time <= last_sent_heartbeat_time + m_heartbeat_interval) {
+    return 0;
+  }
+  return heartbeat_time;
+}
+
 void
 FakeTPCreatorHeartbeatMaker::get_heartbeat(TPSet& tpset_heartbeat,
                                            daqdataformats::timestamp_t const& current_tpset_start_time)
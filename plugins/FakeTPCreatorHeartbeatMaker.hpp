@@ -51,6 +51,11 @@ private:
                              daqdataformats::timestamp_t const& current_tpset_start_time,
                              bool const& is_first_tpset_received);
   void get_heartbeat(TPSet& tpset_heartbeat, daqdataformats::timestamp_t const& current_tpset_start_time);
+  // The heartbeat time due on the timer, given the latest data time seen on
+  // the input and how long ago it was seen. 0 if no heartbeat is due yet
+  daqdataformats::timestamp_t get_timer_heartbeat_time(daqdataformats::timestamp_t const& latest_data_time,
+                                                       std::chrono::steady_clock::duration const& since_latest_data,
+                                                       daqdataformats::timestamp_t const& last_sent_heartbeat_time);
 
   dunedaq::utilities::WorkerThread m_thread;
 
@@ -61,6 +66,7 @@ private:
 
   std::chrono::milliseconds m_queue_timeout;
 
+  faketpcreatorheartbeatmaker::Conf m_conf;
   triggeralgs::timestamp_t m_heartbeat_interval;
 
   daqdataformats::run_number_t m_run_number{ daqdataformats::TypeDefaults::s_invalid_run_number };
@@ -73,6 +79,7 @@ private:
   std::atomic<metric_counter_type> m_tpset_received_count{ 0 };
   std::atomic<metric_counter_type> m_tpset_sent_count{ 0 };
   std::atomic<metric_counter_type> m_heartbeats_sent{ 0 };
+  std::atomic<metric_counter_type> m_timer_heartbeats_sent{ 0 };
 };
 } // namespace trigger
 } // namespace dunedaq
@@ -102,6 +102,7 @@ ModuleLevelTrigger::do_configure(const nlohmann::json& confobj)
   m_trigger_decision_connection = params.dfo_connection;
   m_inhibit_connection = params.dfo_busy_connection;
   m_hsi_passthrough = params.hsi_trigger_type_passthrough;
+  m_placement = make_thread_placement(params.cpus, params.numa_node);
 
   m_configured_flag.store(true);
 
@@ -241,6 +242,7 @@ ModuleLevelTrigger::create_decision(const ModuleLevelTrigger::PendingTD& pending
 void
 ModuleLevelTrigger::send_trigger_decisions()
 {
+  apply_thread_placement(m_placement, get_name() + " decision thread");
 
   // We get here at start of run, so reset the trigger number
   m_last_trigger_number = 0;
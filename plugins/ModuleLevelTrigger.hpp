@@ -16,6 +16,7 @@
 
 #include "trigger/Issues.hpp"
 #include "trigger/LivetimeCounter.hpp"
+#include "trigger/ThreadPlacement.hpp"
 #include "trigger/TokenManager.hpp"
 #include "trigger/moduleleveltriggerinfo/InfoNljs.hpp"
 
@@ -102,6 +103,8 @@ private:
   // Are we in a configured state, ie after conf and before scrap?
   std::atomic<bool> m_configured_flag{ false };
 
+  ThreadPlacement m_placement;
+
   // LivetimeCounter
   std::shared_ptr<LivetimeCounter> m_livetime_counter;
   LivetimeCounter::state_time_t m_lc_kLive_count;
@@ -27,8 +27,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <limits>
+#include <map>
 #include <pthread.h>
 #include <random>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -61,6 +65,17 @@ RandomTriggerCandidateMaker::get_info(opmonlib::InfoCollector& ci, int /*level*/
   randomtriggercandidatemakerinfo::Info i;
 
   i.tc_sent_count = m_tc_sent_count.load();
+  i.tc_failed_send_count = m_tc_failed_send_count.load();
+  i.tc_overlapping_count = m_tc_overlapping_count.load();
+
+  auto now = std::chrono::steady_clock::now();
+  double elapsed_s = std::chrono::duration<double>(now - m_last_info_time).count();
+  // The count is reset at start, so it can go down
+  if (elapsed_s > 0 && i.tc_sent_count >= m_last_info_tc_sent_count) {
+    i.tc_sent_rate_hz = (i.tc_sent_count - m_last_info_tc_sent_count) / elapsed_s;
+  }
+  m_last_info_time = now;
+  m_last_info_tc_sent_count = i.tc_sent_count;
 
   ci.add(i);
 }
@@ -69,6 +84,9 @@ void
 RandomTriggerCandidateMaker::do_configure(const nlohmann::json& obj)
 {
   m_conf = obj.get<randomtriggercandidatemaker::ConfParams>();
+  if (m_conf.time_distribution == randomtriggercandidatemaker::distribution_type::kLoadProfile) {
+    check_load_profile();
+  }
 }
 
 void
@@ -143,6 +161,8 @@ RandomTriggerCandidateMaker::send_trigger_candidates()
 {
   // OpMon.
   m_tc_sent_count.store(0);
+  m_tc_failed_send_count.store(0);
+  m_tc_overlapping_count.store(0);
 
   std::mt19937 gen(m_run_number);
   // Wait for there to be a valid timestamp estimate before we start
@@ -152,6 +172,10 @@ RandomTriggerCandidateMaker::send_trigger_candidates()
   }
 
   dfmessages::timestamp_t initial_timestamp = m_timestamp_estimator->get_timestamp_estimate();
+  if (m_conf.time_distribution == randomtriggercandidatemaker::distribution_type::kLoadProfile) {
+    send_load_profile_candidates(initial_timestamp);
+    return;
+  }
   dfmessages::timestamp_t first_interval = get_interval(gen);
   // Round up to the next multiple of trigger_interval_ticks
   dfmessages::timestamp_t next_trigger_timestamp = (initial_timestamp / first_interval + 1) * first_interval;
@@ -175,6 +199,152 @@ RandomTriggerCandidateMaker::send_trigger_candidates()
   }
 }
 
+TCLoadProfile::Params
+RandomTriggerCandidateMaker::make_load_profile_params() const
+{
+  auto const& conf = m_conf.load_profile;
+  TCLoadProfile::Params params;
+  params.clock_frequency_hz = m_conf.clock_frequency_hz;
+  params.start_rate_hz = conf.start_rate_hz;
+  params.end_rate_hz = conf.end_rate_hz;
+  params.ramp_duration_s = conf.ramp_duration_s;
+  params.poisson = conf.poisson;
+  for (auto const& type_weight : conf.type_mix) {
+    params.type_mix.push_back(
+      { static_cast<triggeralgs::TriggerCandidate::Type>(type_weight.tc_type), type_weight.weight });
+  }
+  switch (conf.window_distribution) {
+    case randomtriggercandidatemaker::window_length_distribution::kFixed:
+      params.window_distribution = TCLoadProfile::WindowDistribution::kFixed;
+      break;
+    case randomtriggercandidatemaker::window_length_distribution::kUniform:
+      params.window_distribution = TCLoadProfile::WindowDistribution::kUniform;
+      break;
+    case randomtriggercandidatemaker::window_length_distribution::kExponential:
+      params.window_distribution = TCLoadProfile::WindowDistribution::kExponential;
+      break;
+  }
+  params.window_ticks = conf.window_ticks;
+  params.min_window_ticks = conf.min_window_ticks;
+  params.max_window_ticks = conf.max_window_ticks;
+  params.window_pre_fraction = conf.window_pre_fraction;
+  for (auto const& train : conf.trains) {
+    params.trains.push_back({ train.start_s,
+                              train.period_s,
+                              train.n_tcs,
+                              static_cast<TCLoadProfile::timestamp_t>(train.spacing_ticks),
+                              static_cast<TCLoadProfile::timestamp_t>(train.window_ticks) });
+  }
+  params.seed = conf.seed != 0 ? conf.seed : m_run_number;
+  return params;
+}
+
+void
+RandomTriggerCandidateMaker::check_load_profile() const
+{
+  // The tick counts are signed in the schema, but unsigned in TCLoadProfile
+  auto check_ticks = [this](int64_t ticks, const std::string& what) {
+    if (ticks < 0) {
+      throw InvalidLoadProfile(ERS_HERE, get_name(), what + " is negative (" + std::to_string(ticks) + ")");
+    }
+  };
+  auto const& conf = m_conf.load_profile;
+  check_ticks(conf.window_ticks, "window_ticks");
+  check_ticks(conf.min_window_ticks, "min_window_ticks");
+  check_ticks(conf.max_window_ticks, "max_window_ticks");
+  for (size_t i = 0; i < conf.trains.size(); ++i) {
+    check_ticks(conf.trains[i].spacing_ticks, "spacing_ticks of train " + std::to_string(i));
+    check_ticks(conf.trains[i].window_ticks, "window_ticks of train " + std::to_string(i));
+  }
+  auto reason = TCLoadProfile::check_params(make_load_profile_params());
+  if (!reason.empty()) {
+    throw InvalidLoadProfile(ERS_HERE, get_name(), reason);
+  }
+}
+
+void
+RandomTriggerCandidateMaker::send_load_profile_candidates(dfmessages::timestamp_t initial_timestamp)
+{
+  TCLoadProfile profile(make_load_profile_params(), initial_timestamp);
+  TLOG_DEBUG(1) << get_name() << " sending TCs from a load profile, starting at timestamp " << initial_timestamp;
+
+  // Statistics for the emitted-rate report, which let us see where the
+  // wall-clock rate falls behind the rate asked for in data time
+  auto const report_interval = std::chrono::duration<double>(m_conf.load_profile.report_interval_s);
+  auto report_start = std::chrono::steady_clock::now();
+  dfmessages::timestamp_t report_start_timestamp = initial_timestamp;
+  size_t n_sent = 0;
+  size_t n_failed = 0;
+  size_t n_overlapping = 0;
+  uint64_t window_sum = 0; // NOLINT(build/unsigned)
+  std::map<triggeralgs::TriggerCandidate::Type, size_t> type_counts;
+
+  auto report = [&](std::chrono::steady_clock::time_point now, dfmessages::timestamp_t timestamp) {
+    double wall_s = std::chrono::duration<double>(now - report_start).count();
+    double data_s = static_cast<double>(timestamp - report_start_timestamp) / m_conf.clock_frequency_hz;
+    std::ostringstream types;
+    for (auto const& [type, count] : type_counts) {
+      types << " " << static_cast<int>(type) << ":" << count;
+    }
+    TLOG() << get_name() << " sent " << n_sent << " TCs in " << wall_s << " s ("
+           << (wall_s > 0 ? n_sent / wall_s : 0) << " Hz), covering " << data_s << " s of data time ("
+           << (data_s > 0 ? (n_sent + n_failed) / data_s : 0) << " Hz asked for). Background rate is now "
+           << profile.get_rate_hz(timestamp) << " Hz. " << n_overlapping << " overlapping, " << n_failed
+           << " failed to send, mean window " << (n_sent > 0 ? window_sum / n_sent : 0) << " ticks. Types:"
+           << types.str();
+    report_start = now;
+    report_start_timestamp = timestamp;
+    n_sent = 0;
+    n_failed = 0;
+    n_overlapping = 0;
+    window_sum = 0;
+    type_counts.clear();
+  };
+
+  dfmessages::timestamp_t previous_time_end = 0;
+  dfmessages::timestamp_t timestamp = initial_timestamp;
+  while (m_running_flag.load()) {
+    triggeralgs::TriggerCandidate candidate = profile.next();
+    if (candidate.time_candidate == std::numeric_limits<triggeralgs::timestamp_t>::max()) {
+      TLOG() << get_name() << " load profile has no TCs to send";
+      break;
+    }
+    if (m_timestamp_estimator->wait_for_timestamp(candidate.time_candidate, m_running_flag) ==
+        timinglibs::TimestampEstimatorBase::kInterrupted) {
+      break;
+    }
+
+    timestamp = candidate.time_candidate;
+    bool overlapping = candidate.time_start < previous_time_end;
+    previous_time_end = std::max(previous_time_end, static_cast<dfmessages::timestamp_t>(candidate.time_end));
+    auto window = candidate.time_end - candidate.time_start;
+    auto type = candidate.type;
+
+    // A storm can fill the queue faster than the MLT empties it. Count
+    // the TCs that don't fit, rather than stopping
+    try {
+      m_trigger_candidate_sink->send(std::move(candidate), std::chrono::milliseconds(10));
+      m_tc_sent_count++;
+      ++n_sent;
+      window_sum += window;
+      ++type_counts[type];
+      if (overlapping) {
+        ++m_tc_overlapping_count;
+        ++n_overlapping;
+      }
+    } catch (const dunedaq::iomanager::TimeoutExpired&) {
+      ++m_tc_failed_send_count;
+      ++n_failed;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - report_start >= report_interval) {
+      report(now, timestamp);
+    }
+  }
+  report(std::chrono::steady_clock::now(), timestamp);
+}
+
 } // namespace trigger
 } // namespace dunedaq
 
@@ -7,6 +7,7 @@
 #ifndef TRIGGER_PLUGINS_RANDOMTRIGGERCANDIDATEMAKER_HPP_
 #define TRIGGER_PLUGINS_RANDOMTRIGGERCANDIDATEMAKER_HPP_
 
+#include "trigger/TCLoadProfile.hpp"
 #include "trigger/TokenManager.hpp"
 #include "trigger/randomtriggercandidatemaker/Nljs.hpp"
 #include "trigger/randomtriggercandidatemakerinfo/InfoNljs.hpp"
@@ -23,6 +24,7 @@
 #include "timinglibs/TimestampEstimator.hpp"
 #include "triggeralgs/TriggerCandidate.hpp"
 
+#include <chrono>
 #include <memory>
 #include <random>
 #include <set>
@@ -37,6 +39,10 @@ namespace trigger {
  * @brief RandomTriggerCandidateMaker creates TriggerCandidates at regular or
  * Poisson random intervals, based on input from a TimeSync queue or the system
  * clock. The TCs can be fed directly into the MLT.
+ *
+ * With the kLoadProfile distribution, the TCs come from a TCLoadProfile
+ * instead, for stress-testing the MLT and dataflow, and the emitted
+ * rate is reported periodically
  */
 class RandomTriggerCandidateMaker : public dunedaq::appfwk::DAQModule
 {
@@ -82,6 +88,12 @@ private:
 
   int get_interval(std::mt19937& gen);
 
+  // Send the TCs from the configured load profile, starting at initial_timestamp
+  void send_load_profile_candidates(dfmessages::timestamp_t initial_timestamp);
+  TCLoadProfile::Params make_load_profile_params() const;
+  // Throw InvalidLoadProfile if the configured load profile can't be used
+  void check_load_profile() const;
+
   dfmessages::run_number_t m_run_number;
 
   // Are we in the RUNNING state?
@@ -92,6 +104,11 @@ private:
   // OpMon variables
   using metric_counter_type = decltype(randomtriggercandidatemakerinfo::Info::tc_sent_count);
   std::atomic<metric_counter_type> m_tc_sent_count{ 0 };
+  std::atomic<metric_counter_type> m_tc_failed_send_count{ 0 };
+  std::atomic<metric_counter_type> m_tc_overlapping_count{ 0 };
+  // For the rate since the last get_info()
+  std::chrono::steady_clock::time_point m_last_info_time{ std::chrono::steady_clock::now() };
+  metric_counter_type m_last_info_tc_sent_count{ 0 };
 };
 } // namespace trigger
 } // namespace dunedaq
@@ -0,0 +1,193 @@
+/**
+ * @file ShmSetReceiver.hpp ShmSetReceiver is an appfwk::DAQModule that reads sets from a shared-memory ring
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_PLUGINS_SHMSETRECEIVER_HPP_
+#define TRIGGER_PLUGINS_SHMSETRECEIVER_HPP_
+
+#include "trigger/Issues.hpp"
+#include "trigger/SetPool.hpp"
+#include "trigger/SetRing.hpp"
+#include "trigger/ShmRing.hpp"
+#include "trigger/ShmSetCodec.hpp"
+#include "trigger/shmsetreceiver/Nljs.hpp"
+#include "trigger/shmsetreceiverinfo/InfoNljs.hpp"
+
+#include "appfwk/DAQModule.hpp"
+#include "appfwk/DAQModuleHelper.hpp"
+#include "iomanager/IOManager.hpp"
+#include "iomanager/Sender.hpp"
+#include "logging/Logging.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief ShmSetReceiver sends on each set that a ShmSetSender in another process writes to a shared-memory ring
+ *
+ * Each set is decoded straight out of its slot into a pooled set; for a
+ * TPSet that's one copy of the TPs. The slot is only freed once the set
+ * has been sent on, so if this process dies, the set it was handling is
+ * sent again by the next process to attach to the ring. If the module
+ * on the output takes its input locally, the set goes to it through a
+ * SetRing
+ */
+template<class TSET>
+class ShmSetReceiver : public dunedaq::appfwk::DAQModule
+{
+public:
+  explicit ShmSetReceiver(const std::string& name)
+    : DAQModule(name)
+    , m_thread(std::bind(&ShmSetReceiver<TSET>::do_work, this, std::placeholders::_1))
+  {
+    register_command("conf", &ShmSetReceiver<TSET>::do_conf);
+    register_command("start", &ShmSetReceiver<TSET>::do_start);
+    register_command("stop", &ShmSetReceiver<TSET>::do_stop);
+    register_command("scrap", &ShmSetReceiver<TSET>::do_scrap);
+  }
+
+  ShmSetReceiver(const ShmSetReceiver&) = delete;
+  ShmSetReceiver& operator=(const ShmSetReceiver&) = delete;
+  ShmSetReceiver(ShmSetReceiver&&) = delete;
+  ShmSetReceiver& operator=(ShmSetReceiver&&) = delete;
+
+  void init(const nlohmann::json& iniobj) override
+  {
+    try {
+      m_output_uid = appfwk::connection_uid(iniobj, "output");
+      m_output_queue = get_iom_sender<TSET>(m_output_uid);
+    } catch (const ers::Issue& excpt) {
+      throw dunedaq::trigger::InvalidQueueFatalError(ERS_HERE, get_name(), "output", excpt);
+    }
+  }
+
+  void get_info(opmonlib::InfoCollector& ci, int /*level*/) override
+  {
+    shmsetreceiverinfo::Info info;
+    info.received_count = m_received_count.load();
+    info.sent_count = m_sent_count.load();
+    info.failed_send_count = m_failed_send_count.load();
+    info.bad_set_count = m_bad_set_count.load();
+    ci.add(info);
+  }
+
+private:
+  void do_conf(const nlohmann::json& config)
+  {
+    m_conf = config.get<shmsetreceiver::ConfParams>();
+    // Attaching may throw ShmRingError, which fails the command
+    m_ring = std::make_unique<ShmRing>(m_conf.ring_name, ShmRing::Role::kReader, m_conf.n_slots, m_conf.slot_size);
+    TLOG() << get_name() << ": Reading from shared-memory ring " << m_ring->get_name() << " of " << m_ring->n_slots()
+           << " slots of " << m_ring->slot_size() << " bytes";
+  }
+
+  void do_start(const nlohmann::json&)
+  {
+    m_received_count.store(0);
+    m_sent_count.store(0);
+    m_failed_send_count.store(0);
+    m_bad_set_count.store(0);
+    m_output_ring = SetRingRegistry<TSET>::find(m_output_uid);
+    if (m_output_ring) {
+      TLOG() << get_name() << ": Sending to " << m_output_uid << " through a local ring";
+    }
+    m_thread.start_working_thread("shm-receiver");
+    TLOG_DEBUG(2) << get_name() + " successfully started.";
+  }
+
+  void do_stop(const nlohmann::json&)
+  {
+    m_thread.stop_working_thread();
+    m_output_ring.reset();
+    TLOG() << get_name() << ": Read " << m_received_count << " sets from the ring. Sent " << m_sent_count
+           << ". Dropped " << m_failed_send_count << " that failed to send and " << m_bad_set_count
+           << " that couldn't be decoded";
+  }
+
+  // Detach from the ring, so that another process can take the reader
+  // role. The ring itself stays, with anything in it not yet read
+  void do_scrap(const nlohmann::json&) { m_ring.reset(); }
+
+  void do_work(std::atomic<bool>& running_flag)
+  {
+    auto send_timeout = std::chrono::milliseconds(m_conf.send_timeout_ms);
+    while (true) {
+      // Once we've been stopped, only take what's already in the ring
+      auto read_timeout = std::chrono::milliseconds(running_flag.load() ? 100 : 0);
+      size_t size = 0;
+      const uint8_t* slot = m_ring->begin_read(size, read_timeout); // NOLINT(build/unsigned)
+      if (slot == nullptr) {
+        if (!running_flag.load()) {
+          break;
+        }
+        continue;
+      }
+      ++m_received_count;
+
+      TSET set = SetPool<typename TSET::element_t>::get().acquire();
+      try {
+        decode_shm_set(slot, size, set);
+      } catch (const ers::Issue& excpt) {
+        ++m_bad_set_count;
+        ers::error(BadShmSet(ERS_HERE, get_name(), m_ring->get_name(), excpt));
+        m_ring->commit_read();
+        continue;
+      } catch (const std::exception&) {
+        ++m_bad_set_count;
+        ers::error(BadShmSet(ERS_HERE, get_name(), m_ring->get_name()));
+        m_ring->commit_read();
+        continue;
+      }
+
+      try {
+        if (m_output_ring) {
+          if (!m_output_ring->push(std::move(set), send_timeout)) {
+            throw iomanager::TimeoutExpired(
+              ERS_HERE, get_name(), "push to local ring \"" + m_output_uid + "\"", send_timeout.count());
+          }
+        } else {
+          m_output_queue->send(std::move(set), send_timeout);
+        }
+        ++m_sent_count;
+      } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
+        ++m_failed_send_count;
+        ers::warning(excpt);
+        SetPool<typename TSET::element_t>::get().release(std::move(set));
+      }
+      m_ring->commit_read();
+    }
+  }
+
+  using sink_t = dunedaq::iomanager::SenderConcept<TSET>;
+  using metric_counter_type = decltype(shmsetreceiverinfo::Info::sent_count);
+
+  dunedaq::utilities::WorkerThread m_thread;
+  std::string m_output_uid;
+  std::shared_ptr<sink_t> m_output_queue;
+  std::shared_ptr<SetRing<TSET>> m_output_ring;
+  shmsetreceiver::ConfParams m_conf;
+  std::unique_ptr<ShmRing> m_ring;
+
+  std::atomic<metric_counter_type> m_received_count{ 0 };
+  std::atomic<metric_counter_type> m_sent_count{ 0 };
+  std::atomic<metric_counter_type> m_failed_send_count{ 0 };
+  std::atomic<metric_counter_type> m_bad_set_count{ 0 };
+};
+
+} // namespace dunedaq::trigger
+
+/// Need one of these in a .cpp for each concrete TSET type
+// DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::ShmSetReceiver<TSET>)
+
+#endif // TRIGGER_PLUGINS_SHMSETRECEIVER_HPP_
@@ -0,0 +1,171 @@
+/**
+ * @file ShmSetSender.hpp ShmSetSender is an appfwk::DAQModule that writes sets to a shared-memory ring
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_PLUGINS_SHMSETSENDER_HPP_
+#define TRIGGER_PLUGINS_SHMSETSENDER_HPP_
+
+#include "trigger/Issues.hpp"
+#include "trigger/SetPool.hpp"
+#include "trigger/ShmRing.hpp"
+#include "trigger/ShmSetCodec.hpp"
+#include "trigger/shmsetsender/Nljs.hpp"
+#include "trigger/shmsetsenderinfo/InfoNljs.hpp"
+
+#include "appfwk/DAQModule.hpp"
+#include "appfwk/DAQModuleHelper.hpp"
+#include "iomanager/IOManager.hpp"
+#include "iomanager/Receiver.hpp"
+#include "logging/Logging.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief ShmSetSender writes each set from its input to a shared-memory ring
+ *
+ * The ShmSetReceiver at the other end of the ring, in another process
+ * on the same host, sends the sets on to its output. The pair stands in
+ * for a network connection between the two processes: each set is
+ * encoded straight into a slot of the ring, with no serialization
+ * buffer and no socket. A set that doesn't fit in a slot, or for which
+ * no slot comes free in time, is dropped
+ */
+template<class TSET>
+class ShmSetSender : public dunedaq::appfwk::DAQModule
+{
+public:
+  explicit ShmSetSender(const std::string& name)
+    : DAQModule(name)
+    , m_thread(std::bind(&ShmSetSender<TSET>::do_work, this, std::placeholders::_1))
+  {
+    register_command("conf", &ShmSetSender<TSET>::do_conf);
+    register_command("start", &ShmSetSender<TSET>::do_start);
+    register_command("stop", &ShmSetSender<TSET>::do_stop);
+    register_command("scrap", &ShmSetSender<TSET>::do_scrap);
+  }
+
+  ShmSetSender(const ShmSetSender&) = delete;
+  ShmSetSender& operator=(const ShmSetSender&) = delete;
+  ShmSetSender(ShmSetSender&&) = delete;
+  ShmSetSender& operator=(ShmSetSender&&) = delete;
+
+  void init(const nlohmann::json& iniobj) override
+  {
+    try {
+      m_input_queue = get_iom_receiver<TSET>(appfwk::connection_uid(iniobj, "input"));
+    } catch (const ers::Issue& excpt) {
+      throw dunedaq::trigger::InvalidQueueFatalError(ERS_HERE, get_name(), "input", excpt);
+    }
+  }
+
+  void get_info(opmonlib::InfoCollector& ci, int /*level*/) override
+  {
+    shmsetsenderinfo::Info info;
+    info.received_count = m_received_count.load();
+    info.sent_count = m_sent_count.load();
+    info.dropped_ring_full_count = m_dropped_ring_full_count.load();
+    info.dropped_too_large_count = m_dropped_too_large_count.load();
+    if (auto ring = std::atomic_load(&m_ring)) {
+      info.ring_depth = ring->size();
+    }
+    ci.add(info);
+  }
+
+private:
+  void do_conf(const nlohmann::json& config)
+  {
+    m_conf = config.get<shmsetsender::ConfParams>();
+    // Attaching may throw ShmRingError, which fails the command
+    std::atomic_store(&m_ring,
+                      std::make_shared<ShmRing>(
+                        m_conf.ring_name, ShmRing::Role::kWriter, m_conf.n_slots, m_conf.slot_size));
+    TLOG() << get_name() << ": Writing to shared-memory ring " << m_ring->get_name() << " of " << m_ring->n_slots()
+           << " slots of " << m_ring->slot_size() << " bytes";
+  }
+
+  void do_start(const nlohmann::json&)
+  {
+    m_received_count.store(0);
+    m_sent_count.store(0);
+    m_dropped_ring_full_count.store(0);
+    m_dropped_too_large_count.store(0);
+    m_thread.start_working_thread("shm-sender");
+    TLOG_DEBUG(2) << get_name() + " successfully started.";
+  }
+
+  void do_stop(const nlohmann::json&)
+  {
+    m_thread.stop_working_thread();
+    TLOG() << get_name() << ": Received " << m_received_count << " sets. Wrote " << m_sent_count
+           << " to the ring. Dropped " << m_dropped_ring_full_count << " with the ring full and "
+           << m_dropped_too_large_count << " that were too large for a slot";
+  }
+
+  // Detach from the ring, so that another process can take the writer
+  // role. The ring itself stays, with anything in it not yet read
+  void do_scrap(const nlohmann::json&) { std::atomic_store(&m_ring, std::shared_ptr<ShmRing>()); }
+
+  void do_work(std::atomic<bool>& running_flag)
+  {
+    auto timeout = std::chrono::milliseconds(m_conf.send_timeout_ms);
+    while (true) {
+      TSET set;
+      try {
+        set = m_input_queue->receive(std::chrono::milliseconds(100));
+        ++m_received_count;
+      } catch (const dunedaq::iomanager::TimeoutExpired&) {
+        // The condition to exit the loop is that we've been stopped and
+        // there's nothing left on the input queue
+        if (!running_flag.load()) {
+          break;
+        }
+        continue;
+      }
+
+      uint8_t* slot = m_ring->begin_write(timeout); // NOLINT(build/unsigned)
+      if (slot == nullptr) {
+        ++m_dropped_ring_full_count;
+        ers::warning(dunedaq::iomanager::TimeoutExpired(
+          ERS_HERE, get_name(), "write to shared-memory ring " + m_ring->get_name(), timeout.count()));
+      } else if (size_t size = encode_shm_set(set, slot, m_ring->slot_size()); size == 0) {
+        ++m_dropped_too_large_count;
+        ers::warning(ShmSetTooLarge(ERS_HERE, get_name(), set.seqno, m_ring->slot_size(), m_ring->get_name()));
+      } else {
+        m_ring->commit_write(size);
+        ++m_sent_count;
+      }
+      SetPool<typename TSET::element_t>::get().release(std::move(set));
+    }
+  }
+
+  using source_t = dunedaq::iomanager::ReceiverConcept<TSET>;
+  using metric_counter_type = decltype(shmsetsenderinfo::Info::sent_count);
+
+  dunedaq::utilities::WorkerThread m_thread;
+  std::shared_ptr<source_t> m_input_queue;
+  shmsetsender::ConfParams m_conf;
+  std::shared_ptr<ShmRing> m_ring;
+
+  std::atomic<metric_counter_type> m_received_count{ 0 };
+  std::atomic<metric_counter_type> m_sent_count{ 0 };
+  std::atomic<metric_counter_type> m_dropped_ring_full_count{ 0 };
+  std::atomic<metric_counter_type> m_dropped_too_large_count{ 0 };
+};
+
+} // namespace dunedaq::trigger
+
+/// Need one of these in a .cpp for each concrete TSET type
+// DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::ShmSetSender<TSET>)
+
+#endif // TRIGGER_PLUGINS_SHMSETSENDER_HPP_
@@ -0,0 +1,238 @@
+/**
+ * @file SyntheticTPGenerator.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "SyntheticTPGenerator.hpp"
+
+#include "appfwk/DAQModuleHelper.hpp"
+#include "iomanager/IOManager.hpp"
+#include "logging/Logging.hpp"
+#include "rcif/cmd/Nljs.hpp"
+
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace dunedaq {
+namespace trigger {
+SyntheticTPGenerator::SyntheticTPGenerator(const std::string& name)
+  : DAQModule(name)
+  , m_thread(std::bind(&SyntheticTPGenerator::do_work, this, std::placeholders::_1))
+  , m_output_queue(nullptr)
+  , m_queue_timeout(100)
+{
+
+  register_command("conf", &SyntheticTPGenerator::do_conf);
+  register_command("start", &SyntheticTPGenerator::do_start);
+  register_command("stop_trigger_sources", &SyntheticTPGenerator::do_stop);
+  register_command("scrap", &SyntheticTPGenerator::do_scrap);
+}
+
+void
+SyntheticTPGenerator::init(const nlohmann::json& iniobj)
+{
+  try {
+    m_output_queue = get_iom_sender<trigger::TPSet>(appfwk::connection_uid(iniobj, "tpset_sink"));
+  } catch (const ers::Issue& excpt) {
+    throw dunedaq::trigger::InvalidQueueFatalError(ERS_HERE, get_name(), "output", excpt);
+  }
+}
+
+void
+SyntheticTPGenerator::get_info(opmonlib::InfoCollector& ci, int /*level*/)
+{
+  synthetictpgeneratorinfo::Info i;
+
+  i.tpset_sent_count = m_tpset_sent_count.load();
+  i.tp_sent_count = m_tp_sent_count.load();
+  i.heartbeats_sent = m_heartbeats_sent.load();
+  i.failed_to_send_count = m_failed_to_send_count.load();
+
+  ci.add(i);
+}
+
+void
+SyntheticTPGenerator::do_conf(const nlohmann::json& conf)
+{
+  m_conf = conf.get<synthetictpgenerator::ConfParams>();
+  if (m_conf.tpset_time_width == 0) {
+    m_conf.tpset_time_width = 1;
+  }
+  TLOG_DEBUG(2) << get_name() + " configured.";
+}
+
+void
+SyntheticTPGenerator::do_start(const nlohmann::json& args)
+{
+  rcif::cmd::StartParams start_params = args.get<rcif::cmd::StartParams>();
+  m_run_number = start_params.run;
+
+  m_thread.start_working_thread("synthetic-tps");
+  TLOG_DEBUG(2) << get_name() + " successfully started.";
+}
+
+void
+SyntheticTPGenerator::do_stop(const nlohmann::json&)
+{
+  m_thread.stop_working_thread();
+  TLOG_DEBUG(2) << get_name() + " successfully stopped.";
+}
+
+void
+SyntheticTPGenerator::do_scrap(const nlohmann::json&)
+{}
+
+bool
+SyntheticTPGenerator::send(TPSet&& tpset)
+{
+  try {
+    m_output_queue->send(std::move(tpset), m_queue_timeout);
+    return true;
+  } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
+    ers::warning(excpt);
+    ++m_failed_to_send_count;
+    return false;
+  }
+}
+
+bool
+SyntheticTPGenerator::sleep_until(std::atomic<bool>& running_flag, std::chrono::steady_clock::time_point time) const
+{
+  while (true) {
+    if (!running_flag.load()) {
+      return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (time - now <= s_sleep_slice) {
+      std::this_thread::sleep_until(time);
+      return true;
+    }
+    std::this_thread::sleep_until(now + s_sleep_slice);
+  }
+}
+
+void
+SyntheticTPGenerator::do_work(std::atomic<bool>& running_flag)
+{
+  m_tpset_sent_count.store(0);
+  m_tp_sent_count.store(0);
+  m_heartbeats_sent.store(0);
+  m_failed_to_send_count.store(0);
+
+  SyntheticTPSource::Params params;
+  params.first_channel = m_conf.first_channel;
+  params.n_channels = m_conf.n_channels;
+  params.detid = m_conf.detid;
+  params.clock_frequency_hz = m_conf.clock_frequency_hz;
+  params.noise_rate_hz = m_conf.noise_rate_hz;
+  params.burst_rate_hz = m_conf.burst_rate_hz;
+  params.burst_duration_ticks = m_conf.burst_duration_ticks;
+  params.burst_noise_factor = m_conf.burst_noise_factor;
+  params.cluster_rate_hz = m_conf.cluster_rate_hz;
+  params.cluster_mean_n_tps = m_conf.cluster_mean_n_tps;
+  params.cluster_channel_spread = m_conf.cluster_channel_spread;
+  params.cluster_time_spread_ticks = m_conf.cluster_time_spread_ticks;
+  params.track_rate_hz = m_conf.track_rate_hz;
+  params.track_n_channels = m_conf.track_n_channels;
+  params.track_ticks_per_channel = m_conf.track_ticks_per_channel;
+  params.seed = m_conf.seed;
+
+  auto const run_start_time = std::chrono::steady_clock::now();
+
+  triggeralgs::timestamp_t start_timestamp = m_conf.start_timestamp;
+  if (start_timestamp == 0) {
+    auto now_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+    start_timestamp = now_us * (m_conf.clock_frequency_hz / 1'000'000);
+  }
+
+  // The TPSet boundaries are ( n*tpset_time_width + tpset_time_offset ), as in TriggerPrimitiveMaker
+  auto const width = m_conf.tpset_time_width;
+  auto const offset = m_conf.tpset_time_offset;
+  triggeralgs::timestamp_t window_start = ((start_timestamp + offset) / width) * width + offset;
+  auto const first_window_start = window_start;
+
+  SyntheticTPSource source(params, window_start);
+
+  TPSet::seqno_t sequence_number = 0;
+  triggeralgs::timestamp_t last_heartbeat_time = 0;
+  bool first_heartbeat = true;
+  TPSet tpset;
+
+  while (running_flag.load()) {
+    triggeralgs::timestamp_t window_end = window_start + width;
+
+    // A TPSet can't be sent until the end of its window has passed
+    if (!m_conf.unpaced) {
+      auto wait_us = static_cast<double>(window_end - first_window_start) / m_conf.clock_frequency_hz * 1e6;
+      if (!sleep_until(running_flag, run_start_time + std::chrono::microseconds(static_cast<int64_t>(wait_us)))) {
+        break;
+      }
+    }
+
+    // The heartbeat comes before the payload, and its time is no later
+    // than the payload's start time, so downstream sees a consistent
+    // sequence. Heartbeats are sent whether or not there are TPs
+    if (m_conf.heartbeat_interval > 0) {
+      triggeralgs::timestamp_t heartbeat_time =
+        (window_start / m_conf.heartbeat_interval) * m_conf.heartbeat_interval;
+      if (first_heartbeat || heartbeat_time > last_heartbeat_time) {
+        TPSet heartbeat;
+        heartbeat.type = TPSet::Type::kHeartbeat;
+        heartbeat.start_time = heartbeat_time;
+        heartbeat.end_time = heartbeat_time;
+        heartbeat.run_number = m_run_number;
+        heartbeat.origin = daqdataformats::SourceID(daqdataformats::SourceID::Subsystem::kTrigger, m_conf.element_id);
+        heartbeat.seqno = sequence_number;
+        ++sequence_number;
+        if (send(std::move(heartbeat))) {
+          ++m_heartbeats_sent;
+        }
+        last_heartbeat_time = heartbeat_time;
+        first_heartbeat = false;
+      }
+    }
+
+    tpset.objects.clear();
+    source.generate(window_start, window_end, tpset.objects);
+    if (!tpset.objects.empty()) {
+      size_t n_tps = tpset.objects.size();
+      tpset.type = TPSet::Type::kPayload;
+      tpset.start_time = window_start;
+      tpset.end_time = window_end;
+      tpset.run_number = m_run_number;
+      tpset.origin = daqdataformats::SourceID(daqdataformats::SourceID::Subsystem::kTrigger, m_conf.element_id);
+      tpset.seqno = sequence_number;
+      ++sequence_number;
+      if (send(std::move(tpset))) {
+        ++m_tpset_sent_count;
+        m_tp_sent_count += n_tps;
+      }
+    }
+
+    window_start = window_end;
+  }
+
+  auto time_ms =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - run_start_time).count();
+  float data_time_ms = 1e3 * static_cast<float>(window_start - first_window_start) / m_conf.clock_frequency_hz;
+  float rate_hz = time_ms > 0 ? 1e3 * static_cast<float>(m_tpset_sent_count.load()) / time_ms : 0;
+  float tp_rate_hz = time_ms > 0 ? 1e3 * static_cast<float>(m_tp_sent_count.load()) / time_ms : 0;
+
+  TLOG() << "Generated " << m_tpset_sent_count << " TP sets (" << m_tp_sent_count << " TPs) and " << m_heartbeats_sent
+         << " heartbeats, covering " << data_time_ms << " ms of data, in " << time_ms << " ms. (" << rate_hz
+         << " TPSets/s, " << tp_rate_hz << " TPs/s). Generated " << source.get_n_bursts() << " bursts, "
+         << source.get_n_clusters() << " clusters and " << source.get_n_tracks() << " tracks. "
+         << m_failed_to_send_count << " failed to send";
+  TLOG_DEBUG(2) << "Exiting do_work() method";
+}
+
+} // namespace trigger
+} // namespace dunedaq
+
+DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::SyntheticTPGenerator)
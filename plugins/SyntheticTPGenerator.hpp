@@ -0,0 +1,88 @@
+/**
+ * @file SyntheticTPGenerator.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_PLUGINS_SYNTHETICTPGENERATOR_HPP_
+#define TRIGGER_PLUGINS_SYNTHETICTPGENERATOR_HPP_
+
+#include "trigger/Issues.hpp"
+#include "trigger/SyntheticTPSource.hpp"
+#include "trigger/TPSet.hpp"
+#include "trigger/synthetictpgenerator/Nljs.hpp"
+#include "trigger/synthetictpgeneratorinfo/InfoNljs.hpp"
+
+#include "appfwk/DAQModule.hpp"
+#include "iomanager/Sender.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace dunedaq {
+namespace trigger {
+
+/**
+ * @brief SyntheticTPGenerator sends TPSets of synthetic TPs, made by a
+ * SyntheticTPSource, at a configured rate, with heartbeats
+ *
+ * Either paced to the system clock, or, in unpaced mode, as fast as the
+ * output accepts them. The TPs never run out, and are determined by the
+ * seed and start timestamp, so the downstream chain can be benchmarked
+ * reproducibly
+ */
+class SyntheticTPGenerator : public dunedaq::appfwk::DAQModule
+{
+public:
+  explicit SyntheticTPGenerator(const std::string& name);
+
+  SyntheticTPGenerator(const SyntheticTPGenerator&) = delete;
+  SyntheticTPGenerator& operator=(const SyntheticTPGenerator&) = delete;
+  SyntheticTPGenerator(SyntheticTPGenerator&&) = delete;
+  SyntheticTPGenerator& operator=(SyntheticTPGenerator&&) = delete;
+
+  void init(const nlohmann::json& iniobj) override;
+  void get_info(opmonlib::InfoCollector& ci, int level) override;
+
+private:
+  void do_conf(const nlohmann::json& config);
+  void do_start(const nlohmann::json& obj);
+  void do_stop(const nlohmann::json& obj);
+  void do_scrap(const nlohmann::json& obj);
+  void do_work(std::atomic<bool>&);
+
+  // Try to send the set. Returns false if it timed out
+  bool send(TPSet&& tpset);
+  // Sleep until time, in slices so that a stop isn't held up. Returns false if we were stopped
+  bool sleep_until(std::atomic<bool>& running_flag, std::chrono::steady_clock::time_point time) const;
+
+  // The longest we sleep before checking whether we've been stopped
+  static constexpr std::chrono::milliseconds s_sleep_slice{ 10 };
+
+  dunedaq::utilities::WorkerThread m_thread;
+
+  using sink_t = dunedaq::iomanager::SenderConcept<TPSet>;
+  std::shared_ptr<sink_t> m_output_queue;
+
+  std::chrono::milliseconds m_queue_timeout;
+
+  synthetictpgenerator::ConfParams m_conf;
+
+  daqdataformats::run_number_t m_run_number{ daqdataformats::TypeDefaults::s_invalid_run_number };
+
+  // Opmon variables
+  using metric_counter_type = decltype(synthetictpgeneratorinfo::Info::tpset_sent_count);
+  std::atomic<metric_counter_type> m_tpset_sent_count{ 0 };
+  std::atomic<metric_counter_type> m_tp_sent_count{ 0 };
+  std::atomic<metric_counter_type> m_heartbeats_sent{ 0 };
+  std::atomic<metric_counter_type> m_failed_to_send_count{ 0 };
+};
+} // namespace trigger
+} // namespace dunedaq
+
+#endif // TRIGGER_PLUGINS_SYNTHETICTPGENERATOR_HPP_
@@ -10,6 +10,7 @@
 
 #include "appfwk/DAQModuleHelper.hpp"
 #include "daqdataformats/SourceID.hpp"
+#include "trigger/txbufferconfig/Nljs.hpp"
 
 #include <string>
 
@@ -58,6 +59,9 @@ TABuffer::do_conf(const nlohmann::json& args)
   m_latency_buffer_impl->conf(args);
   m_request_handler_impl->conf(args);
 
+  auto conf = args.get<txbufferconfig::Conf>();
+  m_placement = make_thread_placement(conf.cpus, conf.numa_node);
+
   TLOG_DEBUG(2) << get_name() + " configured.";
 }
 
@@ -88,6 +92,9 @@ TABuffer::do_scrap(const nlohmann::json& args)
 void
 TABuffer::do_work(std::atomic<bool>& running_flag)
 {
+  // First, so that the buffer's entries, which this thread allocates, come from our NUMA node
+  apply_thread_placement(m_placement, get_name() + " buffer thread");
+
   size_t n_tas_received = 0;
   size_t n_requests_received = 0;
 
@@ -20,6 +20,7 @@
 
 #include "trigger/Issues.hpp"
 #include "trigger/TASet.hpp"
+#include "trigger/ThreadPlacement.hpp"
 
 #include <chrono>
 #include <map>
@@ -124,6 +125,7 @@ private:
   std::shared_ptr<dr_source_t> m_input_queue_dr{nullptr};
 
   std::chrono::milliseconds m_queue_timeout;
+  ThreadPlacement m_placement;
 
   using buffer_object_t = TAWrapper;
   using latency_buffer_t = readoutlibs::SkipListLatencyBufferModel<buffer_object_t>;
@@ -0,0 +1,18 @@
+/**
+ * @file TASetShmReceiver.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "ShmSetReceiver.hpp"
+#include "trigger/TASet.hpp"
+
+namespace dunedaq::trigger {
+
+using TASetShmReceiver = ShmSetReceiver<TASet>;
+
+} // namespace dunedaq::trigger
+
+DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::TASetShmReceiver)
@@ -0,0 +1,18 @@
+/**
+ * @file TASetShmSender.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "ShmSetSender.hpp"
+#include "trigger/TASet.hpp"
+
+namespace dunedaq::trigger {
+
+using TASetShmSender = ShmSetSender<TASet>;
+
+} // namespace dunedaq::trigger
+
+DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::TASetShmSender)
@@ -22,6 +22,7 @@
 #include "utilities/WorkerThread.hpp"
 
 #include "trigger/Issues.hpp"
+#include "trigger/ThreadPlacement.hpp"
 #include "triggeralgs/TriggerCandidate.hpp"
 
 #include <chrono>
@@ -121,6 +122,7 @@ private:
   std::shared_ptr<dr_source_t> m_input_queue_dr{nullptr};
 
   std::chrono::milliseconds m_queue_timeout;
+  ThreadPlacement m_placement;
 
   using buffer_object_t = TCWrapper;
   using latency_buffer_t = readoutlibs::SkipListLatencyBufferModel<buffer_object_t>;
@@ -20,7 +20,6 @@ TPChannelFilter::TPChannelFilter(const std::string& name)
   : DAQModule(name)
   , m_thread(std::bind(&TPChannelFilter::do_work, this, std::placeholders::_1))
   , m_input_queue(nullptr)
-  , m_output_queue(nullptr)
   , m_queue_timeout(100)
 {
 
@@ -35,7 +34,8 @@ TPChannelFilter::init(const nlohmann::json& iniobj)
 {
   try {
     m_input_queue = get_iom_receiver<TPSet>(appfwk::connection_uid(iniobj, "tpset_source"));
-    m_output_queue = get_iom_sender<TPSet>(appfwk::connection_uid(iniobj, "tpset_sink"));
+    m_output_queue = WireFormatSender<TPSet>(get_iom_sender<TPSet>(appfwk::connection_uid(iniobj, "tpset_sink")),
+                                             TPSetWireFormat::kMsgPack);
   } catch (const ers::Issue& excpt) {
     throw dunedaq::trigger::InvalidQueueFatalError(ERS_HERE, get_name(), "input/output", excpt);
   }
@@ -50,19 +50,54 @@ TPChannelFilter::do_conf(const nlohmann::json& conf_arg)
 {
   m_conf = conf_arg.get<dunedaq::trigger::tpchannelfilter::Conf>();
   m_channel_map = dunedaq::detchannelmaps::make_map(m_conf.channel_map_name);
+  switch (m_conf.output_wire_format) {
+    case tpchannelfilter::WireFormat::kFlat:
+      m_output_queue.set_format(TPSetWireFormat::kFlat);
+      break;
+    case tpchannelfilter::WireFormat::kCompact:
+      m_output_queue.set_format(TPSetWireFormat::kCompact);
+      break;
+    default:
+      m_output_queue.set_format(TPSetWireFormat::kMsgPack);
+  }
 }
 
 void
 TPChannelFilter::do_start(const nlohmann::json&)
 {
-  m_thread.start_working_thread("channelfilter");
-  TLOG_DEBUG(2) << get_name() + " successfully started.";
+  if (!m_conf.use_executor) {
+    m_thread.start_working_thread("channelfilter");
+    TLOG_DEBUG(2) << get_name() + " successfully started.";
+    return;
+  }
+  auto& executor = TaskExecutor::get();
+  if (!m_task) {
+    m_task = executor.make_task(get_name(), [this] { return run_task(); }, s_task_poll_interval);
+  }
+  executor.start_task(*m_task);
+  m_task_running = true;
+  TLOG_DEBUG(2) << get_name() << " successfully started as a task on the shared executor, which has "
+                << executor.n_threads() << " threads";
 }
 
 void
 TPChannelFilter::do_stop(const nlohmann::json&)
 {
-  m_thread.stop_working_thread();
+  if (!m_task_running) {
+    m_thread.stop_working_thread();
+    TLOG_DEBUG(2) << get_name() + " successfully stopped.";
+    return;
+  }
+  // As do_work() does, filter what's left of the input before finishing
+  TaskExecutor::get().stop_task(*m_task);
+  m_task_running = false;
+  while (true) {
+    std::optional<TPSet> tpset = m_input_queue->try_receive(std::chrono::milliseconds(0));
+    if (!tpset.has_value()) {
+      break;
+    }
+    process(*tpset);
+  }
   TLOG_DEBUG(2) << get_name() + " successfully stopped.";
 }
 
@@ -110,33 +145,54 @@ TPChannelFilter::do_work(std::atomic<bool>& running_flag)
     }
 
     // If we got here, we got a TPSet
-    
-    // Actually do the removal for payload TPSets. Leave heartbeat TPSets unmolested
-
-    if (tpset->type == TPSet::kPayload) {
-      size_t n_before = tpset->objects.size();
-      auto it = std::remove_if(tpset->objects.begin(), tpset->objects.end(), [this](triggeralgs::TriggerPrimitive p) {
-        return channel_should_be_removed(p.channel);
-      });
-      tpset->objects.erase(it, tpset->objects.end());
-      size_t n_after = tpset->objects.size();
-      TLOG_DEBUG(2) << "Removed " << (n_before - n_after) << " TPs out of " << n_before;
-    }
+    process(*tpset);
+  } // while(true)
+  TLOG_DEBUG(2) << "Exiting do_work() method";
+}
 
-    // The rule is that we don't send empty TPSets, so ensure that
-    if (!tpset->objects.empty()) {
-      try {
-        m_output_queue->send(std::move(*tpset), m_queue_timeout);
-      } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
-        std::ostringstream oss_warn;
-        oss_warn << "push to output queue \"" << m_output_queue->get_name() << "\"";
-        ers::warning(
-          dunedaq::iomanager::TimeoutExpired(ERS_HERE, get_name(), oss_warn.str(), m_queue_timeout.count()));
-      }
+bool
+TPChannelFilter::run_task()
+{
+  size_t n_processed = 0;
+  while (n_processed < s_task_batch_size) {
+    std::optional<TPSet> tpset = m_input_queue->try_receive(std::chrono::milliseconds(0));
+    if (!tpset.has_value()) {
+      break;
     }
+    process(*tpset);
+    ++n_processed;
+  }
+  return n_processed > 0;
+}
 
-  } // while(true)
-  TLOG_DEBUG(2) << "Exiting do_work() method";
+void
+TPChannelFilter::process(TPSet& tpset)
+{
+  // Actually do the removal for payload TPSets. Leave heartbeat TPSets unmolested
+
+  if (tpset.type == TPSet::kPayload) {
+    size_t n_before = tpset.objects.size();
+    auto it = std::remove_if(tpset.objects.begin(), tpset.objects.end(), [this](triggeralgs::TriggerPrimitive p) {
+      return channel_should_be_removed(p.channel);
+    });
+    tpset.objects.erase(it, tpset.objects.end());
+    size_t n_after = tpset.objects.size();
+    TLOG_DEBUG(2) << "Removed " << (n_before - n_after) << " TPs out of " << n_before;
+  }
+
+  // The rule is that we don't send empty TPSets, so ensure that
+  if (!tpset.objects.empty()) {
+    try {
+      m_output_queue.send(std::move(tpset), m_queue_timeout);
+    } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
+      std::ostringstream oss_warn;
+      oss_warn << "push to output queue \"" << m_output_queue.get()->get_name() << "\"";
+      ers::warning(
+        dunedaq::iomanager::TimeoutExpired(ERS_HERE, get_name(), oss_warn.str(), m_queue_timeout.count()));
+    }
+  }
+  // Recycle the TPSet if it was filtered to nothing or couldn't be sent
+  SetPool<triggeralgs::TriggerPrimitive>::get().release(std::move(tpset));
 }
 
 } // namespace trigger
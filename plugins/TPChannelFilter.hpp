@@ -10,7 +10,10 @@
 #define TRIGGER_PLUGINS_TPCHANNELFILTER_HPP_
 
 #include "trigger/Issues.hpp"
+#include "trigger/SetPool.hpp"
 #include "trigger/TPSet.hpp"
+#include "trigger/TaskExecutor.hpp"
+#include "trigger/WireFormatSender.hpp"
 #include "trigger/tpchannelfilter/Nljs.hpp"
 
 #include "appfwk/DAQModule.hpp"
@@ -47,14 +50,26 @@ private:
   void do_stop(const nlohmann::json& obj);
   void do_scrap(const nlohmann::json& obj);
   void do_work(std::atomic<bool>&);
+  // The executor's version of do_work(): filter what input is ready, without waiting
+  bool run_task();
+  // Filter a TPSet from the input, and send it on if there's anything left of it
+  void process(TPSet& tpset);
 
   bool channel_should_be_removed(int channel) const;
   dunedaq::utilities::WorkerThread m_thread;
 
+  // How often the idle task polls the input connection, which can't notify it
+  static constexpr std::chrono::milliseconds s_task_poll_interval{ 5 };
+  // The most TPSets the task filters in one run, so that the others on its thread get a turn
+  static constexpr size_t s_task_batch_size = 16;
+
+  // Made the first time it's needed
+  std::shared_ptr<TaskExecutor::Task> m_task;
+  bool m_task_running{ false };
+
   using source_t = dunedaq::iomanager::ReceiverConcept<TPSet>;
   std::shared_ptr<source_t> m_input_queue;
-  using sink_t = dunedaq::iomanager::SenderConcept<TPSet>;
-  std::shared_ptr<sink_t> m_output_queue;
+  WireFormatSender<TPSet> m_output_queue;
   std::chrono::milliseconds m_queue_timeout;
 
   std::shared_ptr<detchannelmaps::TPCChannelMap> m_channel_map;
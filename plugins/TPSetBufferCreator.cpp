@@ -10,6 +10,7 @@
 //#include "CommonIssues.hpp"
 #include "TPSetBufferCreator.hpp"
 #include "trigger/Issues.hpp"
+#include "trigger/TimeWindowKernels.hpp"
 
 #include "appfwk/DAQModuleHelper.hpp"
 #include "appfwk/app/Nljs.hpp"
@@ -139,14 +140,17 @@ TPSetBufferCreator::convert_to_fragment(std::vector<TPSet>& tpsets, dfmessages::
   using detdataformats::trigger::TriggerPrimitive;
 
   std::vector<TriggerPrimitive> tps;
-  
+  auto const window_begin = input_data_request.request_information.window_begin;
+  auto const window_end = input_data_request.request_information.window_end;
+
+  // Count first so that the TPs are copied into the vector only once
+  size_t n_tps = 0;
   for (auto const& tpset : tpsets) {
-    for (auto const& tp : tpset.objects) {
-      if (tp.time_start >= input_data_request.request_information.window_begin &&
-          tp.time_start <= input_data_request.request_information.window_end) {
-        tps.push_back(tp);
-      }
-    }
+    n_tps += count_in_time_window(tpset.objects.data(), tpset.objects.size(), window_begin, window_end);
+  }
+  tps.reserve(n_tps);
+  for (auto const& tpset : tpsets) {
+    select_in_time_window(tpset.objects.data(), tpset.objects.size(), window_begin, window_end, tps);
   }
 
   std::unique_ptr<daqdataformats::Fragment> ret;
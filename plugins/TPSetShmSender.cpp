@@ -0,0 +1,18 @@
+/**
+ * @file TPSetShmSender.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "ShmSetSender.hpp"
+#include "trigger/TPSet.hpp"
+
+namespace dunedaq::trigger {
+
+using TPSetShmSender = ShmSetSender<TPSet>;
+
+} // namespace dunedaq::trigger
+
+DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::TPSetShmSender)
@@ -14,7 +14,10 @@
 #include "iomanager/IOManager.hpp"
 #include "rcif/cmd/Nljs.hpp"
 
+#include <algorithm>
+#include <optional>
 #include <regex>
+#include <sstream>
 #include <string>
 
 namespace dunedaq {
@@ -24,6 +27,7 @@ TimingTriggerCandidateMaker::TimingTriggerCandidateMaker(const std::string& name
   : DAQModule(name)
   , m_output_queue(nullptr)
   , m_queue_timeout(100)
+  , m_sender_thread(std::bind(&TimingTriggerCandidateMaker::send_tcs, this, std::placeholders::_1))
 {
 
   register_command("conf", &TimingTriggerCandidateMaker::do_conf);
@@ -75,6 +79,9 @@ TimingTriggerCandidateMaker::do_conf(const nlohmann::json& config)
   m_hsi_passthrough = params.hsi_trigger_type_passthrough;
   m_hsi_pt_before = params.s0.time_before;
   m_hsi_pt_after = params.s0.time_after;
+  m_tc_queue_size = std::max<size_t>(params.tc_queue_size, 1);
+  m_full_queue_policy = params.full_queue_policy;
+  m_max_send_retries = params.max_send_retries;
   TLOG_DEBUG(2) << get_name() + " configured.";
 }
 
@@ -96,10 +103,22 @@ TimingTriggerCandidateMaker::do_start(const nlohmann::json& startobj)
   m_tc_sent_count.store(0);
   m_tc_sig_type_err_count.store(0);
   m_tc_total_count.store(0);
+  m_tc_dropped_queue_full_count.store(0);
+  m_tc_dropped_send_failed_count.store(0);
+  m_tc_send_retry_count.store(0);
+  {
+    std::lock_guard<std::mutex> lk(m_latency_mutex);
+    m_latency_sum = std::chrono::steady_clock::duration::zero();
+    m_latency_max = std::chrono::steady_clock::duration::zero();
+    m_latency_count = 0;
+  }
+  m_tc_queue.clear();
 
   auto start_params = startobj.get<rcif::cmd::StartParams>();
   m_run_number.store(start_params.run);
 
+  m_sender_thread.start_working_thread("tc-sender");
+
   m_hsievent_receiver = get_iom_receiver<dfmessages::HSIEvent>(m_hsievent_receive_connection);
   m_hsievent_receiver->add_callback(std::bind(&TimingTriggerCandidateMaker::receive_hsievent, this, std::placeholders::_1));
   
@@ -110,15 +129,19 @@ void
 TimingTriggerCandidateMaker::do_stop(const nlohmann::json&)
 {
   m_hsievent_receiver->remove_callback();
+  // The sender thread sends whatever is left in the queue before it exits
+  m_sender_thread.stop_working_thread();
 
   TLOG() << "Received " << m_tsd_received_count << " HSIEvent messages. Successfully sent " << m_tc_sent_count
-         << " TriggerCandidates";
+         << " TriggerCandidates. Dropped " << m_tc_dropped_queue_full_count << " with the queue full and "
+         << m_tc_dropped_send_failed_count << " that failed to send";
   TLOG_DEBUG(2) << get_name() + " successfully stopped.";
 }
 
 void
 TimingTriggerCandidateMaker::receive_hsievent(dfmessages::HSIEvent& data)
 {
+  auto received_time = std::chrono::steady_clock::now();
   TLOG_DEBUG(3) << "Activity received with timestamp " << data.timestamp << ", sequence_counter " << data.sequence_counter
                 << ", and run_number " << data.run_number;
 
@@ -151,21 +174,100 @@ TimingTriggerCandidateMaker::receive_hsievent(dfmessages::HSIEvent& data)
     return;
   }
 
-  bool successfullyWasSent = false;
-  while (!successfullyWasSent) {
+  m_tc_total_count++;
+  enqueue_tc({ std::move(candidate), received_time });
+}
+
+void
+TimingTriggerCandidateMaker::enqueue_tc(PendingTC&& pending)
+{
+  std::optional<PendingTC> dropped;
+  bool accepted = true;
+  {
+    std::unique_lock<std::mutex> lk(m_tc_queue_mutex);
+    if (m_tc_queue.size() >= m_tc_queue_size) {
+      switch (m_full_queue_policy) {
+        case timingtriggercandidatemaker::FullQueuePolicy::kBlock:
+          m_tc_queue_cv.wait(lk, [this]() { return m_tc_queue.size() < m_tc_queue_size; });
+          break;
+        case timingtriggercandidatemaker::FullQueuePolicy::kDropOldest:
+          dropped = std::move(m_tc_queue.front());
+          m_tc_queue.pop_front();
+          break;
+        case timingtriggercandidatemaker::FullQueuePolicy::kDropNewest:
+          dropped = std::move(pending);
+          accepted = false;
+          break;
+      }
+    }
+    if (accepted) {
+      m_tc_queue.push_back(std::move(pending));
+    }
+  }
+  m_tc_queue_cv.notify_all();
+
+  if (dropped) {
+    ++m_tc_dropped_queue_full_count;
+    ers::warning(TCDropped(ERS_HERE, get_name(), dropped->candidate.time_candidate, "the send queue is full"));
+  }
+}
+
+void
+TimingTriggerCandidateMaker::send_tcs(std::atomic<bool>& running_flag)
+{
+  // Keep going until we've been stopped and the queue is empty
+  while (true) {
+    PendingTC pending;
+    {
+      std::unique_lock<std::mutex> lk(m_tc_queue_mutex);
+      if (!m_tc_queue_cv.wait_for(lk, m_queue_timeout, [this]() { return !m_tc_queue.empty(); })) {
+        if (!running_flag.load()) {
+          break;
+        }
+        continue;
+      }
+      pending = std::move(m_tc_queue.front());
+      m_tc_queue.pop_front();
+    }
+    m_tc_queue_cv.notify_all();
+    send_tc(pending, running_flag);
+  }
+}
+
+void
+TimingTriggerCandidateMaker::send_tc(PendingTC& pending, std::atomic<bool>& running_flag)
+{
+  uint32_t n_retries = 0; // NOLINT(build/unsigned)
+  while (true) {
     try {
-        triggeralgs::TriggerCandidate candidate_copy(candidate);
+      // send() may consume its argument even when it times out, so send a copy in case we retry
+      triggeralgs::TriggerCandidate candidate_copy(pending.candidate);
       m_output_queue->send(std::move(candidate_copy), m_queue_timeout);
-      successfullyWasSent = true;
       ++m_tc_sent_count;
+
+      auto latency = std::chrono::steady_clock::now() - pending.received_time;
+      std::lock_guard<std::mutex> lk(m_latency_mutex);
+      m_latency_sum += latency;
+      m_latency_max = std::max(m_latency_max, latency);
+      ++m_latency_count;
+      return;
     } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
       std::ostringstream oss_warn;
       oss_warn << "push to output queue \"" << m_output_queue->get_name() << "\"";
       ers::warning(
         dunedaq::iomanager::TimeoutExpired(ERS_HERE, get_name(), oss_warn.str(), m_queue_timeout.count()));
     }
+
+    // With no retry limit, we retry until the run stops
+    bool retry = m_max_send_retries > 0 ? n_retries < m_max_send_retries : running_flag.load();
+    if (!retry) {
+      ++m_tc_dropped_send_failed_count;
+      ers::warning(TCDropped(ERS_HERE, get_name(), pending.candidate.time_candidate, "sending it timed out"));
+      return;
+    }
+    ++n_retries;
+    ++m_tc_send_retry_count;
   }
-  m_tc_total_count++;
 }
 
 void
@@ -181,6 +283,24 @@ TimingTriggerCandidateMaker::get_info(opmonlib::InfoCollector& ci, int /*level*/
   i.tc_sent_count = m_tc_sent_count.load();
   i.tc_sig_type_err_count = m_tc_sig_type_err_count.load();
   i.tc_total_count = m_tc_total_count.load();
+  i.tc_dropped_queue_full_count = m_tc_dropped_queue_full_count.load();
+  i.tc_dropped_send_failed_count = m_tc_dropped_send_failed_count.load();
+  i.tc_send_retry_count = m_tc_send_retry_count.load();
+  {
+    std::lock_guard<std::mutex> lk(m_tc_queue_mutex);
+    i.tc_queue_depth = m_tc_queue.size();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_latency_mutex);
+    if (m_latency_count > 0) {
+      i.average_latency_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(m_latency_sum).count() / m_latency_count;
+      i.max_latency_us = std::chrono::duration_cast<std::chrono::microseconds>(m_latency_max).count();
+    }
+    m_latency_sum = std::chrono::steady_clock::duration::zero();
+    m_latency_max = std::chrono::steady_clock::duration::zero();
+    m_latency_count = 0;
+  }
 
   ci.add(i);
 }
@@ -22,9 +22,13 @@
 #include "triggeralgs/TriggerCandidate.hpp"
 #include "utilities/WorkerThread.hpp"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -59,12 +63,35 @@ private:
   triggeralgs::TriggerCandidate HSIEventToTriggerCandidate(const dfmessages::HSIEvent& data);
   void receive_hsievent(dfmessages::HSIEvent& data);
 
+  // HSIEvents are converted to TCs on the iomanager callback thread, and
+  // the TCs are queued for sending by a separate thread, so that a slow
+  // output doesn't stall HSIEvent reception
+  struct PendingTC
+  {
+    triggeralgs::TriggerCandidate candidate;
+    std::chrono::steady_clock::time_point received_time;
+  };
+  void enqueue_tc(PendingTC&& pending);
+  void send_tcs(std::atomic<bool>& running_flag);
+  void send_tc(PendingTC& pending, std::atomic<bool>& running_flag);
+
   using sink_t = dunedaq::iomanager::SenderConcept<triggeralgs::TriggerCandidate>;
   std::shared_ptr<sink_t> m_output_queue;
   std::shared_ptr<iomanager::ReceiverConcept<dfmessages::HSIEvent>> m_hsievent_receiver;
 
   std::chrono::milliseconds m_queue_timeout;
 
+  size_t m_tc_queue_size{ 1000 };
+  timingtriggercandidatemaker::FullQueuePolicy m_full_queue_policy{
+    timingtriggercandidatemaker::FullQueuePolicy::kBlock
+  };
+  uint32_t m_max_send_retries{ 0 }; // NOLINT(build/unsigned)
+
+  std::mutex m_tc_queue_mutex;
+  std::condition_variable m_tc_queue_cv;
+  std::deque<PendingTC> m_tc_queue;
+  dunedaq::utilities::WorkerThread m_sender_thread;
+
   // NOLINTNEXTLINE(build/unsigned)
   std::map<uint32_t, std::pair<triggeralgs::timestamp_t, triggeralgs::timestamp_t>> m_detid_offsets_map;
 
@@ -74,6 +101,14 @@ private:
   std::atomic<metric_counter_type> m_tc_sent_count{ 0 };
   std::atomic<metric_counter_type> m_tc_sig_type_err_count{ 0 };
   std::atomic<metric_counter_type> m_tc_total_count{ 0 };
+  std::atomic<metric_counter_type> m_tc_dropped_queue_full_count{ 0 };
+  std::atomic<metric_counter_type> m_tc_dropped_send_failed_count{ 0 };
+  std::atomic<metric_counter_type> m_tc_send_retry_count{ 0 };
+  // Latency from HSIEvent receipt to TC sent, since the last get_info()
+  std::mutex m_latency_mutex;
+  std::chrono::steady_clock::duration m_latency_sum{ 0 };
+  std::chrono::steady_clock::duration m_latency_max{ 0 };
+  metric_counter_type m_latency_count{ 0 };
 
   std::atomic<daqdataformats::run_number_t> m_run_number;
 };
@@ -27,6 +27,36 @@ TriggerActivityMaker::make_maker(const nlohmann::json& obj)
   return maker;
 }
 
+bool
+TriggerActivityMaker::use_local_input(const nlohmann::json& obj) const
+{
+  return obj.get<triggeractivitymaker::Conf>().local_input;
+}
+
+bool
+TriggerActivityMaker::use_executor(const nlohmann::json& obj) const
+{
+  return obj.get<triggeractivitymaker::Conf>().use_executor;
+}
+
+ThreadPlacement
+TriggerActivityMaker::get_thread_placement(const nlohmann::json& obj) const
+{
+  auto params = obj.get<triggeractivitymaker::Conf>();
+  return make_thread_placement(params.cpus, params.numa_node);
+}
+
+TriggerActivityMaker::wire_format_t
+TriggerActivityMaker::get_output_wire_format(const nlohmann::json& obj) const
+{
+  switch (obj.get<triggeractivitymaker::Conf>().output_wire_format) {
+    case triggeractivitymaker::WireFormat::kSharedTPs:
+      return TASetWireFormat::kSharedTPs;
+    default:
+      return TASetWireFormat::kMsgPack;
+  }
+}
+
 } // namespace dunedaq::trigger
 
 DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::TriggerActivityMaker)
@@ -39,6 +39,10 @@ public:
 
 private:
   virtual std::shared_ptr<triggeralgs::TriggerActivityMaker> make_maker(const nlohmann::json& obj);
+  bool use_local_input(const nlohmann::json& obj) const override;
+  bool use_executor(const nlohmann::json& obj) const override;
+  ThreadPlacement get_thread_placement(const nlohmann::json& obj) const override;
+  wire_format_t get_output_wire_format(const nlohmann::json& obj) const override;
 };
 
 } // namespace dunedaq::trigger
@@ -25,6 +25,25 @@ TriggerCandidateMaker::make_maker(const nlohmann::json& obj)
   return maker;
 }
 
+bool
+TriggerCandidateMaker::use_local_input(const nlohmann::json& obj) const
+{
+  return obj.get<triggercandidatemaker::Conf>().local_input;
+}
+
+bool
+TriggerCandidateMaker::use_executor(const nlohmann::json& obj) const
+{
+  return obj.get<triggercandidatemaker::Conf>().use_executor;
+}
+
+ThreadPlacement
+TriggerCandidateMaker::get_thread_placement(const nlohmann::json& obj) const
+{
+  auto params = obj.get<triggercandidatemaker::Conf>();
+  return make_thread_placement(params.cpus, params.numa_node);
+}
+
 } // namespace dunedaq::trigger
 
 DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::TriggerCandidateMaker)
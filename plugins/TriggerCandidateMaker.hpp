@@ -38,6 +38,9 @@ public:
 
 private:
   virtual std::shared_ptr<triggeralgs::TriggerCandidateMaker> make_maker(const nlohmann::json& obj);
+  bool use_local_input(const nlohmann::json& obj) const override;
+  bool use_executor(const nlohmann::json& obj) const override;
+  ThreadPlacement get_thread_placement(const nlohmann::json& obj) const override;
 };
 
 } // namespace dunedaq::trigger
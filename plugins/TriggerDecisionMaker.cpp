@@ -25,6 +25,12 @@ TriggerDecisionMaker::make_maker(const nlohmann::json& obj)
   return maker;
 }
 
+bool
+TriggerDecisionMaker::use_executor(const nlohmann::json& obj) const
+{
+  return obj.get<triggerdecisionmaker::Conf>().use_executor;
+}
+
 } // namespace dunedaq::trigger
 
 DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::TriggerDecisionMaker)
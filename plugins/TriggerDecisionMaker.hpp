@@ -37,6 +37,7 @@ public:
 
 private:
   virtual std::shared_ptr<triggeralgs::TriggerDecisionMaker> make_maker(const nlohmann::json& obj);
+  bool use_executor(const nlohmann::json& obj) const override;
 };
 
 } // namespace dunedaq::trigger
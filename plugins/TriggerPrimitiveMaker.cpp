@@ -9,6 +9,7 @@
 #include "TriggerPrimitiveMaker.hpp"
 
 #include "trigger/Issues.hpp" // For TLVL_*
+#include "trigger/TPTextReader.hpp"
 
 #include "appfwk/DAQModuleHelper.hpp"
 #include "appfwk/cmd/Nljs.hpp"
@@ -17,12 +18,19 @@
 #include "rcif/cmd/Nljs.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <fstream>
+#include <exception>
+#include <functional>
+#include <iterator>
 #include <limits>
+#include <map>
 #include <memory>
+#include <queue>
+#include <set>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 using namespace triggeralgs;
@@ -51,6 +59,8 @@ void
 TriggerPrimitiveMaker::do_configure(const nlohmann::json& obj)
 {
   m_conf = obj.get<triggerprimitivemaker::ConfParams>();
+  m_speed_profile = make_speed_profile();
+  m_placement = make_thread_placement(m_conf.cpus, m_conf.numa_node, m_conf.huge_pages);
 
   // For each of the streams that are specified in the config, we read
   // the input file, and create an outgoing sink. We also keep track
@@ -61,16 +71,113 @@ TriggerPrimitiveMaker::do_configure(const nlohmann::json& obj)
   m_earliest_first_tpset_timestamp = std::numeric_limits<triggeralgs::timestamp_t>::max();
   m_latest_last_tpset_timestamp = 0;
 
-  for (auto& stream : m_conf.tp_streams) {
-    TPStream this_stream;
-    this_stream.tpset_sink = get_iom_sender<TPSet>(appfwk::connection_uid(m_init_obj, stream.output_sink_name));
+  auto const n_streams = m_conf.tp_streams.size();
+  std::vector<TPStream> streams(n_streams);
+  for (size_t i = 0; i < n_streams; ++i) {
+    auto const& stream_conf = m_conf.tp_streams[i];
+    TPSetWireFormat wire_format = TPSetWireFormat::kMsgPack;
+    switch (stream_conf.wire_format) {
+      case triggerprimitivemaker::WireFormat::kFlat:
+        wire_format = TPSetWireFormat::kFlat;
+        break;
+      case triggerprimitivemaker::WireFormat::kCompact:
+        wire_format = TPSetWireFormat::kCompact;
+        break;
+      default:
+        break;
+    }
+    streams[i].tpset_sink = WireFormatSender<TPSet>(
+      get_iom_sender<TPSet>(appfwk::connection_uid(m_init_obj, stream_conf.output_sink_name)), wire_format);
+    streams[i].element_id = stream_conf.element_id;
+    streams[i].channel_offset = stream_conf.channel_offset;
+  }
 
-    this_stream.tpsets = read_tpsets(stream.filename, stream.element_id);
+  // Streams often replay the same file under different element IDs,
+  // so each text or binary file is loaded once and shared, read-only,
+  // between all of the streams that use it. The origin and channel
+  // offset are applied per stream as the TPSets are sent. HDF5 readers
+  // keep their position in the file, so each stream gets its own
+  std::vector<size_t> loaded_by(n_streams);
+  std::vector<size_t> loads;
+  std::map<std::pair<std::string, triggerprimitivemaker::FileFormat>, size_t> first_stream_for_file;
+  for (size_t i = 0; i < n_streams; ++i) {
+    auto const& stream_conf = m_conf.tp_streams[i];
+    if (stream_conf.file_format != triggerprimitivemaker::FileFormat::kHDF5) {
+      auto [it, inserted] =
+        first_stream_for_file.emplace(std::make_pair(stream_conf.filename, stream_conf.file_format), i);
+      loaded_by[i] = it->second;
+      if (!inserted) {
+        continue;
+      }
+    } else {
+      loaded_by[i] = i;
+    }
+    loads.push_back(i);
+  }
 
-    m_earliest_first_tpset_timestamp =
-      std::min(m_earliest_first_tpset_timestamp, this_stream.tpsets.front().start_time);
+  // Reading the input files is the slow part of conf, and the files
+  // are independent, so load them concurrently. Any exception is
+  // rethrown here once all of the loader threads are done
+  auto const n_loads = loads.size();
+  auto const n_loaders = std::min<size_t>(n_loads, std::max(1u, std::thread::hardware_concurrency()));
+  std::atomic<size_t> next_load{ 0 };
+  std::vector<std::exception_ptr> errors(n_loads);
+  auto loader = [&]() {
+    for (size_t j = next_load++; j < n_loads; j = next_load++) {
+      size_t i = loads[j];
+      auto const& stream_conf = m_conf.tp_streams[i];
+      try {
+        if (stream_conf.file_format == triggerprimitivemaker::FileFormat::kBinary) {
+          streams[i].replay_file = open_replay_file(stream_conf.filename);
+        } else if (stream_conf.file_format == triggerprimitivemaker::FileFormat::kHDF5) {
+          streams[i].hdf5_reader = open_hdf5_reader(stream_conf);
+        } else {
+          streams[i].tpsets = std::make_shared<const std::vector<TPSet>>(read_tpsets(stream_conf.filename));
+        }
+      } catch (...) {
+        errors[j] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> loaders;
+  for (size_t i = 0; i < n_loaders; ++i) {
+    loaders.emplace_back(loader);
+  }
+  for (auto& thr : loaders) {
+    thr.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  for (size_t i = 0; i < n_streams; ++i) {
+    if (loaded_by[i] != i) {
+      streams[i].tpsets = streams[loaded_by[i]].tpsets;
+      streams[i].replay_file = streams[loaded_by[i]].replay_file;
+    }
+  }
+  TLOG() << "Loaded " << n_loads << " inputs for " << n_streams << " streams";
+
+  for (size_t i = 0; i < n_streams; ++i) {
+    auto& this_stream = streams[i];
+    triggeralgs::timestamp_t first_start_time, last_start_time;
+    if (this_stream.hdf5_reader) {
+      first_start_time = this_stream.hdf5_reader->get_first_start_time();
+      last_start_time = this_stream.hdf5_reader->get_last_start_time();
+    } else if (this_stream.replay_file) {
+      first_start_time = this_stream.replay_file->get_set(0).start_time;
+      last_start_time = this_stream.replay_file->get_set(this_stream.replay_file->get_n_sets() - 1).start_time;
+    } else {
+      if (this_stream.tpsets->empty()) {
+        throw BadTPInputFile(ERS_HERE, get_name(), m_conf.tp_streams[i].filename);
+      }
+      first_start_time = this_stream.tpsets->front().start_time;
+      last_start_time = this_stream.tpsets->back().start_time;
+    }
 
-    m_latest_last_tpset_timestamp = std::max(m_latest_last_tpset_timestamp, this_stream.tpsets.back().start_time);
+    m_earliest_first_tpset_timestamp = std::min(m_earliest_first_tpset_timestamp, first_start_time);
+    m_latest_last_tpset_timestamp = std::max(m_latest_last_tpset_timestamp, last_start_time);
 
     m_tp_streams.push_back(std::move(this_stream));
   }
@@ -85,6 +192,11 @@ TriggerPrimitiveMaker::do_start(const nlohmann::json& args)
   m_run_number = start_params.run;
 
   m_running_flag.store(true);
+  for (auto& stream : m_tp_streams) {
+    if (stream.hdf5_reader) {
+      stream.hdf5_reader->restart();
+    }
+  }
 
   // We need the wall-clock time at which we'll send out the TPSet
   // with the earliest timestamp, so we can keep all of the output
@@ -92,13 +204,26 @@ TriggerPrimitiveMaker::do_start(const nlohmann::json& args)
   // of the threads to start up
   auto earliest_timestamp_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
 
-  for (auto& stream : m_tp_streams) {
-    m_threads.push_back(std::make_unique<std::thread>(&TriggerPrimitiveMaker::do_work,
-                                                      this,
-                                                      std::ref(m_running_flag),
-                                                      std::ref(stream.tpsets),
-                                                      std::ref(stream.tpset_sink),
-                                                      earliest_timestamp_time));
+  if (m_conf.n_scheduler_threads == 0) {
+    for (auto& stream : m_tp_streams) {
+      m_threads.push_back(std::make_unique<std::thread>(
+        &TriggerPrimitiveMaker::do_work, this, std::ref(m_running_flag), std::ref(stream), earliest_timestamp_time));
+    }
+  } else {
+    // Deal the streams out to the scheduler threads
+    size_t n_schedulers = std::min<size_t>(m_conf.n_scheduler_threads, m_tp_streams.size());
+    std::vector<std::vector<TPStream*>> scheduler_streams(n_schedulers);
+    for (size_t i = 0; i < m_tp_streams.size(); ++i) {
+      scheduler_streams[i % n_schedulers].push_back(&m_tp_streams[i]);
+    }
+    for (size_t i = 0; i < n_schedulers; ++i) {
+      m_threads.push_back(std::make_unique<std::thread>(&TriggerPrimitiveMaker::do_schedule,
+                                                        this,
+                                                        std::ref(m_running_flag),
+                                                        scheduler_streams[i],
+                                                        earliest_timestamp_time,
+                                                        i));
+    }
   }
   for (int i=0; i < m_threads.size(); ++i) {
     std::string name("replay");
@@ -113,6 +238,12 @@ TriggerPrimitiveMaker::do_stop(const nlohmann::json& /*args*/)
 {
   TLOG(TLVL_ENTER_EXIT_METHODS) << get_name() << ": Entering do_stop() method";
   m_running_flag.store(false);
+  // Wake any thread waiting for a TPSet to be read, and stop reading ahead
+  for (auto& stream : m_tp_streams) {
+    if (stream.hdf5_reader) {
+      stream.hdf5_reader->stop();
+    }
+  }
   for (auto& thr : m_threads) {
     if (thr != nullptr && thr->joinable()) {
       thr->join();
@@ -131,10 +262,12 @@ TriggerPrimitiveMaker::do_scrap(const nlohmann::json& /*args*/)
 }
 
 std::vector<TPSet>
-TriggerPrimitiveMaker::read_tpsets(std::string filename, int element)
+TriggerPrimitiveMaker::read_tpsets(std::string filename)
 {
-  std::ifstream file(filename);
-  if (!file || file.bad()) {
+  auto load_start = std::chrono::steady_clock::now();
+
+  TPTextReader reader(filename);
+  if (!reader.is_open()) {
     throw BadTPInputFile(ERS_HERE, get_name(), filename);
   }
 
@@ -145,15 +278,16 @@ TriggerPrimitiveMaker::read_tpsets(std::string filename, int element)
   uint64_t prev_tpset_number = 0; // NOLINT(build/unsigned)
   uint32_t seqno = 0;             // NOLINT(build/unsigned)
   uint64_t old_time_start = 0;    // NOLINT(build/unsigned)
+  size_t n_tps = 0;
 
   // Read in the file and place the TPs in TPSets. TPSets have time
   // boundaries ( n*tpset_time_width + tpset_time_offset ), and TPs are placed
   // in TPSets based on the TP start time
   //
   // This loop assumes the input file is sorted by TP start time
-  while (file >> tp.time_start >> tp.time_over_threshold >> tp.time_peak >> tp.channel >> tp.adc_integral >>
-         tp.adc_peak >> tp.detid >> tp.type) {
+  while (reader.next(tp)) {
     if (tp.time_start >= old_time_start) {
+      ++n_tps;
       // NOLINTNEXTLINE(build/unsigned)
       uint64_t current_tpset_number = (tp.time_start + m_conf.tpset_time_offset) / m_conf.tpset_time_width;
       old_time_start = tp.time_start;
@@ -165,9 +299,6 @@ TriggerPrimitiveMaker::read_tpsets(std::string filename, int element)
         tpset.seqno = seqno;
         ++seqno;
 
-        // 12-Jul-2021, KAB: setting origin fields from configuration
-        tpset.origin.id = element;
-
         tpset.type = TPSet::Type::kPayload;
 
         if (!tpset.objects.empty()) {
@@ -187,114 +318,458 @@ TriggerPrimitiveMaker::read_tpsets(std::string filename, int element)
     // We don't send empty TPSets, so there's no point creating them
     tpsets.push_back(tpset);
   }
-  TLOG_DEBUG(0) << "Read " << seqno << " TPs into " << tpsets.size() << " TPSets, from file " << filename;
+  auto time_ms =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - load_start).count();
+  float tp_rate_hz = time_ms > 0 ? 1e3 * static_cast<float>(n_tps) / time_ms : 0;
+  TLOG() << "Read " << n_tps << " TPs into " << tpsets.size() << " TPSets, from file " << filename << " ("
+         << reader.get_bytes_read() << " bytes) in " << time_ms << " ms (" << tp_rate_hz << " TPs/s)";
   return tpsets;
 }
 
-void
-TriggerPrimitiveMaker::do_work(std::atomic<bool>& running_flag,
-                               std::vector<TPSet>& tpsets,
-                               std::shared_ptr<iomanager::SenderConcept<TPSet>>& tpset_sink,
-                               std::chrono::steady_clock::time_point earliest_timestamp_time)
+std::shared_ptr<TPReplayFile>
+TriggerPrimitiveMaker::open_replay_file(std::string filename)
 {
-  TLOG(TLVL_ENTER_EXIT_METHODS) << get_name() << ": Entering do_work() method";
-  uint64_t current_iteration = 0; // NOLINT(build/unsigned)
-  size_t generated_count = 0;
-  size_t push_failed_count = 0;
-  size_t generated_tp_count = 0;
+  auto start = std::chrono::steady_clock::now();
+  std::shared_ptr<TPReplayFile> replay_file;
+  try {
+    replay_file = std::make_shared<TPReplayFile>(filename);
+    replay_file->index_sets(m_conf.tpset_time_width, m_conf.tpset_time_offset);
+  } catch (const BadTPReplayFile& e) {
+    throw BadTPInputFile(ERS_HERE, get_name(), filename, e);
+  }
+  if (replay_file->get_n_sets() == 0) {
+    throw BadTPInputFile(ERS_HERE, get_name(), filename);
+  }
+  if (m_placement.huge_pages) {
+    try {
+      replay_file->load_into_memory(m_placement.numa_node);
+    } catch (const BadTPReplayFile& e) {
+      throw BadTPInputFile(ERS_HERE, get_name(), filename, e);
+    }
+  }
+  auto time_ms =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  TLOG() << "Opened " << replay_file->get_n_tps() << " TPs in " << replay_file->get_n_sets()
+         << " TPSets from binary file " << filename << ", " << replay_file->describe_memory() << ", in " << time_ms
+         << " ms";
+  return replay_file;
+}
 
-  uint64_t prev_tpset_start_time = 0; // NOLINT(build/unsigned)
-  auto prev_tpset_send_time = std::chrono::steady_clock::now();
+bool
+TriggerPrimitiveMaker::next_tpset(TPStream& stream, size_t& index, uint64_t loop_offset, TPSet& tpset) const
+{
+  if (stream.hdf5_reader) {
+    // Sets streamed from HDF5 are handed over to us, so they can be shifted in place
+    if (!stream.hdf5_reader->next(tpset)) {
+      return false;
+    }
+    tpset.start_time += loop_offset;
+    for (auto& tp : tpset.objects) {
+      tp.time_start += loop_offset;
+      tp.time_peak += loop_offset;
+      tp.channel += stream.channel_offset;
+    }
+  } else {
+    if (index >= stream.n_tpsets()) {
+      return false;
+    }
+    // The stored TPs are never modified, and may be shared with other
+    // streams, so each loop over the input shifts the timestamps by the
+    // loop offset, and the channels by this stream's offset, as they are
+    // copied into the outgoing set: one pass over the TPs per send
+    const TriggerPrimitive* tps_begin;
+    size_t n_tps;
+    if (stream.replay_file) {
+      auto const& file_set = stream.replay_file->get_set(index);
+      tps_begin = stream.replay_file->get_tps(file_set);
+      n_tps = file_set.n_tps;
+      tpset.start_time = file_set.start_time + loop_offset;
+    } else {
+      auto const& stored_set = (*stream.tpsets)[index];
+      tps_begin = stored_set.objects.data();
+      n_tps = stored_set.objects.size();
+      tpset.start_time = stored_set.start_time + loop_offset;
+    }
+    // The previous set's vector went with it when it was sent, so take one
+    // back from the pool that the consumers of our TPSets recycle into.
+    // Acquire before giving back what we have, if anything, so that the
+    // pool can't just hand the same too-small vector straight back
+    if (tpset.objects.capacity() < n_tps) {
+      std::vector<TriggerPrimitive> too_small(std::move(tpset.objects));
+      tpset.objects = SetPool<TriggerPrimitive>::get().acquire(n_tps).objects;
+      SetPool<TriggerPrimitive>::get().release(std::move(too_small));
+    }
+    tpset.objects.clear();
+    std::transform(tps_begin,
+                   tps_begin + n_tps,
+                   std::back_inserter(tpset.objects),
+                   [loop_offset, channel_offset = stream.channel_offset](TriggerPrimitive tp) {
+                     tp.time_start += loop_offset;
+                     tp.time_peak += loop_offset;
+                     tp.channel += channel_offset;
+                     return tp;
+                   });
+  }
+  ++index;
+  tpset.end_time = tpset.start_time + m_conf.tpset_time_width;
+  tpset.type = TPSet::Type::kPayload;
+  tpset.origin.id = stream.element_id;
+  return true;
+}
 
-  auto const total_stream_duration = m_latest_last_tpset_timestamp - m_earliest_first_tpset_timestamp;
+std::shared_ptr<HDF5TPReader>
+TriggerPrimitiveMaker::open_hdf5_reader(const triggerprimitivemaker::TPStream& stream_conf)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::shared_ptr<HDF5TPReader> reader;
+  try {
+    reader = std::make_shared<HDF5TPReader>(stream_conf.filename,
+                                            std::set<uint32_t>(stream_conf.source_ids.begin(), // NOLINT(build/unsigned)
+                                                               stream_conf.source_ids.end()),
+                                            m_conf.tpset_time_width,
+                                            m_conf.tpset_time_offset,
+                                            m_conf.hdf5_read_ahead_records);
+  } catch (const BadTPReplayFile& e) {
+    throw BadTPInputFile(ERS_HERE, get_name(), stream_conf.filename, e);
+  }
+  auto time_ms =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  TLOG() << "Opened HDF5 file " << stream_conf.filename << " with " << reader->get_n_records()
+         << " records for streaming, in " << time_ms << " ms";
+  return reader;
+}
 
-  auto run_start_time = std::chrono::steady_clock::now();
+SpeedProfile
+TriggerPrimitiveMaker::make_speed_profile() const
+{
+  auto check_factor = [this](double factor) {
+    if (!(factor > 0)) {
+      throw InvalidSpeedProfile(ERS_HERE, get_name(), "speed factor " + std::to_string(factor) + " is not positive");
+    }
+  };
+  auto to_duration = [](double seconds) {
+    return std::chrono::duration_cast<SpeedProfile::duration>(std::chrono::duration<double>(seconds));
+  };
+
+  switch (m_conf.speed_profile) {
+    case triggerprimitivemaker::SpeedProfileType::kConstant:
+      check_factor(m_conf.speed_factor);
+      return SpeedProfile(m_conf.speed_factor);
+    case triggerprimitivemaker::SpeedProfileType::kLinearRamp:
+      check_factor(m_conf.speed_factor);
+      check_factor(m_conf.ramp_end_speed_factor);
+      return SpeedProfile::linear_ramp(
+        m_conf.speed_factor, m_conf.ramp_end_speed_factor, to_duration(m_conf.ramp_duration_s), m_conf.ramp_steps);
+    case triggerprimitivemaker::SpeedProfileType::kSteps: {
+      if (m_conf.speed_steps.empty()) {
+        throw InvalidSpeedProfile(ERS_HERE, get_name(), "kSteps profile has no steps");
+      }
+      std::vector<SpeedProfile::Step> steps;
+      for (auto const& step : m_conf.speed_steps) {
+        check_factor(step.speed_factor);
+        steps.push_back({ step.speed_factor, step.speed_factor, to_duration(step.duration_s) });
+      }
+      return SpeedProfile(std::move(steps));
+    }
+  }
+  return SpeedProfile();
+}
 
-  uint32_t seqno = 0; // NOLINT(build/unsigned)
+TriggerPrimitiveMaker::StreamReplay::StreamReplay(TPStream& stream_,
+                                                  std::chrono::steady_clock::time_point earliest_timestamp_time_)
+  : stream(stream_)
+  , earliest_timestamp_time(earliest_timestamp_time_)
+  , prev_tpset_send_time(std::chrono::steady_clock::now())
+  , run_start_time(prev_tpset_send_time)
+  , step_start_time(prev_tpset_send_time)
+{}
+
+bool
+TriggerPrimitiveMaker::load_next_tpset(StreamReplay& replay)
+{
+  auto const total_stream_duration = m_latest_last_tpset_timestamp - m_earliest_first_tpset_timestamp;
+
+  while (true) {
+    if (!replay.in_iteration) {
+      if (m_conf.number_of_loops > 0 && replay.current_iteration >= m_conf.number_of_loops) {
+        return false;
+      }
+      // Don't start reading the input again once we've been stopped
+      if (!m_running_flag.load()) {
+        return false;
+      }
+      if (replay.stream.hdf5_reader) {
+        replay.stream.hdf5_reader->rewind();
+      }
+      replay.index = 0;
+      replay.in_iteration = true;
+    }
+    if (next_tpset(replay.stream, replay.index, replay.current_iteration * total_stream_duration, replay.tpset)) {
+      break;
+    }
+    replay.in_iteration = false;
+    ++replay.current_iteration;
+    if (replay.index == 0) {
+      // Nothing at all in this pass over the input, so there won't be in the next one either
+      return false;
+    }
+  }
+  replay.tpset.run_number = m_run_number;
 
   auto const clocks_per_us = m_conf.clock_frequency_hz / 1'000'000;
+  auto const tpset_start_time = replay.tpset.start_time;
 
-  while (running_flag.load()) {
-    if (m_conf.number_of_loops > 0 && current_iteration >= m_conf.number_of_loops) {
-      break;
+  // `earliest_timestamp_time` is the wall-clock time of the earliest
+  // first tpset timestamp in _any_ of the input streams. So for the
+  // first TPSet we send out, we wait until _this_ stream's first
+  // timestamp comes up.
+  //
+  // The speed factor is evaluated at the previous send time, so a
+  // varying profile is followed piecewise, one TPSet at a time.
+  //
+  // In unpaced mode we don't wait for this time, but it's still used
+  // to order the streams handled by one scheduler thread
+  double wait_time_us;
+  std::chrono::steady_clock::time_point base_time;
+  if (replay.prev_tpset_start_time == 0) {
+    wait_time_us = static_cast<double>(tpset_start_time - m_earliest_first_tpset_timestamp) / clocks_per_us /
+                   m_speed_profile.get_speed_factor(SpeedProfile::duration::zero());
+    base_time = replay.earliest_timestamp_time;
+  } else {
+    wait_time_us =
+      static_cast<double>(tpset_start_time - replay.prev_tpset_start_time) / clocks_per_us /
+      m_speed_profile.get_speed_factor(replay.prev_tpset_send_time - replay.earliest_timestamp_time);
+    base_time = replay.prev_tpset_send_time;
+  }
+  replay.scheduled_send_time = base_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                             std::chrono::duration<double, std::micro>(wait_time_us));
+  replay.prev_tpset_send_time = replay.scheduled_send_time;
+  replay.prev_tpset_start_time = tpset_start_time;
+  return true;
+}
+
+bool
+TriggerPrimitiveMaker::sleep_until(std::atomic<bool>& running_flag, std::chrono::steady_clock::time_point time) const
+{
+  // check running_flag periodically so we can stop punctually
+  auto const slice_period = std::chrono::microseconds(m_conf.maximum_wait_time_us);
+  while (true) {
+    if (!running_flag.load()) {
+      TLOG() << "while waiting to send next TP, negative running flag detected.";
+      return false;
     }
+    auto now = std::chrono::steady_clock::now();
+    if (time - now <= slice_period) {
+      std::this_thread::sleep_until(time);
+      return true;
+    }
+    std::this_thread::sleep_until(now + slice_period);
+  }
+}
 
-    for (auto& tpset : tpsets) {
+void
+TriggerPrimitiveMaker::emit_tpset(StreamReplay& replay)
+{
+  auto& stream = replay.stream;
 
-      if (!running_flag.load()) {
-        break;
-      }
+  if (!m_conf.unpaced) {
+    auto lateness = std::chrono::steady_clock::now() - replay.scheduled_send_time;
+    replay.total_lateness += lateness;
+    replay.max_lateness = std::max(replay.max_lateness, lateness);
+  }
 
-      // The argument `earliest_timestamp_time` is the wall-clock time
-      // of the earliest first tpset timestamp in _any_ of the input
-      // streams. So for the first TPSet we send out, we wait until
-      // _this_ stream's first timestamp comes up
-      auto wait_time_us = 0;
-      std::chrono::steady_clock::time_point next_tpset_send_time;
-      if (prev_tpset_start_time == 0) {
-        wait_time_us = (tpset.start_time - m_earliest_first_tpset_timestamp) / clocks_per_us;
-        next_tpset_send_time = earliest_timestamp_time + std::chrono::microseconds(wait_time_us);
+  auto timed_send = [&](TPSet&& set) {
+    auto send_start = std::chrono::steady_clock::now();
+    bool sent = true;
+    try {
+      stream.tpset_sink.send(std::move(set), m_queue_timeout);
+    } catch (const dunedaq::iomanager::TimeoutExpired& e) {
+      ers::warning(e);
+      sent = false;
+    }
+    replay.send_time += std::chrono::steady_clock::now() - send_start;
+    return sent;
+  };
+
+  // Heartbeats are sent from the same loop as the payloads, so
+  // they're correctly ordered with respect to them whether or not
+  // we're pacing the output: a heartbeat always precedes the first
+  // payload TPSet at or after its time
+  if (m_conf.heartbeat_interval > 0) {
+    triggeralgs::timestamp_t heartbeat_time =
+      (replay.tpset.start_time / m_conf.heartbeat_interval) * m_conf.heartbeat_interval;
+    if (heartbeat_time > replay.last_heartbeat_time) {
+      TPSet heartbeat;
+      heartbeat.type = TPSet::Type::kHeartbeat;
+      heartbeat.start_time = heartbeat_time;
+      heartbeat.end_time = heartbeat_time;
+      heartbeat.origin.id = stream.element_id;
+      heartbeat.run_number = m_run_number;
+      heartbeat.seqno = replay.seqno;
+      ++replay.seqno;
+      if (timed_send(std::move(heartbeat))) {
+        ++replay.generated_heartbeat_count;
       } else {
-        wait_time_us = (tpset.start_time - prev_tpset_start_time) / clocks_per_us;
-        next_tpset_send_time = prev_tpset_send_time + std::chrono::microseconds(wait_time_us);
+        ++replay.push_failed_count;
       }
+      replay.last_heartbeat_time = heartbeat_time;
+    }
+  }
 
-      // check running_flag periodically so we can stop punctually
-      auto slice_period = std::chrono::microseconds(m_conf.maximum_wait_time_us);
-      auto next_slice_send_time = prev_tpset_send_time + slice_period;
-      bool break_flag = false;
-      while (next_tpset_send_time > next_slice_send_time + slice_period) {
-        if (!running_flag.load()) {
-          TLOG() << "while waiting to send next TP, negative running flag detected.";
-          break_flag = true;
-          break;
-        }
-        std::this_thread::sleep_until(next_slice_send_time);
-        next_slice_send_time = next_slice_send_time + slice_period;
-      }
-      if (!break_flag) {
-        std::this_thread::sleep_until(next_tpset_send_time);
-      }
-      prev_tpset_send_time = next_tpset_send_time;
-      prev_tpset_start_time = tpset.start_time;
-
-      ++generated_count;
-      generated_tp_count += tpset.objects.size();
-      try {
-        TPSet tpset_copy(tpset);
-        tpset_sink->send(std::move(tpset_copy), m_queue_timeout);
-      } catch (const dunedaq::iomanager::TimeoutExpired& e) {
-        ers::warning(e);
-        ++push_failed_count;
-      }
+  replay.tpset.seqno = replay.seqno;
+  ++replay.seqno;
+  ++replay.generated_count;
+  replay.generated_tp_count += replay.tpset.objects.size();
+  if (!timed_send(std::move(replay.tpset))) {
+    ++replay.push_failed_count;
+  }
 
-      tpset.run_number = m_run_number;
-      // Increase seqno and the timestamps in the TPSet and TPs so they don't
-      // repeat when we do multiple loops over the file
-      tpset.start_time += total_stream_duration;
-      tpset.end_time += total_stream_duration;
-      for (auto& tp : tpset.objects) {
-        tp.time_start += total_stream_duration;
-        tp.time_peak += total_stream_duration;
-      }
-      tpset.seqno = seqno;
-      ++seqno;
+  // Statistics for each step of the speed profile are logged when the
+  // step ends, so a single run can sweep through a range of rates
+  if (m_speed_profile.get_n_steps() > 1) {
+    auto now = std::chrono::steady_clock::now();
+    size_t current_step = m_speed_profile.get_step_index(now - replay.earliest_timestamp_time);
+    if (current_step != replay.step_index) {
+      log_speed_step(replay, now);
+      replay.step_index = current_step;
+      replay.step_start_time = now;
+      replay.step_start_count = replay.generated_count;
+      replay.step_start_tp_count = replay.generated_tp_count;
+      replay.step_start_failed_count = replay.push_failed_count;
+      replay.step_start_send_time = replay.send_time;
+    }
+  }
+}
 
-    } // end loop over tpsets
-    ++current_iteration;
+void
+TriggerPrimitiveMaker::log_speed_step(const StreamReplay& replay, std::chrono::steady_clock::time_point now) const
+{
+  auto const& step = m_speed_profile.get_step(replay.step_index);
+  auto step_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - replay.step_start_time).count();
+  auto step_send_ms =
+    std::chrono::duration_cast<std::chrono::milliseconds>(replay.send_time - replay.step_start_send_time).count();
+  size_t step_count = replay.generated_count - replay.step_start_count;
+  size_t step_tp_count = replay.generated_tp_count - replay.step_start_tp_count;
+  float step_rate_hz = step_ms > 0 ? 1e3 * static_cast<float>(step_count) / step_ms : 0;
+  float step_tp_rate_hz = step_ms > 0 ? 1e3 * static_cast<float>(step_tp_count) / step_ms : 0;
+  TLOG() << "Stream " << replay.stream.element_id << " speed step " << replay.step_index << " (speed factor "
+         << step.start_factor << " to " << step.end_factor << "): " << step_count << " TP sets (" << step_tp_count
+         << " TPs) in " << step_ms << " ms. (" << step_rate_hz << " TPSets/s, " << step_tp_rate_hz << " TPs/s). "
+         << replay.push_failed_count - replay.step_start_failed_count << " failed to push. " << step_send_ms
+         << " ms spent blocked in send";
+}
 
-  } // end while(running_flag.load())
+void
+TriggerPrimitiveMaker::finish_replay(StreamReplay& replay)
+{
+  auto& stream = replay.stream;
 
   auto run_end_time = std::chrono::steady_clock::now();
-  auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(run_end_time - run_start_time).count();
-  float rate_hz = 1e3 * static_cast<float>(generated_count) / time_ms;
+  if (m_speed_profile.get_n_steps() > 1) {
+    log_speed_step(replay, run_end_time);
+  }
+  auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(run_end_time - replay.run_start_time).count();
+  auto send_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(replay.send_time).count();
+  float rate_hz = time_ms > 0 ? 1e3 * static_cast<float>(replay.generated_count) / time_ms : 0;
+  float tp_rate_hz = time_ms > 0 ? 1e3 * static_cast<float>(replay.generated_tp_count) / time_ms : 0;
+  float send_fraction = time_ms > 0 ? 100. * send_time_ms / time_ms : 0;
+
+  TLOG() << "Stream " << stream.element_id << ": generated " << replay.generated_count << " TP sets ("
+         << replay.generated_tp_count << " TPs) and " << replay.generated_heartbeat_count << " heartbeats in "
+         << time_ms << " ms. (" << rate_hz << " TPSets/s, " << tp_rate_hz << " TPs/s). " << replay.push_failed_count
+         << " failed to push. " << send_time_ms << " ms (" << send_fraction << "%) spent blocked in send";
+  if (!m_conf.unpaced && replay.generated_count > 0) {
+    auto mean_lateness_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(replay.total_lateness).count() / replay.generated_count;
+    TLOG() << "Stream " << stream.element_id << ": sends were on average " << mean_lateness_us
+           << " us later than scheduled, and at most "
+           << std::chrono::duration_cast<std::chrono::microseconds>(replay.max_lateness).count() << " us";
+  }
+  if (stream.hdf5_reader && stream.hdf5_reader->get_n_dropped() > 0) {
+    TLOG() << stream.hdf5_reader->get_n_dropped() << " TPs from " << stream.hdf5_reader->get_filename()
+           << " were too far out of order to be placed in a TPSet, and were dropped";
+  }
+}
 
-  TLOG() << "Generated " << generated_count << " TP sets (" << generated_tp_count << " TPs) in " << time_ms << " ms. ("
-         << rate_hz << " TPSets/s). " << push_failed_count << " failed to push";
+void
+TriggerPrimitiveMaker::do_work(std::atomic<bool>& running_flag,
+                               TPStream& stream,
+                               std::chrono::steady_clock::time_point earliest_timestamp_time)
+{
+  TLOG(TLVL_ENTER_EXIT_METHODS) << get_name() << ": Entering do_work() method";
+  apply_thread_placement(m_placement, get_name() + " replay thread for element " + std::to_string(stream.element_id));
+
+  StreamReplay replay(stream, earliest_timestamp_time);
+  while (running_flag.load() && load_next_tpset(replay)) {
+    if (!m_conf.unpaced && !sleep_until(running_flag, replay.scheduled_send_time)) {
+      break;
+    }
+    emit_tpset(replay);
+  }
+  finish_replay(replay);
 
   TLOG(TLVL_ENTER_EXIT_METHODS) << get_name() << ": Exiting do_work() method";
 }
 
+void
+TriggerPrimitiveMaker::do_schedule(std::atomic<bool>& running_flag,
+                                   std::vector<TPStream*> streams,
+                                   std::chrono::steady_clock::time_point earliest_timestamp_time,
+                                   size_t scheduler_index)
+{
+  TLOG(TLVL_ENTER_EXIT_METHODS) << get_name() << ": Entering do_schedule() method";
+  apply_thread_placement(m_placement, get_name() + " scheduler thread " + std::to_string(scheduler_index));
+
+  // One event per stream, for its next TPSet, ordered by send time. We
+  // always send the earliest, then load that stream's next TPSet and
+  // put it back in the queue
+  using event_t = std::pair<std::chrono::steady_clock::time_point, size_t>;
+  std::priority_queue<event_t, std::vector<event_t>, std::greater<event_t>> events;
+
+  std::vector<std::unique_ptr<StreamReplay>> replays;
+  for (size_t i = 0; i < streams.size(); ++i) {
+    replays.push_back(std::make_unique<StreamReplay>(*streams[i], earliest_timestamp_time));
+    if (load_next_tpset(*replays[i])) {
+      events.emplace(replays[i]->scheduled_send_time, i);
+    }
+  }
+
+  size_t n_sends = 0;
+  std::chrono::steady_clock::duration total_lateness{ 0 };
+  std::chrono::steady_clock::duration max_lateness{ 0 };
+
+  while (running_flag.load() && !events.empty()) {
+    auto [send_time, i] = events.top();
+    events.pop();
+    if (!m_conf.unpaced) {
+      if (!sleep_until(running_flag, send_time)) {
+        break;
+      }
+      auto lateness = std::chrono::steady_clock::now() - send_time;
+      total_lateness += lateness;
+      max_lateness = std::max(max_lateness, lateness);
+    }
+    emit_tpset(*replays[i]);
+    ++n_sends;
+    if (load_next_tpset(*replays[i])) {
+      events.emplace(replays[i]->scheduled_send_time, i);
+    }
+  }
+
+  for (auto& replay : replays) {
+    finish_replay(*replay);
+  }
+  if (!m_conf.unpaced && n_sends > 0) {
+    TLOG() << "Scheduler " << scheduler_index << " sent " << n_sends << " TPSets for " << streams.size()
+           << " streams, on average "
+           << std::chrono::duration_cast<std::chrono::microseconds>(total_lateness).count() / n_sends
+           << " us later than scheduled, and at most "
+           << std::chrono::duration_cast<std::chrono::microseconds>(max_lateness).count() << " us";
+  }
+
+  TLOG(TLVL_ENTER_EXIT_METHODS) << get_name() << ": Exiting do_schedule() method";
+}
+
 } // namespace dunedaq::trigger
 
 DEFINE_DUNE_DAQ_MODULE(dunedaq::trigger::TriggerPrimitiveMaker)
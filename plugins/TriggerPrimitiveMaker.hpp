@@ -9,7 +9,13 @@
 #ifndef TRIGGER_PLUGINS_TRIGGERPRIMITIVEMAKER_HPP_
 #define TRIGGER_PLUGINS_TRIGGERPRIMITIVEMAKER_HPP_
 
+#include "trigger/HDF5TPReader.hpp"
+#include "trigger/SetPool.hpp"
+#include "trigger/SpeedProfile.hpp"
+#include "trigger/TPReplayFile.hpp"
 #include "trigger/TPSet.hpp"
+#include "trigger/ThreadPlacement.hpp"
+#include "trigger/WireFormatSender.hpp"
 #include "trigger/triggerprimitivemaker/Nljs.hpp"
 
 #include "appfwk/DAQModule.hpp"
@@ -18,6 +24,8 @@
 #include "triggeralgs/Types.hpp"
 #include "utilities/WorkerThread.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -48,18 +56,45 @@ private:
   void do_stop(const nlohmann::json& obj);
   void do_scrap(const nlohmann::json& obj);
 
-  // Threading
-  void do_work(std::atomic<bool>&,
-               std::vector<TPSet>& tpsets,
-               std::shared_ptr<iomanager::SenderConcept<TPSet>>& tpset_sink,
-               std::chrono::steady_clock::time_point earliest_timestamp_time);
+  struct TPStream;
+  struct StreamReplay;
+
+  // Threading. Either one thread per stream, running do_work(), or a
+  // few threads each running do_schedule() for a group of streams
+  void do_work(std::atomic<bool>&, TPStream& stream, std::chrono::steady_clock::time_point earliest_timestamp_time);
+  void do_schedule(std::atomic<bool>&,
+                   std::vector<TPStream*> streams,
+                   std::chrono::steady_clock::time_point earliest_timestamp_time,
+                   size_t scheduler_index);
   std::vector<std::unique_ptr<std::thread>> m_threads;
   std::atomic<bool> m_running_flag;
 
-  std::vector<TPSet> read_tpsets(std::string filename, int element);
+  // Load the next TPSet of the replay, looping over the input as
+  // configured, and work out when it should be sent, at the speed given
+  // by m_speed_profile. Returns false when the replay is finished
+  bool load_next_tpset(StreamReplay& replay);
+  // Send the loaded TPSet, preceded by a heartbeat if one is due
+  void emit_tpset(StreamReplay& replay);
+  // Log the statistics of the current step of the speed profile
+  void log_speed_step(const StreamReplay& replay, std::chrono::steady_clock::time_point now) const;
+  // Log the statistics of the replay at the end of the run
+  void finish_replay(StreamReplay& replay);
+  // Sleep until `time`, checking running_flag periodically. Returns false if we were stopped
+  bool sleep_until(std::atomic<bool>& running_flag, std::chrono::steady_clock::time_point time) const;
+
+  // Fill tpset with the index'th TPSet of stream, shifted in time by
+  // loop_offset, and advance index. Returns false at the end of the stream
+  bool next_tpset(TPStream& stream, size_t& index, uint64_t loop_offset, TPSet& tpset) const; // NOLINT
+
+  SpeedProfile make_speed_profile() const;
+
+  std::vector<TPSet> read_tpsets(std::string filename);
+  std::shared_ptr<TPReplayFile> open_replay_file(std::string filename);
+  std::shared_ptr<HDF5TPReader> open_hdf5_reader(const triggerprimitivemaker::TPStream& stream_conf);
 
   // Configuration
   triggerprimitivemaker::ConfParams m_conf;
+  ThreadPlacement m_placement;
 
   daqdataformats::run_number_t m_run_number{ daqdataformats::TypeDefaults::s_invalid_run_number };
 
@@ -67,14 +102,74 @@ private:
 
   struct TPStream
   {
-    std::shared_ptr<iomanager::SenderConcept<TPSet>> tpset_sink;
-    std::vector<TPSet> tpsets;
+    // Serializes in the stream's configured wire format if the output is a network connection
+    WireFormatSender<TPSet> tpset_sink;
+    uint32_t element_id{ 0 }; // NOLINT(build/unsigned)
+    int32_t channel_offset{ 0 };
+
+    // Streams that replay the same text or binary file share its contents.
+    // Text input is read into memory at conf...
+    std::shared_ptr<const std::vector<TPSet>> tpsets;
+    // ...while binary input is memory-mapped, and TPSets are sliced from the mapping as they are sent
+    std::shared_ptr<TPReplayFile> replay_file;
+    // ...and HDF5 input is streamed, a few records at a time, for each loop over the file
+    std::shared_ptr<HDF5TPReader> hdf5_reader;
+
+    // The number of TPSets in text or binary input
+    size_t n_tpsets() const { return replay_file ? replay_file->get_n_sets() : (tpsets ? tpsets->size() : 0); }
   };
 
   std::vector<TPStream> m_tp_streams;
 
+  // The state of the replay of one stream during a run
+  struct StreamReplay
+  {
+    StreamReplay(TPStream& stream_, std::chrono::steady_clock::time_point earliest_timestamp_time_);
+
+    TPStream& stream;
+    std::chrono::steady_clock::time_point earliest_timestamp_time;
+
+    // Position in the input
+    uint64_t current_iteration{ 0 }; // NOLINT(build/unsigned)
+    size_t index{ 0 };
+    bool in_iteration{ false };
+
+    // The next TPSet to send, and when to send it. The outgoing TPSet
+    // is reused for every send. Senders that don't take ownership of
+    // the TPs (eg network senders, which serialize) leave the vector's
+    // capacity in place for the next set
+    TPSet tpset;
+    std::chrono::steady_clock::time_point scheduled_send_time;
+
+    triggeralgs::timestamp_t prev_tpset_start_time{ 0 };
+    std::chrono::steady_clock::time_point prev_tpset_send_time;
+    uint32_t seqno{ 0 }; // NOLINT(build/unsigned)
+    triggeralgs::timestamp_t last_heartbeat_time{ 0 };
+
+    std::chrono::steady_clock::time_point run_start_time;
+    size_t generated_count{ 0 };
+    size_t generated_tp_count{ 0 };
+    size_t generated_heartbeat_count{ 0 };
+    size_t push_failed_count{ 0 };
+    // Time spent blocked in send(), ie, back-pressure from downstream
+    std::chrono::steady_clock::duration send_time{ 0 };
+    // How late the paced sends were, compared to their scheduled times
+    std::chrono::steady_clock::duration total_lateness{ 0 };
+    std::chrono::steady_clock::duration max_lateness{ 0 };
+
+    // Totals at the start of the current step of the speed profile
+    size_t step_index{ 0 };
+    std::chrono::steady_clock::time_point step_start_time;
+    size_t step_start_count{ 0 };
+    size_t step_start_tp_count{ 0 };
+    size_t step_start_failed_count{ 0 };
+    std::chrono::steady_clock::duration step_start_send_time{ 0 };
+  };
+
   std::chrono::milliseconds m_queue_timeout;
 
+  SpeedProfile m_speed_profile;
+
   // Variables to keep track of the total time span of multiple TP streams
   triggeralgs::timestamp_t m_earliest_first_tpset_timestamp;
   triggeralgs::timestamp_t m_latest_last_tpset_timestamp;
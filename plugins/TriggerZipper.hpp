@@ -12,6 +12,10 @@
 #include "zipper.hpp"
 
 #include "trigger/Issues.hpp"
+#include "trigger/SetPool.hpp"
+#include "trigger/SetRing.hpp"
+#include "trigger/TaskExecutor.hpp"
+#include "trigger/ThreadPlacement.hpp"
 #include "trigger/triggerzipper/Nljs.hpp"
 
 #include "appfwk/DAQModule.hpp"
@@ -29,6 +33,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 const char* inqs_name = "inputs";
@@ -74,15 +79,37 @@ public:
   std::shared_ptr<source_t> m_inq{};
   std::shared_ptr<sink_t> m_outq{};
 
+  // Used instead of the queues when the modules at both ends are in this process
+  std::string m_input_name;
+  std::string m_output_name;
+  std::shared_ptr<SetRing<TSET>> m_input_ring;
+  std::shared_ptr<SetRing<TSET>> m_output_ring;
+
   using cfg_t = triggerzipper::ConfParams;
   cfg_t m_cfg;
+  ThreadPlacement m_placement;
 
   std::thread m_thread;
   std::atomic<bool> m_running{ false };
 
+  // How long the zipper thread waits for input before draining what's
+  // due. A task is polled this often while idle, for the same reason
+  static constexpr std::chrono::milliseconds s_receive_timeout{ 10 };
+  // The most inputs a task processes in one run, so that the others on its thread get a turn
+  static constexpr size_t s_task_batch_size = 16;
+
+  // Made the first time it's needed, and kept, since a ring may still notify it after a stop
+  std::shared_ptr<TaskExecutor::Task> m_task;
+  bool m_task_running{ false };
+
   // We store input TSETs in a list and send iterator though the
   // zipper as payload so as to not suffer copy overhead.
   cache_type m_cache;
+  // List nodes that have been sent out, spliced back into m_cache when
+  // the next TSET arrives so that we don't allocate a node per TSET
+  cache_type m_spare;
+  // Reused by drain()
+  std::vector<node_type> m_got;
   seqno_type m_next_seqno{ 0 };
 
   size_t m_n_received{ 0 };
@@ -102,6 +129,8 @@ public:
     // clang-format on
   }
 
+  ~TriggerZipper() { detach_input_ring(); }
+
   void init(const nlohmann::json& ini)
   {
     set_input(appfwk::connection_uid(ini, "input"));
@@ -109,24 +138,48 @@ public:
   }
   void set_input(const std::string& name)
   {
+    m_input_name = name;
     m_inq = get_iom_receiver<TSET>(name);
   }
   void set_output(const std::string& name)
   {
+    m_output_name = name;
     m_outq = get_iom_sender<TSET>(name);
   }
 
   void do_configure(const nlohmann::json& cfgobj)
   {
     m_cfg = cfgobj.get<cfg_t>();
+    m_placement = make_thread_placement(m_cfg.cpus, m_cfg.numa_node);
     m_zm.set_max_latency(std::chrono::milliseconds(m_cfg.max_latency_ms));
     m_zm.set_cardinality(m_cfg.cardinality);
+
+    // Attach our ring now, so that producers find it when they start
+    if (m_cfg.local_input) {
+      m_input_ring = SetRingRegistry<TSET>::attach_consumer(m_input_name);
+      TLOG() << get_name() << ": Receiving from " << m_input_name << " through a local ring";
+    } else {
+      detach_input_ring();
+    }
   }
 
   void do_scrap(const nlohmann::json& /*stopobj*/)
   {
     m_cfg = cfg_t{};
     m_zm.set_cardinality(0);
+    detach_input_ring();
+  }
+
+  // Stop our ring from being found by producers that start from now on,
+  // and from notifying our task
+  void detach_input_ring()
+  {
+    if (!m_input_ring) {
+      return;
+    }
+    m_input_ring->set_consumer_task(nullptr);
+    SetRingRegistry<TSET>::detach_consumer(m_input_name);
+    m_input_ring.reset();
   }
 
   void do_start(const nlohmann::json& /*startobj*/)
@@ -135,18 +188,51 @@ public:
     m_n_sent = 0;
     m_n_tardy = 0;
     m_tardy_counts.clear();
-    m_running.store(true);
-    m_thread = std::thread(&TriggerZipper::worker, this);
-    pthread_setname_np(m_thread.native_handle(), "zipper");
+    m_output_ring = SetRingRegistry<TSET>::find(m_output_name);
+    if (m_output_ring) {
+      TLOG() << get_name() << ": Sending to " << m_output_name << " through a local ring";
+    }
+    if (!m_cfg.use_executor) {
+      if (m_input_ring) {
+        m_input_ring->set_consumer_task(nullptr);
+      }
+      m_running.store(true);
+      m_thread = std::thread(&TriggerZipper::worker, this);
+      pthread_setname_np(m_thread.native_handle(), "zipper");
+      return;
+    }
+    if (!m_placement.is_default()) {
+      TLOG() << get_name() << ": Ignoring the thread placement, since the executor's threads are shared";
+    }
+    auto& executor = TaskExecutor::get();
+    if (!m_task) {
+      m_task = executor.make_task(get_name(), [this] { return run_task(); }, s_receive_timeout);
+    }
+    if (m_input_ring) {
+      m_input_ring->set_consumer_task(m_task.get());
+    }
+    executor.start_task(*m_task);
+    m_task_running = true;
+    TLOG() << get_name() << ": Running as a task on the shared executor, which has " << executor.n_threads()
+           << " threads";
   }
 
   void do_stop(const nlohmann::json& /*stopobj*/)
   {
-    m_running.store(false);
-    m_thread.join();
+    if (m_task_running) {
+      // As worker() does, read what's left of the input
+      TaskExecutor::get().stop_task(*m_task);
+      m_task_running = false;
+      while (proc_one(std::chrono::milliseconds(0))) {
+      }
+    } else {
+      m_running.store(false);
+      m_thread.join();
+    }
     flush();
     m_zm.clear();
     TLOG() << "Received " << m_n_received << " Sets. Sent " << m_n_sent << " Sets. " << m_n_tardy << " were tardy";
+    TLOG() << "Set pool: " << SetPool<typename TSET::element_t>::get().get_stats();
     std::stringstream ss;
     ss << std::endl;
     for (auto& [id, n] : m_tardy_counts) {
@@ -158,29 +244,57 @@ public:
   // thread worker
   void worker()
   {
+    // First, so that what this thread allocates, such as cache entries, comes from our NUMA node
+    apply_thread_placement(m_placement, get_name() + " zipper thread");
     while (true) {
       // Once we've received a stop command, keep reading the input
       // queue until there's nothing left on it
-      if (!proc_one() && !m_running.load()) {
+      if (!proc_one(s_receive_timeout) && !m_running.load()) {
         break;
       }
     }
   }
 
-  bool proc_one()
+  // The executor's version of worker(): process what input is ready,
+  // without waiting. When there's none, proc_one() still drains what's
+  // due, so polling the idle task keeps max_latency_ms working. Returns
+  // true to run again straight away if there was any input
+  bool run_task()
   {
-    m_cache.emplace_front(); // to be filled
-    auto& tset = m_cache.front();
-    std::optional<TSET> opt_tset= m_inq->try_receive(std::chrono::milliseconds(10));
-    if (opt_tset.has_value()) {
-      tset = *opt_tset;
-      ++m_n_received;
+    size_t n_processed = 0;
+    while (n_processed < s_task_batch_size && proc_one(std::chrono::milliseconds(0))) {
+      ++n_processed;
+    }
+    return n_processed > 0;
+  }
+
+  bool receive(TSET& tset, std::chrono::milliseconds timeout)
+  {
+    if (m_input_ring) {
+      return timeout.count() == 0 ? m_input_ring->try_pop(tset) : m_input_ring->pop(tset, timeout);
+    }
+    std::optional<TSET> opt_tset = m_inq->try_receive(timeout);
+    if (!opt_tset.has_value()) {
+      return false;
     }
-    else {
-      m_cache.pop_front(); // vestigial
+    tset = std::move(*opt_tset);
+    return true;
+  }
+
+  bool proc_one(std::chrono::milliseconds timeout)
+  {
+    if (m_spare.empty()) {
+      m_cache.emplace_front(); // to be filled
+    } else {
+      m_cache.splice(m_cache.begin(), m_spare, m_spare.begin());
+    }
+    auto& tset = m_cache.front();
+    if (!receive(tset, timeout)) {
+      m_spare.splice(m_spare.begin(), m_cache, m_cache.begin());
       drain();
       return false;
     }
+    ++m_n_received;
 
     if (!m_tardy_counts.count(tset.origin))
       m_tardy_counts[tset.origin] = 0;
@@ -217,7 +331,9 @@ public:
 
       ers::warning(TardyInputSet(
                                  ERS_HERE, get_name(), tset.origin.id, tset.start_time, m_zm.get_origin() >> 1));
-      m_cache.pop_front(); // vestigial
+      // the tardy set is dropped here, so recycle it
+      SetPool<typename TSET::element_t>::get().release(std::move(tset));
+      m_spare.splice(m_spare.begin(), m_cache, m_cache.begin());
     }
     drain();
     return true;
@@ -235,27 +351,34 @@ public:
       ++m_next_seqno;
 
       try {
-        m_outq->send(std::move(tset), std::chrono::milliseconds(10));
+        if (m_output_ring) {
+          if (!m_output_ring->push(std::move(tset), std::chrono::milliseconds(10))) {
+            throw iomanager::TimeoutExpired(ERS_HERE, get_name(), "push to local ring \"" + m_output_name + "\"", 10);
+          }
+        } else {
+          m_outq->send(std::move(tset), std::chrono::milliseconds(10));
+        }
         ++m_n_sent;
       } catch (const iomanager::TimeoutExpired& err) {
         // our output queue is stuffed.  should more be done
         // here than simply complain and drop?
         ers::error(err);
+        SetPool<typename TSET::element_t>::get().release(std::move(tset));
       }
-      m_cache.erase(lit);
+      m_spare.splice(m_spare.begin(), m_cache, lit);
     }
   }
 
   // Maybe drain and send to out queue
   void drain()
   {
-    std::vector<node_type> got;
+    m_got.clear();
     if (m_cfg.max_latency_ms) {
-      m_zm.drain_prompt(std::back_inserter(got));
+      m_zm.drain_prompt(std::back_inserter(m_got));
     } else {
-      m_zm.drain_waiting(std::back_inserter(got));
+      m_zm.drain_waiting(std::back_inserter(m_got));
     }
-    send_out(got);
+    send_out(m_got);
   }
 
   // Fully drain and send to out queue
@@ -0,0 +1,208 @@
+/**
+ * @file HDF5TPReader.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/HDF5TPReader.hpp"
+
+#include "trigger/Issues.hpp"
+
+#include "daqdataformats/Fragment.hpp"
+#include "daqdataformats/SourceID.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace dunedaq::trigger {
+
+namespace {
+// Serializes access to the HDF5 library from all readers
+std::mutex&
+hdf5_mutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+} // namespace
+
+HDF5TPReader::HDF5TPReader(const std::string& filename,
+                           std::set<uint32_t> source_ids, // NOLINT(build/unsigned)
+                           uint64_t tpset_time_width,     // NOLINT(build/unsigned)
+                           uint64_t tpset_time_offset,    // NOLINT(build/unsigned)
+                           size_t max_buffered_records)
+  : m_filename(filename)
+  , m_source_ids(std::move(source_ids))
+  , m_max_buffered_records(std::max<size_t>(max_buffered_records, 1))
+  , m_accumulator(tpset_time_width, tpset_time_offset)
+{
+  {
+    std::lock_guard<std::mutex> lk(hdf5_mutex());
+    try {
+      m_file = std::make_unique<hdf5libs::HDF5RawDataFile>(filename);
+      auto record_ids = m_file->get_all_record_ids();
+      m_record_ids.assign(record_ids.begin(), record_ids.end());
+    } catch (const ers::Issue& e) {
+      throw BadTPReplayFile(ERS_HERE, filename, "could not read as an HDF5 raw data file", e);
+    }
+  }
+
+  // Find the time range of the file from the first and last records
+  // that have any TPs, so we don't have to read the whole file here
+  uint64_t width = tpset_time_width > 0 ? tpset_time_width : 1; // NOLINT(build/unsigned)
+  auto set_start_time = [&](triggeralgs::timestamp_t t) {
+    return ((t + tpset_time_offset) / width) * width + tpset_time_offset;
+  };
+  std::vector<TriggerPrimitive> tps;
+  size_t first_record = 0;
+  for (; first_record < m_record_ids.size() && tps.empty(); ++first_record) {
+    read_record(first_record, tps);
+  }
+  if (tps.empty()) {
+    throw BadTPReplayFile(ERS_HERE, filename, "no TPs from the requested source IDs");
+  }
+  auto by_start = [](const TriggerPrimitive& a, const TriggerPrimitive& b) { return a.time_start < b.time_start; };
+  m_first_start_time = set_start_time(std::min_element(tps.begin(), tps.end(), by_start)->time_start);
+
+  tps.clear();
+  for (size_t i = m_record_ids.size(); i >= first_record && tps.empty(); --i) {
+    read_record(i - 1, tps);
+  }
+  m_last_start_time = set_start_time(std::max_element(tps.begin(), tps.end(), by_start)->time_start);
+}
+
+HDF5TPReader::~HDF5TPReader()
+{
+  stop();
+}
+
+void
+HDF5TPReader::rewind()
+{
+  // stop() may be called from another thread while we're here, so the
+  // reader thread is only ever joined and replaced with m_thread_mutex held
+  std::lock_guard<std::mutex> thread_lk(m_thread_mutex);
+  {
+    std::lock_guard<std::mutex> lk(m_buffer_mutex);
+    if (m_stop) {
+      return;
+    }
+    m_rewinding = true;
+  }
+  m_buffer_cv.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  std::lock_guard<std::mutex> lk(m_buffer_mutex);
+  m_buffer.clear();
+  m_front_index = 0;
+  m_done = false;
+  m_rewinding = false;
+  m_accumulator.reset();
+  m_thread = std::thread(&HDF5TPReader::reader_thread, this);
+  pthread_setname_np(m_thread.native_handle(), "hdf5tpreader");
+}
+
+void
+HDF5TPReader::restart()
+{
+  std::lock_guard<std::mutex> lk(m_buffer_mutex);
+  m_stop = false;
+}
+
+bool
+HDF5TPReader::next(TPSet& tpset)
+{
+  std::unique_lock<std::mutex> lk(m_buffer_mutex);
+  m_buffer_cv.wait(lk, [this]() { return !m_buffer.empty() || m_done || m_stop; });
+  if (m_stop || m_buffer.empty()) {
+    return false;
+  }
+  auto& front = m_buffer.front();
+  tpset = std::move(front[m_front_index]);
+  ++m_front_index;
+  if (m_front_index == front.size()) {
+    m_buffer.pop_front();
+    m_front_index = 0;
+    m_buffer_cv.notify_all();
+  }
+  return true;
+}
+
+void
+HDF5TPReader::read_record(size_t index, std::vector<TriggerPrimitive>& tps)
+{
+  std::lock_guard<std::mutex> lk(hdf5_mutex());
+  auto frag_paths =
+    m_file->get_fragment_dataset_paths(m_record_ids[index], daqdataformats::SourceID::Subsystem::kTrigger);
+  for (auto const& frag_path : frag_paths) {
+    auto frag = m_file->get_frag_ptr(frag_path);
+    if (frag->get_fragment_type() != daqdataformats::FragmentType::kTriggerPrimitive) {
+      continue;
+    }
+    if (!m_source_ids.empty() && m_source_ids.count(frag->get_element_id().id) == 0) {
+      continue;
+    }
+    size_t n_tps = (frag->get_size() - sizeof(daqdataformats::FragmentHeader)) / sizeof(TriggerPrimitive);
+    const TriggerPrimitive* prim = reinterpret_cast<const TriggerPrimitive*>(frag->get_data());
+    tps.insert(tps.end(), prim, prim + n_tps);
+  }
+}
+
+void
+HDF5TPReader::reader_thread()
+{
+  std::vector<TriggerPrimitive> tps;
+  try {
+    for (size_t i = 0; i < m_record_ids.size(); ++i) {
+      tps.clear();
+      read_record(i, tps);
+      m_accumulator.add(tps.data(), tps.size());
+
+      std::vector<TPSet> sets;
+      if (i == m_record_ids.size() - 1) {
+        m_accumulator.flush(sets);
+      } else {
+        m_accumulator.emit_complete(sets);
+      }
+      if (sets.empty()) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lk(m_buffer_mutex);
+      m_buffer_cv.wait(lk, [this]() { return m_buffer.size() < m_max_buffered_records || m_stop || m_rewinding; });
+      if (m_stop || m_rewinding) {
+        return;
+      }
+      m_buffer.push_back(std::move(sets));
+      m_buffer_cv.notify_all();
+    }
+  } catch (const ers::Issue& e) {
+    ers::error(BadTPReplayFile(ERS_HERE, m_filename, "error while reading records", e));
+  }
+
+  std::lock_guard<std::mutex> lk(m_buffer_mutex);
+  m_n_dropped = m_accumulator.get_n_dropped();
+  m_done = true;
+  m_buffer_cv.notify_all();
+}
+
+void
+HDF5TPReader::stop()
+{
+  std::lock_guard<std::mutex> thread_lk(m_thread_mutex);
+  {
+    std::lock_guard<std::mutex> lk(m_buffer_mutex);
+    m_stop = true;
+  }
+  m_buffer_cv.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+} // namespace dunedaq::trigger
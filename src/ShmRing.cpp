@@ -0,0 +1,345 @@
+/**
+ * @file ShmRing.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/ShmRing.hpp"
+
+#include "trigger/Issues.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace dunedaq::trigger {
+
+/**
+ * The start of the shared memory. Each side's position, waiting flag and
+ * pid are on their own cache line, which only that side writes, apart
+ * from a new process taking over the role from a dead one. The
+ * positions count committed slots, and wrap around, which is why there
+ * are a power of two slots
+ */
+struct ShmRing::Header
+{
+  static constexpr uint32_t s_magic = 0x52534d53; // NOLINT(build/unsigned) "SMSR" in little-endian
+  static constexpr uint32_t s_version = 1;        // NOLINT(build/unsigned)
+
+  uint32_t magic{ s_magic };                  // NOLINT(build/unsigned)
+  uint32_t version{ s_version };              // NOLINT(build/unsigned)
+  uint64_t n_slots{ 0 };                      // NOLINT(build/unsigned)
+  uint64_t slot_size{ 0 };                    // NOLINT(build/unsigned)
+  std::atomic<uint32_t> initialized{ 0 };     // NOLINT(build/unsigned)
+
+  alignas(64) std::atomic<uint32_t> write_pos{ 0 };      // NOLINT(build/unsigned)
+  std::atomic<uint32_t> writer_waiting{ 0 };             // NOLINT(build/unsigned)
+  std::atomic<int32_t> writer_pid{ 0 };
+
+  alignas(64) std::atomic<uint32_t> read_pos{ 0 };       // NOLINT(build/unsigned)
+  std::atomic<uint32_t> reader_waiting{ 0 };             // NOLINT(build/unsigned)
+  std::atomic<int32_t> reader_pid{ 0 };
+};
+
+namespace {
+
+// The futexes are the positions themselves, so they must be plain 32-bit words
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t)); // NOLINT(build/unsigned)
+static_assert(std::atomic<uint32_t>::is_always_lock_free);        // NOLINT(build/unsigned)
+static_assert(std::atomic<int32_t>::is_always_lock_free);
+
+// Each slot holds the size of its object, then the object
+constexpr size_t s_slot_prefix = sizeof(uint64_t); // NOLINT(build/unsigned)
+constexpr size_t s_cache_line = 64;
+constexpr size_t s_max_slots = size_t(1) << 30;
+// How many times a side yields before it goes to sleep
+constexpr int s_n_spins = 64;
+// How long to wait for the process that made the ring to finish setting it up
+constexpr auto s_init_timeout = std::chrono::seconds(1);
+
+std::string
+shm_name(const std::string& name)
+{
+  return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+std::string
+errno_string(const std::string& what)
+{
+  return what + ": " + std::strerror(errno);
+}
+
+bool
+process_is_alive(int32_t pid)
+{
+  return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+long // NOLINT(runtime/int)
+futex(std::atomic<uint32_t>* addr, int op, uint32_t val, const timespec* timeout) // NOLINT(build/unsigned)
+{
+  // Not FUTEX_PRIVATE_FLAG: the waiter and the waker are in different processes
+  return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), op, val, timeout, nullptr, 0); // NOLINT
+}
+
+} // namespace
+
+ShmRing::ShmRing(const std::string& name, Role role, size_t n_slots, size_t slot_size)
+  : m_name(shm_name(name))
+  , m_role(role)
+  , m_n_slots(2)
+  , m_slot_size(slot_size)
+{
+  if (slot_size == 0 || n_slots > s_max_slots) {
+    throw ShmRingError(ERS_HERE, m_name, "bad geometry of " + std::to_string(n_slots) + " slots of " +
+                                           std::to_string(slot_size) + " bytes");
+  }
+  while (m_n_slots < n_slots) {
+    m_n_slots <<= 1;
+  }
+  m_slot_stride = (s_slot_prefix + m_slot_size + s_cache_line - 1) / s_cache_line * s_cache_line;
+  m_map_size = sizeof(Header) + m_n_slots * m_slot_stride;
+
+  bool created = true;
+  int fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+  if (fd < 0 && errno == EEXIST) {
+    created = false;
+    fd = shm_open(m_name.c_str(), O_RDWR, 0);
+  }
+  if (fd < 0) {
+    throw ShmRingError(ERS_HERE, m_name, errno_string("shm_open failed"));
+  }
+
+  if (created) {
+    if (ftruncate(fd, static_cast<off_t>(m_map_size)) != 0) {
+      auto reason = errno_string("ftruncate failed");
+      close(fd);
+      shm_unlink(m_name.c_str());
+      throw ShmRingError(ERS_HERE, m_name, reason);
+    }
+  } else {
+    // The process that made the ring may still be setting it up
+    auto deadline = std::chrono::steady_clock::now() + s_init_timeout;
+    struct stat st;
+    while (true) {
+      if (fstat(fd, &st) != 0) {
+        auto reason = errno_string("fstat failed");
+        close(fd);
+        throw ShmRingError(ERS_HERE, m_name, reason);
+      }
+      if (static_cast<size_t>(st.st_size) >= sizeof(Header) || std::chrono::steady_clock::now() >= deadline) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (static_cast<size_t>(st.st_size) != m_map_size) {
+      close(fd);
+      throw ShmRingError(ERS_HERE, m_name, "existing ring is " + std::to_string(st.st_size) + " bytes, not the " +
+                                             std::to_string(m_map_size) + " of this geometry");
+    }
+  }
+
+  m_map = mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  auto mmap_errno = errno;
+  close(fd);
+  if (m_map == MAP_FAILED) {
+    errno = mmap_errno;
+    throw ShmRingError(ERS_HERE, m_name, errno_string("mmap failed"));
+  }
+  m_slots = static_cast<uint8_t*>(m_map) + sizeof(Header); // NOLINT(build/unsigned)
+
+  if (created) {
+    m_header = new (m_map) Header();
+    m_header->n_slots = m_n_slots;
+    m_header->slot_size = m_slot_size;
+    m_header->initialized.store(1, std::memory_order_release);
+  } else {
+    m_header = static_cast<Header*>(m_map);
+    auto deadline = std::chrono::steady_clock::now() + s_init_timeout;
+    while (m_header->initialized.load(std::memory_order_acquire) == 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::string problem;
+    if (m_header->initialized.load(std::memory_order_acquire) == 0) {
+      problem = "it was never set up, so the process making it probably died. Remove it and try again";
+    } else if (m_header->magic != Header::s_magic || m_header->version != Header::s_version) {
+      problem = "it isn't a ring of this version";
+    } else if (m_header->n_slots != m_n_slots || m_header->slot_size != m_slot_size) {
+      problem = "it has " + std::to_string(m_header->n_slots) + " slots of " + std::to_string(m_header->slot_size) +
+                " bytes, not " + std::to_string(m_n_slots) + " of " + std::to_string(m_slot_size);
+    }
+    if (!problem.empty()) {
+      munmap(m_map, m_map_size);
+      throw ShmRingError(ERS_HERE, m_name, "can't attach to existing ring: " + problem);
+    }
+  }
+
+  // Take the role, unless another process that's still alive has it
+  auto& pid = m_role == Role::kWriter ? m_header->writer_pid : m_header->reader_pid;
+  auto& waiting = m_role == Role::kWriter ? m_header->writer_waiting : m_header->reader_waiting;
+  int32_t self = getpid();
+  int32_t owner = pid.load();
+  bool taken = false;
+  while (owner == 0 || (owner != self && !process_is_alive(owner))) {
+    if (pid.compare_exchange_weak(owner, self)) {
+      taken = true;
+      break;
+    }
+  }
+  if (!taken) {
+    // Including by another ShmRing in this process, whose destructor would give the role up from under us
+    munmap(m_map, m_map_size);
+    throw ShmRingError(ERS_HERE, m_name,
+                       std::string(m_role == Role::kWriter ? "writer" : "reader") + " role is held by " +
+                         (owner == self ? std::string("another ShmRing in this process")
+                                        : "process " + std::to_string(owner)));
+  }
+  // A process we took over from may have died asleep
+  waiting.store(0);
+}
+
+ShmRing::~ShmRing()
+{
+  auto& pid = m_role == Role::kWriter ? m_header->writer_pid : m_header->reader_pid;
+  int32_t self = getpid();
+  pid.compare_exchange_strong(self, 0);
+  munmap(m_map, m_map_size);
+}
+
+size_t
+ShmRing::size() const
+{
+  uint32_t read_pos = m_header->read_pos.load(std::memory_order_acquire); // NOLINT(build/unsigned)
+  return m_header->write_pos.load(std::memory_order_acquire) - read_pos;
+}
+
+uint8_t* // NOLINT(build/unsigned)
+ShmRing::slot(uint32_t pos) const // NOLINT(build/unsigned)
+{
+  return m_slots + (pos & (m_n_slots - 1)) * m_slot_stride;
+}
+
+uint8_t* // NOLINT(build/unsigned)
+ShmRing::begin_write(duration_t timeout)
+{
+  // Only we change the write position
+  uint32_t write_pos = m_header->write_pos.load(std::memory_order_relaxed); // NOLINT(build/unsigned)
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    uint32_t read_pos = m_header->read_pos.load(std::memory_order_acquire); // NOLINT(build/unsigned)
+    if (write_pos - read_pos < m_n_slots) {
+      return slot(write_pos) + s_slot_prefix;
+    }
+    if (!wait_while(m_header->read_pos, read_pos, m_header->writer_waiting, deadline)) {
+      return nullptr;
+    }
+  }
+}
+
+void
+ShmRing::commit_write(size_t size)
+{
+  if (size > m_slot_size) {
+    throw ShmRingError(ERS_HERE, m_name, "committed " + std::to_string(size) + " bytes to a slot of " +
+                                           std::to_string(m_slot_size));
+  }
+  uint32_t write_pos = m_header->write_pos.load(std::memory_order_relaxed); // NOLINT(build/unsigned)
+  uint64_t slot_size = size;                                                 // NOLINT(build/unsigned)
+  std::memcpy(slot(write_pos), &slot_size, sizeof(slot_size));
+  m_header->write_pos.store(write_pos + 1, std::memory_order_release);
+  wake(m_header->write_pos, m_header->reader_waiting);
+}
+
+const uint8_t* // NOLINT(build/unsigned)
+ShmRing::begin_read(size_t& size, duration_t timeout)
+{
+  // Only we change the read position
+  uint32_t read_pos = m_header->read_pos.load(std::memory_order_relaxed); // NOLINT(build/unsigned)
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    uint32_t write_pos = m_header->write_pos.load(std::memory_order_acquire); // NOLINT(build/unsigned)
+    if (write_pos != read_pos) {
+      uint64_t slot_size; // NOLINT(build/unsigned)
+      std::memcpy(&slot_size, slot(read_pos), sizeof(slot_size));
+      // The writer is in another process, so don't trust it to stay in the slot
+      size = std::min<size_t>(slot_size, m_slot_size);
+      return slot(read_pos) + s_slot_prefix;
+    }
+    if (!wait_while(m_header->write_pos, write_pos, m_header->reader_waiting, deadline)) {
+      return nullptr;
+    }
+  }
+}
+
+void
+ShmRing::commit_read()
+{
+  uint32_t read_pos = m_header->read_pos.load(std::memory_order_relaxed); // NOLINT(build/unsigned)
+  m_header->read_pos.store(read_pos + 1, std::memory_order_release);
+  wake(m_header->read_pos, m_header->writer_waiting);
+}
+
+bool
+ShmRing::wait_while(const std::atomic<uint32_t>& value, // NOLINT(build/unsigned)
+                    uint32_t expected,                  // NOLINT(build/unsigned)
+                    std::atomic<uint32_t>& waiting,     // NOLINT(build/unsigned)
+                    std::chrono::steady_clock::time_point deadline)
+{
+  for (int i = 0; i < s_n_spins; ++i) {
+    std::this_thread::yield();
+    if (value.load(std::memory_order_acquire) != expected) {
+      return true;
+    }
+  }
+  auto remaining = deadline - std::chrono::steady_clock::now();
+  if (remaining <= std::chrono::steady_clock::duration::zero()) {
+    return false;
+  }
+  // Pairs with the fence in wake(): either the other side sees that
+  // we're waiting, or we see its change here and don't sleep
+  waiting.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (value.load(std::memory_order_acquire) == expected) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+    timespec ts{ static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) }; // NOLINT(runtime/int)
+    // Returns at once if value has already changed, which is what stops a lost wakeup
+    futex(const_cast<std::atomic<uint32_t>*>(&value), FUTEX_WAIT, expected, &ts); // NOLINT(build/unsigned)
+  }
+  waiting.store(0, std::memory_order_relaxed);
+  return true;
+}
+
+void
+ShmRing::wake(std::atomic<uint32_t>& value, const std::atomic<uint32_t>& waiting) // NOLINT(build/unsigned)
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting.load(std::memory_order_relaxed) != 0) {
+    futex(&value, FUTEX_WAKE, INT_MAX, nullptr);
+  }
+}
+
+void
+ShmRing::remove(const std::string& name)
+{
+  auto full_name = shm_name(name);
+  if (shm_unlink(full_name.c_str()) != 0 && errno != ENOENT) {
+    throw ShmRingError(ERS_HERE, full_name, errno_string("shm_unlink failed"));
+  }
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,74 @@
+/**
+ * @file ShmSetCodec.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/ShmSetCodec.hpp"
+
+#include <cstring>
+
+namespace dunedaq::trigger {
+
+namespace {
+// A msgpack stream that writes to a fixed-size buffer, and notes when it runs out of room
+class SlotStream
+{
+public:
+  SlotStream(uint8_t* buffer, size_t capacity) // NOLINT(build/unsigned)
+    : m_buffer(buffer)
+    , m_capacity(capacity)
+  {}
+
+  void write(const char* data, size_t size)
+  {
+    if (m_overflow || size > m_capacity - m_size) {
+      m_overflow = true;
+      return;
+    }
+    std::memcpy(m_buffer + m_size, data, size);
+    m_size += size;
+  }
+
+  size_t size() const { return m_overflow ? 0 : m_size; }
+
+private:
+  uint8_t* m_buffer; // NOLINT(build/unsigned)
+  size_t m_capacity;
+  size_t m_size{ 0 };
+  bool m_overflow{ false };
+};
+} // namespace
+
+size_t
+encode_shm_set(const TPSet& tpset, uint8_t* buffer, size_t capacity) // NOLINT(build/unsigned)
+{
+  return serialize_flat_tpset(tpset, buffer, capacity);
+}
+
+void
+decode_shm_set(const uint8_t* data, size_t size, TPSet& tpset) // NOLINT(build/unsigned)
+{
+  FlatTPSetView(data, size).to_tpset(tpset);
+}
+
+size_t
+encode_shm_set(const TASet& taset, uint8_t* buffer, size_t capacity) // NOLINT(build/unsigned)
+{
+  TASetWireFormatScope format(TASetWireFormat::kSharedTPs);
+  SlotStream stream(buffer, capacity);
+  msgpack::packer<SlotStream> packer(stream);
+  packer.pack(taset);
+  return stream.size();
+}
+
+void
+decode_shm_set(const uint8_t* data, size_t size, TASet& taset) // NOLINT(build/unsigned)
+{
+  msgpack::object_handle handle = msgpack::unpack(reinterpret_cast<const char*>(data), size); // NOLINT
+  handle.get().convert(taset);
+}
+
+} // namespace dunedaq::trigger
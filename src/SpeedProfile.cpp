@@ -0,0 +1,79 @@
+/**
+ * @file SpeedProfile.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/SpeedProfile.hpp"
+
+#include <utility>
+
+namespace dunedaq::trigger {
+
+SpeedProfile::SpeedProfile(double speed_factor)
+  : m_steps{ { speed_factor, speed_factor, duration::zero() } }
+{}
+
+SpeedProfile::SpeedProfile(std::vector<Step> steps)
+  : m_steps(std::move(steps))
+{
+  // Zero-length steps would never be reached, so drop them
+  std::vector<Step> nonempty;
+  for (auto const& step : m_steps) {
+    if (step.length > duration::zero()) {
+      nonempty.push_back(step);
+    }
+  }
+  double last_factor = m_steps.empty() ? 1.0 : m_steps.back().end_factor;
+  m_steps = std::move(nonempty);
+  m_steps.push_back({ last_factor, last_factor, duration::zero() });
+}
+
+SpeedProfile
+SpeedProfile::linear_ramp(double start_factor, double end_factor, duration length, size_t n_steps)
+{
+  if (n_steps == 0) {
+    n_steps = 1;
+  }
+  std::vector<Step> steps;
+  for (size_t i = 0; i < n_steps; ++i) {
+    double step_start = start_factor + (end_factor - start_factor) * i / n_steps;
+    double step_end = start_factor + (end_factor - start_factor) * (i + 1) / n_steps;
+    duration step_length = length * (i + 1) / n_steps - length * i / n_steps;
+    steps.push_back({ step_start, step_end, step_length });
+  }
+  return SpeedProfile(std::move(steps));
+}
+
+size_t
+SpeedProfile::get_step_index(duration elapsed) const
+{
+  for (size_t i = 0; i < m_steps.size() - 1; ++i) {
+    if (elapsed < m_steps[i].length) {
+      return i;
+    }
+    elapsed -= m_steps[i].length;
+  }
+  return m_steps.size() - 1;
+}
+
+double
+SpeedProfile::get_speed_factor(duration elapsed) const
+{
+  if (elapsed < duration::zero()) {
+    elapsed = duration::zero();
+  }
+  for (size_t i = 0; i < m_steps.size() - 1; ++i) {
+    auto const& step = m_steps[i];
+    if (elapsed < step.length) {
+      double fraction = std::chrono::duration<double>(elapsed) / std::chrono::duration<double>(step.length);
+      return step.start_factor + (step.end_factor - step.start_factor) * fraction;
+    }
+    elapsed -= step.length;
+  }
+  return m_steps.back().end_factor;
+}
+
+} // namespace dunedaq::trigger
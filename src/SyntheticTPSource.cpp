@@ -0,0 +1,164 @@
+/**
+ * @file SyntheticTPSource.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/SyntheticTPSource.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace dunedaq::trigger {
+
+SyntheticTPSource::SyntheticTPSource(const Params& params, timestamp_t start_time)
+  : m_params(params)
+  , m_gen(params.seed)
+{
+  if (m_params.n_channels == 0) {
+    m_params.n_channels = 1;
+  }
+  m_next_burst_start = next_event_time(m_params.burst_rate_hz, start_time);
+  m_next_cluster = next_event_time(m_params.cluster_rate_hz, start_time);
+  m_next_track = next_event_time(m_params.track_rate_hz, start_time);
+}
+
+SyntheticTPSource::timestamp_t
+SyntheticTPSource::next_event_time(double rate_hz, timestamp_t after)
+{
+  if (rate_hz <= 0) {
+    return std::numeric_limits<timestamp_t>::max();
+  }
+  std::exponential_distribution<double> interval_s(rate_hz);
+  return after + static_cast<timestamp_t>(interval_s(m_gen) * m_params.clock_frequency_hz);
+}
+
+void
+SyntheticTPSource::generate(timestamp_t window_start, timestamp_t window_end, std::vector<TriggerPrimitive>& tps)
+{
+  size_t first_new = tps.size();
+
+  // Noise, split into the parts of the window inside and outside bursts
+  timestamp_t t = window_start;
+  while (t < window_end) {
+    if (t >= m_burst_end && m_next_burst_start <= t) {
+      m_burst_end = m_next_burst_start + m_params.burst_duration_ticks;
+      ++m_n_bursts;
+      // Bursts don't overlap: the next one starts after this one ends
+      m_next_burst_start = next_event_time(m_params.burst_rate_hz, m_burst_end);
+    }
+    bool in_burst = t < m_burst_end;
+    timestamp_t segment_end = std::min(window_end, in_burst ? m_burst_end : m_next_burst_start);
+    add_noise(t, segment_end, in_burst ? m_params.burst_noise_factor : 1., tps);
+    t = segment_end;
+  }
+
+  // Clusters and tracks that start in the window. Their TPs may
+  // extend into later windows, so they go into m_pending first
+  while (m_next_cluster < window_end) {
+    add_cluster(m_next_cluster);
+    m_next_cluster = next_event_time(m_params.cluster_rate_hz, m_next_cluster);
+  }
+  while (m_next_track < window_end) {
+    add_track(m_next_track);
+    m_next_track = next_event_time(m_params.track_rate_hz, m_next_track);
+  }
+
+  auto by_time = [](const TriggerPrimitive& a, const TriggerPrimitive& b) { return a.time_start < b.time_start; };
+  auto in_window_end = std::stable_partition(
+    m_pending.begin(), m_pending.end(), [&](const TriggerPrimitive& tp) { return tp.time_start < window_end; });
+  tps.insert(tps.end(), m_pending.begin(), in_window_end);
+  m_pending.erase(m_pending.begin(), in_window_end);
+
+  std::stable_sort(tps.begin() + first_new, tps.end(), by_time);
+}
+
+void
+SyntheticTPSource::add_noise(timestamp_t start,
+                             timestamp_t end,
+                             double rate_factor,
+                             std::vector<TriggerPrimitive>& tps)
+{
+  double mean = m_params.noise_rate_hz * rate_factor * m_params.n_channels * (end - start) / m_params.clock_frequency_hz;
+  if (!(mean > 0)) {
+    return;
+  }
+  std::poisson_distribution<uint64_t> n_dist(mean);               // NOLINT(build/unsigned)
+  std::uniform_int_distribution<timestamp_t> time_dist(start, end - 1);
+  std::uniform_int_distribution<uint32_t> channel_dist(0, m_params.n_channels - 1); // NOLINT(build/unsigned)
+  std::uniform_int_distribution<timestamp_t> tot_dist(25, 200);
+  std::uniform_int_distribution<uint16_t> adc_dist(20, 50); // NOLINT(build/unsigned)
+  uint64_t n = n_dist(m_gen); // NOLINT(build/unsigned)
+  for (uint64_t i = 0; i < n; ++i) { // NOLINT(build/unsigned)
+    timestamp_t time = time_dist(m_gen);
+    uint32_t channel = m_params.first_channel + channel_dist(m_gen); // NOLINT(build/unsigned)
+    timestamp_t tot = tot_dist(m_gen);
+    tps.push_back(make_tp(time, channel, tot, adc_dist(m_gen)));
+  }
+}
+
+void
+SyntheticTPSource::add_cluster(timestamp_t time)
+{
+  ++m_n_clusters;
+  std::poisson_distribution<uint64_t> n_dist(std::max(m_params.cluster_mean_n_tps, 1.)); // NOLINT(build/unsigned)
+  std::uniform_int_distribution<uint32_t> centre_dist(0, m_params.n_channels - 1);      // NOLINT(build/unsigned)
+  int64_t spread = m_params.cluster_channel_spread;
+  std::uniform_int_distribution<int64_t> offset_dist(-spread, spread);
+  std::uniform_int_distribution<timestamp_t> time_dist(0, std::max<timestamp_t>(m_params.cluster_time_spread_ticks, 1) - 1);
+  std::uniform_int_distribution<timestamp_t> tot_dist(100, 500);
+  std::uniform_int_distribution<uint16_t> adc_dist(50, 300); // NOLINT(build/unsigned)
+
+  uint64_t n = std::max<uint64_t>(n_dist(m_gen), 1); // NOLINT(build/unsigned)
+  int64_t centre = centre_dist(m_gen);
+  for (uint64_t i = 0; i < n; ++i) { // NOLINT(build/unsigned)
+    int64_t channel = std::clamp<int64_t>(centre + offset_dist(m_gen), 0, m_params.n_channels - 1);
+    timestamp_t tp_time = time + time_dist(m_gen);
+    timestamp_t tot = tot_dist(m_gen);
+    m_pending.push_back(make_tp(tp_time, m_params.first_channel + channel, tot, adc_dist(m_gen)));
+  }
+}
+
+void
+SyntheticTPSource::add_track(timestamp_t time)
+{
+  ++m_n_tracks;
+  uint32_t length = std::clamp<uint32_t>(m_params.track_n_channels, 1, m_params.n_channels); // NOLINT(build/unsigned)
+  std::uniform_int_distribution<uint32_t> start_dist(0, m_params.n_channels - length);      // NOLINT(build/unsigned)
+  std::bernoulli_distribution direction_dist(0.5);
+  std::uniform_int_distribution<timestamp_t> tot_dist(100, 400);
+  std::uniform_int_distribution<uint16_t> adc_dist(80, 250); // NOLINT(build/unsigned)
+
+  uint32_t start_channel = start_dist(m_gen); // NOLINT(build/unsigned)
+  bool ascending = direction_dist(m_gen);
+  for (uint32_t i = 0; i < length; ++i) { // NOLINT(build/unsigned)
+    uint32_t channel = ascending ? start_channel + i : start_channel + length - 1 - i; // NOLINT(build/unsigned)
+    timestamp_t tp_time = time + i * m_params.track_ticks_per_channel;
+    timestamp_t tot = tot_dist(m_gen);
+    m_pending.push_back(make_tp(tp_time, m_params.first_channel + channel, tot, adc_dist(m_gen)));
+  }
+}
+
+SyntheticTPSource::TriggerPrimitive
+SyntheticTPSource::make_tp(timestamp_t time,
+                           uint32_t channel, // NOLINT(build/unsigned)
+                           timestamp_t time_over_threshold,
+                           uint16_t adc_peak) const // NOLINT(build/unsigned)
+{
+  TriggerPrimitive tp;
+  tp.time_start = time;
+  tp.time_over_threshold = time_over_threshold;
+  tp.time_peak = time + time_over_threshold / 2;
+  tp.channel = channel;
+  tp.adc_peak = adc_peak;
+  // Roughly a triangular pulse, sampled every 25 ticks
+  tp.adc_integral = adc_peak * time_over_threshold / 50;
+  tp.detid = m_params.detid;
+  tp.type = TriggerPrimitive::Type::kTPC;
+  tp.algorithm = TriggerPrimitive::Algorithm::kTPCDefault;
+  return tp;
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,156 @@
+/**
+ * @file TASetSharedTPs.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TASetSharedTPs.hpp"
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace dunedaq::trigger {
+
+namespace {
+thread_local TASetWireFormat t_taset_wire_format = TASetWireFormat::kMsgPack;
+
+using TriggerPrimitive = TASetSharedTPs::TriggerPrimitive;
+
+bool
+tps_equal(const TriggerPrimitive& a, const TriggerPrimitive& b)
+{
+  return a.time_start == b.time_start && a.time_peak == b.time_peak &&
+         a.time_over_threshold == b.time_over_threshold && a.channel == b.channel &&
+         a.adc_integral == b.adc_integral && a.adc_peak == b.adc_peak && a.detid == b.detid && a.type == b.type &&
+         a.algorithm == b.algorithm && a.version == b.version && a.flag == b.flag;
+}
+
+// The TP's time and channel are almost always enough to tell TPs apart,
+// and tps_equal takes care of the rest
+struct TPHash
+{
+  size_t operator()(const TriggerPrimitive* tp) const
+  {
+    size_t hash = std::hash<uint64_t>()(tp->time_start); // NOLINT(build/unsigned)
+    hash ^= std::hash<int64_t>()(tp->channel) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    return hash;
+  }
+};
+
+struct TPEqual
+{
+  bool operator()(const TriggerPrimitive* a, const TriggerPrimitive* b) const { return tps_equal(*a, *b); }
+};
+} // namespace
+
+TASetWireFormat
+get_taset_wire_format()
+{
+  return t_taset_wire_format;
+}
+
+TASetWireFormatScope::TASetWireFormatScope(TASetWireFormat format)
+  : m_previous_format(t_taset_wire_format)
+{
+  t_taset_wire_format = format;
+}
+
+TASetWireFormatScope::~TASetWireFormatScope()
+{
+  t_taset_wire_format = m_previous_format;
+}
+
+TASetSharedTPs
+TASetSharedTPs::from_taset(const Set<TriggerActivity>& taset)
+{
+  TASetSharedTPs shared;
+  shared.seqno = taset.seqno;
+  shared.run_number = taset.run_number;
+  shared.origin = taset.origin;
+  shared.type = taset.type;
+  shared.start_time = taset.start_time;
+  shared.end_time = taset.end_time;
+
+  size_t n_inputs = 0;
+  for (auto const& ta : taset.objects) {
+    n_inputs += ta.inputs.size();
+  }
+  shared.activities.reserve(taset.objects.size());
+  shared.input_offsets.reserve(taset.objects.size() + 1);
+  shared.input_indices.reserve(n_inputs);
+
+  // The map points into the TASet's TPs, so nothing is copied to look them up
+  std::unordered_map<const TriggerPrimitive*, index_t, TPHash, TPEqual> index_of_tp(n_inputs);
+  for (auto const& ta : taset.objects) {
+    shared.activities.push_back(static_cast<const TriggerActivityData&>(ta));
+    for (auto const& tp : ta.inputs) {
+      auto [it, inserted] = index_of_tp.emplace(&tp, static_cast<index_t>(shared.tps.size()));
+      if (inserted) {
+        shared.tps.push_back(tp);
+      }
+      shared.input_indices.push_back(it->second);
+    }
+    shared.input_offsets.push_back(static_cast<index_t>(shared.input_indices.size()));
+  }
+  return shared;
+}
+
+Set<TASetSharedTPs::TriggerActivity>
+TASetSharedTPs::to_taset() const
+{
+  Set<TriggerActivity> taset;
+  taset.seqno = seqno;
+  taset.run_number = run_number;
+  taset.origin = origin;
+  taset.type = type;
+  taset.start_time = start_time;
+  taset.end_time = end_time;
+  taset.objects.reserve(activities.size());
+  for (size_t i = 0; i < activities.size(); ++i) {
+    taset.objects.push_back(get_activity(i));
+  }
+  return taset;
+}
+
+std::vector<TASetSharedTPs::TriggerPrimitive>
+TASetSharedTPs::get_inputs(size_t i) const
+{
+  std::vector<TriggerPrimitive> inputs;
+  inputs.reserve(get_n_inputs(i));
+  for_each_input(i, [&](const TriggerPrimitive& tp) { inputs.push_back(tp); });
+  return inputs;
+}
+
+TASetSharedTPs::TriggerActivity
+TASetSharedTPs::get_activity(size_t i) const
+{
+  TriggerActivity ta;
+  static_cast<TriggerActivityData&>(ta) = activities[i];
+  ta.inputs = get_inputs(i);
+  return ta;
+}
+
+bool
+TASetSharedTPs::is_consistent() const
+{
+  if (input_offsets.size() != activities.size() + 1 || input_offsets.front() != 0 ||
+      input_offsets.back() != input_indices.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < activities.size(); ++i) {
+    if (input_offsets[i + 1] < input_offsets[i]) {
+      return false;
+    }
+  }
+  for (auto index : input_indices) {
+    if (index >= tps.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace dunedaq::trigger
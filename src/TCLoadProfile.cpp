@@ -0,0 +1,187 @@
+/**
+ * @file TCLoadProfile.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TCLoadProfile.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+namespace dunedaq::trigger {
+
+TCLoadProfile::TCLoadProfile(const Params& params, timestamp_t start_time)
+  : m_params(params)
+  , m_start_time(start_time)
+  , m_gen(params.seed)
+{
+  if (!m_params.type_mix.empty()) {
+    std::vector<double> weights;
+    for (auto const& type_weight : m_params.type_mix) {
+      weights.push_back(std::max(type_weight.weight, 0.));
+    }
+    m_type_dist = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+  }
+  m_params.window_pre_fraction = std::clamp(m_params.window_pre_fraction, 0., 1.);
+
+  m_next_background = next_background_time(start_time);
+  for (auto const& train : m_params.trains) {
+    auto first = start_time + static_cast<timestamp_t>(train.start_s * m_params.clock_frequency_hz);
+    m_train_states.push_back({ first, first });
+  }
+}
+
+std::string
+TCLoadProfile::check_params(const Params& params)
+{
+  if (!(params.clock_frequency_hz > 0)) {
+    return "clock frequency must be positive";
+  }
+  if (params.start_rate_hz < 0 || params.end_rate_hz < 0) {
+    return "background rates must not be negative";
+  }
+  for (size_t i = 0; i < params.trains.size(); ++i) {
+    auto const& train = params.trains[i];
+    if (train.start_s < 0) {
+      return "train " + std::to_string(i) + " starts before the run";
+    }
+    // Otherwise the next train starts while this one is still being
+    // sent, and its TCs would come out of time order
+    auto period_ticks = static_cast<timestamp_t>(train.period_s * params.clock_frequency_hz);
+    if (train.n_tcs > 0 && period_ticks < train.n_tcs * train.spacing_ticks) {
+      return "train " + std::to_string(i) + " has a period of " + std::to_string(period_ticks) +
+             " ticks, shorter than its " + std::to_string(train.n_tcs) + " TCs spaced " +
+             std::to_string(train.spacing_ticks) + " ticks apart";
+    }
+  }
+  return "";
+}
+
+double
+TCLoadProfile::get_rate_hz(timestamp_t time) const
+{
+  double elapsed_s = time > m_start_time ? static_cast<double>(time - m_start_time) / m_params.clock_frequency_hz : 0;
+  if (m_params.ramp_duration_s <= 0 || elapsed_s >= m_params.ramp_duration_s) {
+    return m_params.end_rate_hz;
+  }
+  double fraction = elapsed_s / m_params.ramp_duration_s;
+  return m_params.start_rate_hz + fraction * (m_params.end_rate_hz - m_params.start_rate_hz);
+}
+
+TCLoadProfile::timestamp_t
+TCLoadProfile::next_background_time(timestamp_t after)
+{
+  double rate_hz = get_rate_hz(after);
+  if (!(rate_hz > 0)) {
+    // A ramp up from zero: skip ahead through the ramp until the rate is positive
+    if (!(m_params.end_rate_hz > 0)) {
+      return std::numeric_limits<timestamp_t>::max();
+    }
+    auto ramp_step = std::max<timestamp_t>(
+      static_cast<timestamp_t>(m_params.ramp_duration_s * m_params.clock_frequency_hz / 1000), 1);
+    while (!(rate_hz > 0)) {
+      after += ramp_step;
+      rate_hz = get_rate_hz(after);
+    }
+  }
+
+  // With a ramp, this uses the rate at the start of each interval,
+  // which is close enough as long as the ramp is slow compared to the rate
+  double interval_s = 1. / rate_hz;
+  if (m_params.poisson) {
+    std::exponential_distribution<double> interval_dist(rate_hz);
+    interval_s = interval_dist(m_gen);
+  }
+  return after + std::max<timestamp_t>(static_cast<timestamp_t>(interval_s * m_params.clock_frequency_hz), 1);
+}
+
+TCLoadProfile::timestamp_t
+TCLoadProfile::draw_window_ticks()
+{
+  switch (m_params.window_distribution) {
+    case WindowDistribution::kUniform: {
+      std::uniform_int_distribution<timestamp_t> window_dist(
+        m_params.min_window_ticks, std::max(m_params.min_window_ticks, m_params.max_window_ticks));
+      return window_dist(m_gen);
+    }
+    case WindowDistribution::kExponential: {
+      if (m_params.window_ticks == 0) {
+        return m_params.min_window_ticks;
+      }
+      std::exponential_distribution<double> window_dist(1. / m_params.window_ticks);
+      auto window = static_cast<timestamp_t>(window_dist(m_gen));
+      auto max_window =
+        m_params.max_window_ticks > 0 ? m_params.max_window_ticks : std::numeric_limits<timestamp_t>::max();
+      return std::clamp(window, m_params.min_window_ticks, std::max(m_params.min_window_ticks, max_window));
+    }
+    case WindowDistribution::kFixed:
+    default:
+      return m_params.window_ticks;
+  }
+}
+
+TCLoadProfile::TriggerCandidate::Type
+TCLoadProfile::draw_type()
+{
+  if (m_params.type_mix.empty()) {
+    return TriggerCandidate::Type::kRandom;
+  }
+  return m_params.type_mix[m_type_dist(m_gen)].type;
+}
+
+TCLoadProfile::TriggerCandidate
+TCLoadProfile::make_candidate(timestamp_t time, timestamp_t window_ticks)
+{
+  auto pre = static_cast<timestamp_t>(window_ticks * m_params.window_pre_fraction);
+  TriggerCandidate candidate;
+  candidate.time_candidate = time;
+  candidate.time_start = time > pre ? time - pre : 0;
+  candidate.time_end = time + (window_ticks - pre);
+  candidate.detid = { 0 };
+  candidate.type = draw_type();
+  candidate.algorithm = TriggerCandidate::Algorithm::kCustom;
+  return candidate;
+}
+
+TCLoadProfile::TriggerCandidate
+TCLoadProfile::next()
+{
+  // Find the source with the earliest next TC. The background wins ties
+  size_t earliest_train = m_train_states.size();
+  timestamp_t earliest_time = m_next_background;
+  for (size_t i = 0; i < m_train_states.size(); ++i) {
+    if (m_params.trains[i].n_tcs > 0 && m_train_states[i].next_time < earliest_time) {
+      earliest_train = i;
+      earliest_time = m_train_states[i].next_time;
+    }
+  }
+
+  if (earliest_train == m_train_states.size()) {
+    if (earliest_time == std::numeric_limits<timestamp_t>::max()) {
+      return make_candidate(earliest_time, 0);
+    }
+    ++m_n_background;
+    m_next_background = next_background_time(earliest_time);
+    return make_candidate(earliest_time, draw_window_ticks());
+  }
+
+  auto const& train = m_params.trains[earliest_train];
+  auto& state = m_train_states[earliest_train];
+  ++m_n_train_tcs;
+  ++state.index_in_train;
+  if (state.index_in_train < train.n_tcs) {
+    state.next_time += train.spacing_ticks;
+  } else {
+    state.train_start +=
+      std::max<timestamp_t>(static_cast<timestamp_t>(train.period_s * m_params.clock_frequency_hz), 1);
+    state.next_time = state.train_start;
+    state.index_in_train = 0;
+  }
+  return make_candidate(earliest_time, train.window_ticks > 0 ? train.window_ticks : draw_window_ticks());
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,235 @@
+/**
+ * @file TPReplayFile.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPReplayFile.hpp"
+
+#include "trigger/Issues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dunedaq::trigger {
+
+TPReplayFileWriter::TPReplayFileWriter(const std::string& filename,
+                                       timestamp_t tpset_time_width,
+                                       timestamp_t tpset_time_offset)
+  : m_filename(filename)
+  , m_file(filename, std::ios::binary | std::ios::trunc)
+{
+  if (!m_file) {
+    throw BadTPReplayFile(ERS_HERE, filename, "could not open for writing");
+  }
+  if (tpset_time_width == 0) {
+    throw BadTPReplayFile(ERS_HERE, filename, "tpset_time_width must be non-zero");
+  }
+  m_header.tpset_time_width = tpset_time_width;
+  m_header.tpset_time_offset = tpset_time_offset;
+  m_header.tps_offset = sizeof(TPReplayFileHeader);
+  // Placeholder header: rewritten with the final counts in close()
+  m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(TPReplayFileHeader));
+}
+
+TPReplayFileWriter::~TPReplayFileWriter()
+{
+  if (m_file.is_open()) {
+    try {
+      close();
+    } catch (const ers::Issue& e) {
+      ers::error(e);
+    }
+  }
+}
+
+bool
+TPReplayFileWriter::add(const TriggerPrimitive& tp)
+{
+  if (tp.time_start < m_prev_time_start) {
+    return false;
+  }
+  m_prev_time_start = tp.time_start;
+
+  // Same TPSet boundaries as TriggerPrimitiveMaker uses for text input:
+  // [ n*width+offset, (n+1)*width+offset ]
+  uint64_t set_number = (tp.time_start + m_header.tpset_time_offset) / m_header.tpset_time_width; // NOLINT
+  uint64_t start_time = set_number * m_header.tpset_time_width + m_header.tpset_time_offset;      // NOLINT
+  if (m_index.empty() || m_index.back().start_time != start_time) {
+    m_index.push_back(TPReplayFileSet{ start_time, m_header.n_tps, 0 });
+  }
+  ++m_index.back().n_tps;
+
+  m_file.write(reinterpret_cast<const char*>(&tp), sizeof(TriggerPrimitive));
+  ++m_header.n_tps;
+  return true;
+}
+
+void
+TPReplayFileWriter::close()
+{
+  if (!m_file.is_open()) {
+    return;
+  }
+  m_header.n_sets = m_index.size();
+  m_header.index_offset = m_header.tps_offset + m_header.n_tps * sizeof(TriggerPrimitive);
+
+  m_file.write(reinterpret_cast<const char*>(m_index.data()), m_index.size() * sizeof(TPReplayFileSet));
+  m_file.seekp(0);
+  m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(TPReplayFileHeader));
+  bool ok = m_file.good();
+  m_file.close();
+  if (!ok) {
+    throw BadTPReplayFile(ERS_HERE, m_filename, "error while writing");
+  }
+  TLOG_DEBUG(1) << "Wrote " << m_header.n_tps << " TPs in " << m_header.n_sets << " TPSets to " << m_filename;
+}
+
+TPReplayFile::TPReplayFile(const std::string& filename)
+  : m_filename(filename)
+{
+  m_fd = ::open(filename.c_str(), O_RDONLY);
+  if (m_fd < 0) {
+    throw BadTPReplayFile(ERS_HERE, filename, std::strerror(errno));
+  }
+
+  struct stat st;
+  if (::fstat(m_fd, &st) != 0) {
+    ::close(m_fd);
+    throw BadTPReplayFile(ERS_HERE, filename, std::strerror(errno));
+  }
+  m_mapping_size = st.st_size;
+  if (m_mapping_size < sizeof(TPReplayFileHeader)) {
+    ::close(m_fd);
+    throw BadTPReplayFile(ERS_HERE, filename, "file is too short to contain a header");
+  }
+
+  m_mapping = ::mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+  if (m_mapping == MAP_FAILED) { // NOLINT
+    m_mapping = nullptr;
+    ::close(m_fd);
+    throw BadTPReplayFile(ERS_HERE, filename, std::strerror(errno));
+  }
+  // Replay reads the file front to back, so let the kernel read ahead
+  // and drop pages behind us
+  ::madvise(m_mapping, m_mapping_size, MADV_SEQUENTIAL);
+
+  const char* base = static_cast<const char*>(m_mapping);
+  std::memcpy(&m_header, base, sizeof(TPReplayFileHeader));
+
+  std::string reason;
+  if (m_header.magic != TPReplayFileHeader::s_magic) {
+    reason = "not a TP replay file";
+  } else if (m_header.version != TPReplayFileHeader::s_version) {
+    reason = "unsupported version " + std::to_string(m_header.version);
+  } else if (m_header.tp_size != sizeof(TriggerPrimitive)) {
+    reason = "TP size " + std::to_string(m_header.tp_size) + " does not match TriggerPrimitive size " +
+             std::to_string(sizeof(TriggerPrimitive));
+  } else if (m_header.tps_offset % alignof(TriggerPrimitive) != 0 ||
+             m_header.index_offset % alignof(TPReplayFileSet) != 0) {
+    reason = "misaligned TP array or index";
+  } else if (m_header.tps_offset + m_header.n_tps * sizeof(TriggerPrimitive) > m_mapping_size ||
+             m_header.index_offset + m_header.n_sets * sizeof(TPReplayFileSet) > m_mapping_size) {
+    reason = "file is truncated";
+  }
+  if (!reason.empty()) {
+    ::munmap(m_mapping, m_mapping_size);
+    ::close(m_fd);
+    throw BadTPReplayFile(ERS_HERE, filename, reason);
+  }
+
+  m_tps = reinterpret_cast<const TriggerPrimitive*>(base + m_header.tps_offset);
+  m_stored_index = reinterpret_cast<const TPReplayFileSet*>(base + m_header.index_offset);
+
+  // Until told otherwise, use the set boundaries the file was written with
+  m_sets.assign(m_stored_index, m_stored_index + m_header.n_sets);
+}
+
+TPReplayFile::~TPReplayFile()
+{
+  if (m_mapping != nullptr) {
+    ::munmap(m_mapping, m_mapping_size);
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+void
+TPReplayFile::load_into_memory(int numa_node)
+{
+  if (m_buffer) {
+    return;
+  }
+  size_t tps_size = m_header.n_tps * sizeof(TriggerPrimitive);
+  size_t index_size = m_header.n_sets * sizeof(TPReplayFileSet);
+  try {
+    m_buffer = std::make_unique<HugePageBuffer>(tps_size + index_size, numa_node);
+  } catch (const std::bad_alloc&) {
+    throw BadTPReplayFile(ERS_HERE, m_filename, "could not allocate " + std::to_string(tps_size + index_size) +
+                                                  " bytes to load the file into");
+  }
+  // The TPs come first, so both stay aligned
+  char* base = static_cast<char*>(m_buffer->data());
+  std::memcpy(base, m_tps, tps_size);
+  std::memcpy(base + tps_size, m_stored_index, index_size);
+  m_tps = reinterpret_cast<const TriggerPrimitive*>(base);
+  m_stored_index = reinterpret_cast<const TPReplayFileSet*>(base + tps_size);
+
+  ::munmap(m_mapping, m_mapping_size);
+  m_mapping = nullptr;
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+std::string
+TPReplayFile::describe_memory() const
+{
+  return m_buffer ? "loaded into " + m_buffer->describe() : std::string("memory-mapped");
+}
+
+void
+TPReplayFile::index_sets(timestamp_t tpset_time_width, timestamp_t tpset_time_offset)
+{
+  if (tpset_time_width == m_header.tpset_time_width && tpset_time_offset == m_header.tpset_time_offset) {
+    m_sets.assign(m_stored_index, m_stored_index + m_header.n_sets);
+    return;
+  }
+
+  if (tpset_time_width == 0) {
+    throw BadTPReplayFile(ERS_HERE, m_filename, "tpset_time_width must be non-zero");
+  }
+
+  TLOG_DEBUG(1) << "Rebuilding TPSet index of " << m_filename << " for width " << tpset_time_width << ", offset "
+                << tpset_time_offset << " (file has width " << m_header.tpset_time_width << ", offset "
+                << m_header.tpset_time_offset << ")";
+
+  // The TPs are sorted, so the end of each set can be found by binary
+  // search, touching only a handful of pages per set
+  m_sets.clear();
+  const TriggerPrimitive* end = m_tps + m_header.n_tps;
+  const TriggerPrimitive* it = m_tps;
+  while (it != end) {
+    uint64_t set_number = (it->time_start + tpset_time_offset) / tpset_time_width; // NOLINT(build/unsigned)
+    const TriggerPrimitive* next = std::partition_point(it, end, [&](const TriggerPrimitive& tp) {
+      return (tp.time_start + tpset_time_offset) / tpset_time_width <= set_number;
+    });
+    m_sets.push_back(TPReplayFileSet{ set_number * tpset_time_width + tpset_time_offset,
+                                      static_cast<uint64_t>(it - m_tps), // NOLINT(build/unsigned)
+                                      static_cast<uint64_t>(next - it) }); // NOLINT(build/unsigned)
+    it = next;
+  }
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,88 @@
+/**
+ * @file TPSetAccumulator.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPSetAccumulator.hpp"
+
+#include <algorithm>
+
+namespace dunedaq::trigger {
+
+TPSetAccumulator::TPSetAccumulator(uint64_t width, uint64_t offset) // NOLINT(build/unsigned)
+  : m_width(width > 0 ? width : 1)
+  , m_offset(offset)
+{}
+
+uint64_t // NOLINT(build/unsigned)
+TPSetAccumulator::set_number(const TriggerPrimitive& tp) const
+{
+  return (tp.time_start + m_offset) / m_width;
+}
+
+void
+TPSetAccumulator::add(const TriggerPrimitive* tps, size_t n_tps)
+{
+  for (size_t i = 0; i < n_tps; ++i) {
+    uint64_t n = set_number(tps[i]); // NOLINT(build/unsigned)
+    if (n < m_next_set_number) {
+      ++m_n_dropped;
+      continue;
+    }
+    m_latest_set_number = std::max(m_latest_set_number, n);
+    m_pending.push_back(tps[i]);
+  }
+}
+
+void
+TPSetAccumulator::emit_complete(std::vector<TPSet>& sets)
+{
+  emit_before(m_latest_set_number, sets);
+}
+
+void
+TPSetAccumulator::flush(std::vector<TPSet>& sets)
+{
+  emit_before(m_latest_set_number + 1, sets);
+}
+
+void
+TPSetAccumulator::reset()
+{
+  m_pending.clear();
+  m_next_set_number = 0;
+  m_latest_set_number = 0;
+  m_n_dropped = 0;
+}
+
+void
+TPSetAccumulator::emit_before(uint64_t end, std::vector<TPSet>& sets) // NOLINT(build/unsigned)
+{
+  if (end <= m_next_set_number) {
+    return;
+  }
+  // Move the TPs to be emitted to the front, in time order, and keep the rest pending
+  auto emit_end = std::stable_partition(
+    m_pending.begin(), m_pending.end(), [&](const TriggerPrimitive& tp) { return set_number(tp) < end; });
+  std::stable_sort(m_pending.begin(), emit_end, [](const TriggerPrimitive& a, const TriggerPrimitive& b) {
+    return a.time_start < b.time_start;
+  });
+
+  for (auto it = m_pending.begin(); it != emit_end;) {
+    uint64_t n = set_number(*it); // NOLINT(build/unsigned)
+    auto set_end = std::find_if(it, emit_end, [&](const TriggerPrimitive& tp) { return set_number(tp) != n; });
+    TPSet& tpset = sets.emplace_back();
+    tpset.start_time = n * m_width + m_offset;
+    tpset.end_time = tpset.start_time + m_width;
+    tpset.type = TPSet::Type::kPayload;
+    tpset.objects.assign(it, set_end);
+    it = set_end;
+  }
+  m_pending.erase(m_pending.begin(), emit_end);
+  m_next_set_number = end;
+}
+
+} // namespace dunedaq::trigger
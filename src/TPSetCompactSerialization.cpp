@@ -0,0 +1,206 @@
+/**
+ * @file TPSetCompactSerialization.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPSetCompactSerialization.hpp"
+
+#include "trigger/Issues.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace dunedaq::trigger {
+
+namespace {
+
+using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+
+// The number of varints in each encoded TP. Each is at least one byte
+constexpr size_t s_fields_per_tp = 11;
+
+inline uint64_t // NOLINT(build/unsigned)
+zigzag(int64_t value)
+{
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); // NOLINT(build/unsigned)
+}
+
+inline int64_t
+unzigzag(uint64_t value) // NOLINT(build/unsigned)
+{
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// The difference a - b, modulo 2^64, as a signed value
+inline int64_t
+difference(uint64_t a, uint64_t b) // NOLINT(build/unsigned)
+{
+  return static_cast<int64_t>(a - b);
+}
+
+// Write a varint at out, which must have room for it, and return the byte after it
+inline uint8_t* // NOLINT(build/unsigned)
+write_varint(uint8_t* out, uint64_t value) // NOLINT(build/unsigned)
+{
+  while (value >= 0x80) {
+    *out++ = static_cast<uint8_t>(value) | 0x80; // NOLINT(build/unsigned)
+    value >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(value); // NOLINT(build/unsigned)
+  return out;
+}
+
+// Reads varints from a buffer, throwing BadCompactTPSet if they run off the end
+class VarintReader
+{
+public:
+  VarintReader(const uint8_t* begin, const uint8_t* end) // NOLINT(build/unsigned)
+    : m_pos(begin)
+    , m_end(end)
+  {}
+
+  uint64_t read() // NOLINT(build/unsigned)
+  {
+    uint64_t value = 0; // NOLINT(build/unsigned)
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (m_pos == m_end) {
+        throw BadCompactTPSet(ERS_HERE, "the data ends in the middle of a value");
+      }
+      uint8_t byte = *m_pos++;                                  // NOLINT(build/unsigned)
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;     // NOLINT(build/unsigned)
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw BadCompactTPSet(ERS_HERE, "a value is longer than 64 bits");
+  }
+
+  int64_t read_signed() { return unzigzag(read()); }
+
+  size_t remaining() const { return m_end - m_pos; }
+
+private:
+  const uint8_t* m_pos; // NOLINT(build/unsigned)
+  const uint8_t* m_end; // NOLINT(build/unsigned)
+};
+
+} // namespace
+
+size_t
+get_max_compact_tpset_size(size_t n_tps)
+{
+  return CompactTPSetFormat::s_max_header_size + n_tps * CompactTPSetFormat::s_max_tp_size;
+}
+
+size_t
+serialize_compact_tpset(const Set<TriggerPrimitive>& tpset, std::vector<uint8_t>& bytes) // NOLINT(build/unsigned)
+{
+  // Write into a buffer big enough for the worst case, so there's no
+  // bounds checking per value, then trim it to what was used
+  size_t const initial_size = bytes.size();
+  bytes.resize(initial_size + get_max_compact_tpset_size(tpset.objects.size()));
+  uint8_t* const begin = bytes.data() + initial_size; // NOLINT(build/unsigned)
+  uint8_t* out = begin;                               // NOLINT(build/unsigned)
+
+  uint32_t magic = CompactTPSetFormat::s_magic; // NOLINT(build/unsigned)
+  std::memcpy(out, &magic, sizeof(magic));
+  out += sizeof(magic);
+  *out++ = CompactTPSetFormat::s_version;
+
+  out = write_varint(out, tpset.seqno);
+  out = write_varint(out, tpset.run_number);
+  out = write_varint(out, static_cast<uint64_t>(tpset.origin.subsystem)); // NOLINT(build/unsigned)
+  out = write_varint(out, tpset.origin.id);
+  out = write_varint(out, static_cast<uint64_t>(tpset.type)); // NOLINT(build/unsigned)
+  out = write_varint(out, tpset.start_time);
+  out = write_varint(out, zigzag(difference(tpset.end_time, tpset.start_time)));
+  out = write_varint(out, tpset.objects.size());
+
+  int64_t previous_channel = 0;
+  for (auto const& tp : tpset.objects) {
+    out = write_varint(out, zigzag(difference(tp.time_start, tpset.start_time)));
+    out = write_varint(out, zigzag(difference(tp.time_peak, tp.time_start)));
+    out = write_varint(out, tp.time_over_threshold);
+    out = write_varint(out, zigzag(static_cast<int64_t>(tp.channel) - previous_channel));
+    previous_channel = tp.channel;
+    out = write_varint(out, tp.adc_integral);
+    out = write_varint(out, tp.adc_peak);
+    out = write_varint(out, tp.detid);
+    out = write_varint(out, static_cast<uint32_t>(tp.type));      // NOLINT(build/unsigned)
+    out = write_varint(out, static_cast<uint32_t>(tp.algorithm)); // NOLINT(build/unsigned)
+    out = write_varint(out, tp.version);
+    out = write_varint(out, tp.flag);
+  }
+
+  size_t const n_written = out - begin;
+  bytes.resize(initial_size + n_written);
+  return n_written;
+}
+
+std::vector<uint8_t> // NOLINT(build/unsigned)
+serialize_compact_tpset(const Set<TriggerPrimitive>& tpset)
+{
+  std::vector<uint8_t> bytes; // NOLINT(build/unsigned)
+  serialize_compact_tpset(tpset, bytes);
+  return bytes;
+}
+
+bool
+is_compact_tpset(const uint8_t* data, size_t size) // NOLINT(build/unsigned)
+{
+  if (data == nullptr || size < CompactTPSetFormat::s_preamble_size) {
+    return false;
+  }
+  uint32_t magic; // NOLINT(build/unsigned)
+  std::memcpy(&magic, data, sizeof(magic));
+  return magic == CompactTPSetFormat::s_magic && data[sizeof(magic)] == CompactTPSetFormat::s_version;
+}
+
+Set<TriggerPrimitive>
+deserialize_compact_tpset(const uint8_t* data, size_t size) // NOLINT(build/unsigned)
+{
+  if (!is_compact_tpset(data, size)) {
+    throw BadCompactTPSet(ERS_HERE, "bad magic number or version");
+  }
+  VarintReader reader(data + CompactTPSetFormat::s_preamble_size, data + size);
+
+  Set<TriggerPrimitive> tpset;
+  tpset.seqno = reader.read();
+  tpset.run_number = reader.read();
+  tpset.origin.subsystem = static_cast<decltype(tpset.origin.subsystem)>(reader.read());
+  tpset.origin.id = reader.read();
+  tpset.type = static_cast<decltype(tpset.type)>(reader.read());
+  tpset.start_time = reader.read();
+  tpset.end_time = tpset.start_time + static_cast<uint64_t>(reader.read_signed()); // NOLINT(build/unsigned)
+
+  // Check the TP count against the data before allocating anything for it
+  uint64_t n_tps = reader.read(); // NOLINT(build/unsigned)
+  if (n_tps > reader.remaining() / s_fields_per_tp) {
+    throw BadCompactTPSet(ERS_HERE,
+                          "the header says " + std::to_string(n_tps) + " TPs, but there are only " +
+                            std::to_string(reader.remaining()) + " bytes left");
+  }
+
+  tpset.objects.resize(n_tps);
+  int64_t previous_channel = 0;
+  for (auto& tp : tpset.objects) {
+    tp.time_start = tpset.start_time + static_cast<uint64_t>(reader.read_signed()); // NOLINT(build/unsigned)
+    tp.time_peak = tp.time_start + static_cast<uint64_t>(reader.read_signed());     // NOLINT(build/unsigned)
+    tp.time_over_threshold = reader.read();
+    previous_channel += reader.read_signed();
+    tp.channel = static_cast<decltype(tp.channel)>(previous_channel);
+    tp.adc_integral = reader.read();
+    tp.adc_peak = reader.read();
+    tp.detid = reader.read();
+    tp.type = static_cast<TriggerPrimitive::Type>(reader.read());
+    tp.algorithm = static_cast<TriggerPrimitive::Algorithm>(reader.read());
+    tp.version = reader.read();
+    tp.flag = reader.read();
+  }
+  return tpset;
+}
+
+} // namespace dunedaq::trigger
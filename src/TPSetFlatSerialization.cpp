@@ -0,0 +1,168 @@
+/**
+ * @file TPSetFlatSerialization.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPSetFlatSerialization.hpp"
+
+#include "trigger/Issues.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace dunedaq::trigger {
+
+namespace {
+thread_local TPSetWireFormat t_tpset_wire_format = TPSetWireFormat::kMsgPack;
+
+// Read and check the header at the start of data. Throws BadFlatTPSet if there's a problem
+FlatTPSetHeader
+read_header(const uint8_t* data, size_t size) // NOLINT(build/unsigned)
+{
+  if (data == nullptr || size < sizeof(FlatTPSetHeader)) {
+    throw BadFlatTPSet(ERS_HERE, "only " + std::to_string(size) + " bytes, which is smaller than the header");
+  }
+  FlatTPSetHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != FlatTPSetHeader::s_magic) {
+    throw BadFlatTPSet(ERS_HERE, "bad magic number " + std::to_string(header.magic));
+  }
+  if (header.version != FlatTPSetHeader::s_version) {
+    throw BadFlatTPSet(ERS_HERE, "unsupported version " + std::to_string(header.version));
+  }
+  if (header.tp_size != sizeof(detdataformats::trigger::TriggerPrimitive)) {
+    throw BadFlatTPSet(ERS_HERE, "TP size " + std::to_string(header.tp_size) + " doesn't match this build's TP size");
+  }
+  // Compare counts rather than sizes so that a corrupt n_tps can't overflow
+  if (header.n_tps > (size - sizeof(header)) / header.tp_size) {
+    throw BadFlatTPSet(ERS_HERE,
+                       "header says " + std::to_string(header.n_tps) + " TPs, but there are only " +
+                         std::to_string(size) + " bytes");
+  }
+  return header;
+}
+} // namespace
+
+TPSetWireFormat
+get_tpset_wire_format()
+{
+  return t_tpset_wire_format;
+}
+
+TPSetWireFormatScope::TPSetWireFormatScope(TPSetWireFormat format)
+  : m_previous_format(t_tpset_wire_format)
+{
+  t_tpset_wire_format = format;
+}
+
+TPSetWireFormatScope::~TPSetWireFormatScope()
+{
+  t_tpset_wire_format = m_previous_format;
+}
+
+FlatTPSetHeader
+make_flat_tpset_header(const Set<detdataformats::trigger::TriggerPrimitive>& tpset)
+{
+  FlatTPSetHeader header;
+  header.seqno = tpset.seqno;
+  header.run_number = tpset.run_number;
+  header.origin_subsystem = static_cast<uint32_t>(tpset.origin.subsystem); // NOLINT(build/unsigned)
+  header.origin_id = tpset.origin.id;
+  header.type = static_cast<uint32_t>(tpset.type); // NOLINT(build/unsigned)
+  header.start_time = tpset.start_time;
+  header.end_time = tpset.end_time;
+  header.n_tps = tpset.objects.size();
+  return header;
+}
+
+size_t
+get_flat_tpset_size(const Set<detdataformats::trigger::TriggerPrimitive>& tpset)
+{
+  return sizeof(FlatTPSetHeader) + tpset.objects.size() * sizeof(detdataformats::trigger::TriggerPrimitive);
+}
+
+std::vector<uint8_t> // NOLINT(build/unsigned)
+serialize_flat_tpset(const Set<detdataformats::trigger::TriggerPrimitive>& tpset)
+{
+  std::vector<uint8_t> bytes(get_flat_tpset_size(tpset)); // NOLINT(build/unsigned)
+  serialize_flat_tpset(tpset, bytes.data(), bytes.size());
+  return bytes;
+}
+
+size_t
+serialize_flat_tpset(const Set<detdataformats::trigger::TriggerPrimitive>& tpset,
+                     uint8_t* buffer, // NOLINT(build/unsigned)
+                     size_t capacity)
+{
+  size_t size = get_flat_tpset_size(tpset);
+  if (size > capacity) {
+    return 0;
+  }
+  auto header = make_flat_tpset_header(tpset);
+  std::memcpy(buffer, &header, sizeof(header));
+  if (!tpset.objects.empty()) {
+    std::memcpy(buffer + sizeof(header),
+                tpset.objects.data(),
+                tpset.objects.size() * sizeof(detdataformats::trigger::TriggerPrimitive));
+  }
+  return size;
+}
+
+bool
+is_flat_tpset(const uint8_t* data, size_t size) // NOLINT(build/unsigned)
+{
+  if (data == nullptr || size < sizeof(FlatTPSetHeader)) {
+    return false;
+  }
+  FlatTPSetHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  return header.magic == FlatTPSetHeader::s_magic && header.version == FlatTPSetHeader::s_version;
+}
+
+Set<detdataformats::trigger::TriggerPrimitive>
+deserialize_flat_tpset(const uint8_t* data, size_t size) // NOLINT(build/unsigned)
+{
+  return FlatTPSetView(data, size).to_tpset();
+}
+
+FlatTPSetView::FlatTPSetView(const uint8_t* data, size_t size) // NOLINT(build/unsigned)
+  : m_header(read_header(data, size))
+  , m_tp_data(data + sizeof(FlatTPSetHeader))
+{}
+
+FlatTPSetView::TriggerPrimitive
+FlatTPSetView::operator[](size_t i) const
+{
+  TriggerPrimitive tp;
+  std::memcpy(&tp, m_tp_data + i * sizeof(TriggerPrimitive), sizeof(TriggerPrimitive));
+  return tp;
+}
+
+Set<FlatTPSetView::TriggerPrimitive>
+FlatTPSetView::to_tpset() const
+{
+  Set<TriggerPrimitive> tpset;
+  to_tpset(tpset);
+  return tpset;
+}
+
+void
+FlatTPSetView::to_tpset(Set<TriggerPrimitive>& tpset) const
+{
+  tpset.seqno = m_header.seqno;
+  tpset.run_number = m_header.run_number;
+  tpset.origin.subsystem = static_cast<decltype(tpset.origin.subsystem)>(m_header.origin_subsystem);
+  tpset.origin.id = m_header.origin_id;
+  tpset.type = static_cast<decltype(tpset.type)>(m_header.type);
+  tpset.start_time = m_header.start_time;
+  tpset.end_time = m_header.end_time;
+  tpset.objects.resize(m_header.n_tps);
+  if (m_header.n_tps > 0) {
+    std::memcpy(tpset.objects.data(), m_tp_data, m_header.n_tps * sizeof(TriggerPrimitive));
+  }
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,189 @@
+/**
+ * @file TPSetSoA.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPSetSoA.hpp"
+
+namespace dunedaq::trigger {
+
+TPSetSoA
+TPSetSoA::from_tpset(const Set<TriggerPrimitive>& tpset)
+{
+  TPSetSoA soa;
+  soa.seqno = tpset.seqno;
+  soa.run_number = tpset.run_number;
+  soa.origin = tpset.origin;
+  soa.type = tpset.type;
+  soa.start_time = tpset.start_time;
+  soa.end_time = tpset.end_time;
+  soa.assign(tpset.objects);
+  return soa;
+}
+
+Set<TPSetSoA::TriggerPrimitive>
+TPSetSoA::to_tpset() const
+{
+  Set<TriggerPrimitive> tpset;
+  tpset.seqno = seqno;
+  tpset.run_number = run_number;
+  tpset.origin = origin;
+  tpset.type = type;
+  tpset.start_time = start_time;
+  tpset.end_time = end_time;
+  append_to(tpset.objects);
+  return tpset;
+}
+
+void
+TPSetSoA::clear()
+{
+  time_start.clear();
+  time_peak.clear();
+  time_over_threshold.clear();
+  channel.clear();
+  adc_integral.clear();
+  adc_peak.clear();
+  detid.clear();
+  tp_type.clear();
+  algorithm.clear();
+  version.clear();
+  flag.clear();
+}
+
+void
+TPSetSoA::reserve(size_t n)
+{
+  time_start.reserve(n);
+  time_peak.reserve(n);
+  time_over_threshold.reserve(n);
+  channel.reserve(n);
+  adc_integral.reserve(n);
+  adc_peak.reserve(n);
+  detid.reserve(n);
+  tp_type.reserve(n);
+  algorithm.reserve(n);
+  version.reserve(n);
+  flag.reserve(n);
+}
+
+void
+TPSetSoA::assign(const TriggerPrimitive* tps, size_t n)
+{
+  // Resize, then fill each column in its own loop, so that each loop
+  // writes to one array instead of eleven at once
+  time_start.resize(n);
+  time_peak.resize(n);
+  time_over_threshold.resize(n);
+  channel.resize(n);
+  adc_integral.resize(n);
+  adc_peak.resize(n);
+  detid.resize(n);
+  tp_type.resize(n);
+  algorithm.resize(n);
+  version.resize(n);
+  flag.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    time_start[i] = tps[i].time_start;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    time_peak[i] = tps[i].time_peak;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    time_over_threshold[i] = tps[i].time_over_threshold;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    channel[i] = tps[i].channel;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    adc_integral[i] = tps[i].adc_integral;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    adc_peak[i] = tps[i].adc_peak;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    detid[i] = tps[i].detid;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    tp_type[i] = tps[i].type;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    algorithm[i] = tps[i].algorithm;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    version[i] = tps[i].version;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    flag[i] = tps[i].flag;
+  }
+}
+
+void
+TPSetSoA::push_back(const TriggerPrimitive& tp)
+{
+  time_start.push_back(tp.time_start);
+  time_peak.push_back(tp.time_peak);
+  time_over_threshold.push_back(tp.time_over_threshold);
+  channel.push_back(tp.channel);
+  adc_integral.push_back(tp.adc_integral);
+  adc_peak.push_back(tp.adc_peak);
+  detid.push_back(tp.detid);
+  tp_type.push_back(tp.type);
+  algorithm.push_back(tp.algorithm);
+  version.push_back(tp.version);
+  flag.push_back(tp.flag);
+}
+
+TPSetSoA::TriggerPrimitive
+TPSetSoA::get_tp(size_t i) const
+{
+  TriggerPrimitive tp;
+  tp.time_start = time_start[i];
+  tp.time_peak = time_peak[i];
+  tp.time_over_threshold = time_over_threshold[i];
+  tp.channel = channel[i];
+  tp.adc_integral = adc_integral[i];
+  tp.adc_peak = adc_peak[i];
+  tp.detid = detid[i];
+  tp.type = tp_type[i];
+  tp.algorithm = algorithm[i];
+  tp.version = version[i];
+  tp.flag = flag[i];
+  return tp;
+}
+
+void
+TPSetSoA::append_to(std::vector<TriggerPrimitive>& tps) const
+{
+  size_t n = size();
+  size_t first = tps.size();
+  tps.resize(first + n);
+  TriggerPrimitive* out = tps.data() + first;
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = get_tp(i);
+  }
+}
+
+bool
+TPSetSoA::is_consistent() const
+{
+  size_t n = time_start.size();
+  return time_peak.size() == n && time_over_threshold.size() == n && channel.size() == n &&
+         adc_integral.size() == n && adc_peak.size() == n && detid.size() == n && tp_type.size() == n &&
+         algorithm.size() == n && version.size() == n && flag.size() == n;
+}
+
+TPSliceActivityMaker::~TPSliceActivityMaker() = default;
+
+void
+TPSliceDispatcher::operator()(const std::vector<TPSetSoA::TriggerPrimitive>& slice,
+                              std::vector<triggeralgs::TriggerActivity>& output_tas)
+{
+  m_columns.assign(slice);
+  (*m_slice_maker)(m_columns, output_tas);
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,121 @@
+/**
+ * @file TPTextReader.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPTextReader.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace dunedaq::trigger {
+
+namespace {
+inline bool
+is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+} // namespace
+
+TPTextReader::TPTextReader(const std::string& filename, size_t chunk_size)
+  : m_file(filename, std::ios::binary)
+  , m_buffer(chunk_size > 0 ? chunk_size : s_default_chunk_size)
+{}
+
+bool
+TPTextReader::next(TriggerPrimitive& tp)
+{
+  // Same field order as the text files written by streamed_TPs_to_text
+  return parse_field(tp.time_start) && parse_field(tp.time_over_threshold) && parse_field(tp.time_peak) &&
+         parse_field(tp.channel) && parse_field(tp.adc_integral) && parse_field(tp.adc_peak) &&
+         parse_field(tp.detid) && parse_field(tp.type);
+}
+
+template<class T>
+bool
+TPTextReader::parse_field(T& value)
+{
+  const char* begin;
+  const char* end;
+  if (!next_token(begin, end)) {
+    return false;
+  }
+  if constexpr (std::is_enum_v<T>) {
+    std::underlying_type_t<T> underlying;
+    auto [ptr, ec] = std::from_chars(begin, end, underlying);
+    if (ec != std::errc() || ptr != end) {
+      return false;
+    }
+    value = static_cast<T>(underlying);
+  } else {
+    auto [ptr, ec] = std::from_chars(begin, end, value);
+    if (ec != std::errc() || ptr != end) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+TPTextReader::next_token(const char*& begin, const char*& end)
+{
+  while (true) {
+    while (m_pos < m_end && is_space(m_buffer[m_pos])) {
+      ++m_pos;
+    }
+    if (m_pos == m_end) {
+      if (!refill()) {
+        return false;
+      }
+      continue;
+    }
+    size_t token_end = m_pos;
+    while (token_end < m_end && !is_space(m_buffer[token_end])) {
+      ++token_end;
+    }
+    if (token_end == m_end && !m_eof) {
+      // The token may continue in the next chunk: read more and rescan
+      refill();
+      continue;
+    }
+    begin = m_buffer.data() + m_pos;
+    end = m_buffer.data() + token_end;
+    m_pos = token_end;
+    return true;
+  }
+}
+
+bool
+TPTextReader::refill()
+{
+  if (m_eof || !m_file.is_open()) {
+    m_eof = true;
+    return false;
+  }
+  size_t remaining = m_end - m_pos;
+  if (remaining > 0 && m_pos > 0) {
+    std::memmove(m_buffer.data(), m_buffer.data() + m_pos, remaining);
+  }
+  m_pos = 0;
+  m_end = remaining;
+  if (m_end == m_buffer.size()) {
+    // A single token filled the whole buffer. Not a sensible TP file, but don't loop forever
+    m_buffer.resize(2 * m_buffer.size());
+  }
+  m_file.read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+  size_t n_read = m_file.gcount();
+  m_end += n_read;
+  m_bytes_read += n_read;
+  if (n_read == 0 || m_file.eof()) {
+    m_eof = true;
+  }
+  return n_read > 0;
+}
+
+} // namespace dunedaq::trigger
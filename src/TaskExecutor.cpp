@@ -0,0 +1,331 @@
+/**
+ * @file TaskExecutor.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TaskExecutor.hpp"
+
+#include "trigger/Issues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include <pthread.h>
+#include <time.h>
+
+namespace dunedaq::trigger {
+
+namespace {
+
+// The executor and queue of the worker thread we're on, if any
+thread_local TaskExecutor* t_executor = nullptr;
+thread_local size_t t_worker_index = 0;
+
+constexpr size_t s_default_n_threads = 4;
+
+// The longest a thread sleeps without checking whether it's being stopped
+constexpr std::chrono::milliseconds s_max_sleep(100);
+
+size_t
+get_n_threads_from_environment()
+{
+  size_t n_cpus = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  size_t n_threads = std::min(s_default_n_threads, n_cpus);
+  const char* value = std::getenv("DUNEDAQ_TRIGGER_EXECUTOR_THREADS");
+  if (value == nullptr) {
+    return n_threads;
+  }
+  char* end = nullptr;
+  long requested = std::strtol(value, &end, 10); // NOLINT(runtime/int)
+  if (end == value || *end != '\0' || requested < 1) {
+    ers::warning(BadExecutorThreads(ERS_HERE, value, n_threads));
+    return n_threads;
+  }
+  return std::min(static_cast<size_t>(requested), n_cpus);
+}
+
+} // namespace
+
+std::chrono::nanoseconds
+get_thread_cpu_time()
+{
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+TaskExecutor::Task::Task(TaskExecutor& executor,
+                         const std::string& name,
+                         std::function<bool()> run,
+                         duration_t poll_interval)
+  : m_executor(executor)
+  , m_name(name)
+  , m_run(std::move(run))
+  , m_poll_interval(poll_interval)
+{}
+
+void
+TaskExecutor::Task::notify()
+{
+  int state = m_state.load(std::memory_order_acquire);
+  while (true) {
+    if (state == kIdle) {
+      if (m_state.compare_exchange_weak(state, kScheduled, std::memory_order_acq_rel)) {
+        m_executor.schedule(shared_from_this());
+        return;
+      }
+    } else if (state == kRunning) {
+      // The thread running us sees this when the run ends, and runs us again
+      if (m_state.compare_exchange_weak(state, kRunningNotified, std::memory_order_acq_rel)) {
+        return;
+      }
+    } else {
+      // Already due to run, or stopped
+      return;
+    }
+  }
+}
+
+TaskStats
+TaskExecutor::Task::get_stats() const
+{
+  TaskStats stats;
+  stats.runs = m_runs.load(std::memory_order_relaxed);
+  stats.cpu_time = std::chrono::nanoseconds(m_cpu_ns.load(std::memory_order_relaxed));
+  return stats;
+}
+
+TaskExecutor&
+TaskExecutor::get()
+{
+  static TaskExecutor executor(get_n_threads_from_environment(), "trgexec");
+  return executor;
+}
+
+TaskExecutor::TaskExecutor(size_t n_threads, const std::string& thread_name)
+{
+  n_threads = std::max<size_t>(n_threads, 1);
+  for (size_t i = 0; i < n_threads; ++i) {
+    m_workers.push_back(std::make_unique<Worker>());
+  }
+  // Start the threads once every queue exists, since they steal from each other
+  for (size_t i = 0; i < n_threads; ++i) {
+    m_workers[i]->thread = std::thread(&TaskExecutor::do_work, this, i);
+    std::string name = thread_name + std::to_string(i);
+    pthread_setname_np(m_workers[i]->thread.native_handle(), name.substr(0, 15).c_str());
+  }
+  TLOG() << "Task executor " << thread_name << " started with " << n_threads << " threads";
+}
+
+TaskExecutor::~TaskExecutor()
+{
+  m_running.store(false);
+  {
+    std::lock_guard<std::mutex> lk(m_sleep_mutex);
+    m_wake.notify_all();
+  }
+  for (auto& worker : m_workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+std::shared_ptr<TaskExecutor::Task>
+TaskExecutor::make_task(const std::string& name, std::function<bool()> run, duration_t poll_interval)
+{
+  return std::make_shared<Task>(*this, name, std::move(run), poll_interval);
+}
+
+void
+TaskExecutor::start_task(Task& task)
+{
+  task.m_stopping.store(false);
+  int expected = Task::kStopped;
+  task.m_state.compare_exchange_strong(expected, Task::kIdle);
+  task.notify();
+}
+
+void
+TaskExecutor::stop_task(Task& task)
+{
+  task.m_stopping.store(true);
+  int state = task.m_state.load();
+  while (state != Task::kStopped) {
+    if (state == Task::kRunning || state == Task::kRunningNotified) {
+      // The thread running it stops it when the run ends
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      state = task.m_state.load();
+    } else {
+      // Idle or queued. A queued task is skipped when its turn comes
+      task.m_state.compare_exchange_weak(state, Task::kStopped);
+    }
+  }
+}
+
+TaskExecutorStats
+TaskExecutor::get_stats() const
+{
+  TaskExecutorStats stats;
+  stats.n_threads = m_workers.size();
+  stats.runs = m_runs.load(std::memory_order_relaxed);
+  stats.steals = m_steals.load(std::memory_order_relaxed);
+  stats.sleeps = m_sleeps.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void
+TaskExecutor::schedule(std::shared_ptr<Task> task)
+{
+  // Our own worker thread's queue if we're on one, to keep a chain of
+  // tasks on one core, or else spread around the threads
+  size_t index = t_executor == this ? t_worker_index
+                                    : m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+  // Count the task before it can be taken, so the count never goes below zero
+  m_n_queued.fetch_add(1, std::memory_order_seq_cst);
+  {
+    std::lock_guard<std::mutex> lk(m_workers[index]->mutex);
+    m_workers[index]->tasks.push_back(std::move(task));
+  }
+  // Pairs with the increment of m_n_sleeping in do_work(), so that
+  // either we see the sleeper or the sleeper sees the task
+  if (m_n_sleeping.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lk(m_sleep_mutex);
+    m_wake.notify_one();
+  }
+}
+
+std::shared_ptr<TaskExecutor::Task>
+TaskExecutor::take(size_t worker_index)
+{
+  {
+    Worker& own = *m_workers[worker_index];
+    std::lock_guard<std::mutex> lk(own.mutex);
+    if (!own.tasks.empty()) {
+      auto task = std::move(own.tasks.front());
+      own.tasks.pop_front();
+      m_n_queued.fetch_sub(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+  for (size_t i = 1; i < m_workers.size(); ++i) {
+    Worker& other = *m_workers[(worker_index + i) % m_workers.size()];
+    std::lock_guard<std::mutex> lk(other.mutex);
+    if (!other.tasks.empty()) {
+      // The other end from where its owner takes
+      auto task = std::move(other.tasks.back());
+      other.tasks.pop_back();
+      m_n_queued.fetch_sub(1, std::memory_order_relaxed);
+      m_steals.fetch_add(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void
+TaskExecutor::run(std::shared_ptr<Task> task)
+{
+  int state = Task::kScheduled;
+  if (!task->m_state.compare_exchange_strong(state, Task::kRunning, std::memory_order_acq_rel)) {
+    // Stopped while it was queued
+    return;
+  }
+
+  auto cpu_start = get_thread_cpu_time();
+  bool more = task->m_run();
+  task->m_cpu_ns.fetch_add((get_thread_cpu_time() - cpu_start).count(), std::memory_order_relaxed);
+  task->m_runs.fetch_add(1, std::memory_order_relaxed);
+  m_runs.fetch_add(1, std::memory_order_relaxed);
+
+  if (task->m_stopping.load()) {
+    task->m_state.store(Task::kStopped, std::memory_order_release);
+    return;
+  }
+  state = Task::kRunning;
+  if (!more && task->m_state.compare_exchange_strong(state, Task::kIdle, std::memory_order_acq_rel)) {
+    add_timer(task);
+    return;
+  }
+  // It has more to do, or was notified while it ran. Only the running
+  // thread moves a task out of kRunningNotified, so nothing else can change it now
+  task->m_state.store(Task::kScheduled, std::memory_order_release);
+  schedule(std::move(task));
+}
+
+void
+TaskExecutor::add_timer(const std::shared_ptr<Task>& task)
+{
+  if (task->m_timer_pending.exchange(true)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(m_timer_mutex);
+  m_timers.push({ std::chrono::steady_clock::now() + task->m_poll_interval.load(), task });
+  m_next_timer.store(m_timers.top().when.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+std::chrono::steady_clock::time_point
+TaskExecutor::fire_timers()
+{
+  auto now = std::chrono::steady_clock::now();
+  int64_t next = m_next_timer.load(std::memory_order_relaxed);
+  if (now.time_since_epoch().count() < next) {
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(next));
+  }
+
+  std::vector<std::shared_ptr<Task>> due;
+  std::chrono::steady_clock::time_point next_time = std::chrono::steady_clock::time_point::max();
+  {
+    std::lock_guard<std::mutex> lk(m_timer_mutex);
+    while (!m_timers.empty() && m_timers.top().when <= now) {
+      if (auto task = m_timers.top().task.lock()) {
+        due.push_back(std::move(task));
+      }
+      m_timers.pop();
+    }
+    if (!m_timers.empty()) {
+      next_time = m_timers.top().when;
+    }
+    m_next_timer.store(m_timers.empty() ? std::numeric_limits<int64_t>::max() : next_time.time_since_epoch().count(),
+                       std::memory_order_relaxed);
+  }
+  for (auto& task : due) {
+    task->m_timer_pending.store(false);
+    task->notify();
+  }
+  return next_time;
+}
+
+void
+TaskExecutor::do_work(size_t worker_index)
+{
+  t_executor = this;
+  t_worker_index = worker_index;
+  while (m_running.load(std::memory_order_relaxed)) {
+    auto next_timer = fire_timers();
+    if (auto task = take(worker_index)) {
+      run(std::move(task));
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lk(m_sleep_mutex);
+    m_n_sleeping.fetch_add(1, std::memory_order_seq_cst);
+    if (m_n_queued.load(std::memory_order_seq_cst) == 0 && m_running.load()) {
+      m_sleeps.fetch_add(1, std::memory_order_relaxed);
+      auto deadline = std::min(next_timer, std::chrono::steady_clock::now() + s_max_sleep);
+      m_wake.wait_until(lk, deadline, [this] {
+        return m_n_queued.load(std::memory_order_seq_cst) > 0 || !m_running.load();
+      });
+    }
+    m_n_sleeping.fetch_sub(1, std::memory_order_relaxed);
+  }
+  t_executor = nullptr;
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,376 @@
+/**
+ * @file ThreadPlacement.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/ThreadPlacement.hpp"
+
+#include "trigger/Issues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace dunedaq::trigger {
+
+namespace {
+
+constexpr size_t s_huge_page_size = 2 << 20;
+
+// Node masks for the memory policy system calls, big enough for any machine we'll see
+constexpr int s_max_numa_nodes = 1024;
+constexpr size_t s_bits_per_word = 8 * sizeof(unsigned long); // NOLINT(runtime/int)
+using node_mask_t = unsigned long[s_max_numa_nodes / s_bits_per_word]; // NOLINT(runtime/int)
+// The maxnode argument that goes with a node_mask_t. The kernel only uses
+// maxnode - 1 bits of the mask, so this is one more than the bits in it
+constexpr unsigned long s_mask_maxnode = s_max_numa_nodes + 1; // NOLINT(runtime/int)
+
+// The first line of a file under /sys, or "" if it can't be read
+std::string
+read_sys_file(const std::string& path)
+{
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+bool
+path_exists(const std::string& path)
+{
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0;
+}
+
+// The NUMA node of each CPU. Empty if the machine doesn't say
+std::map<int, int>
+get_cpu_nodes()
+{
+  std::map<int, int> nodes;
+  std::string online = read_sys_file("/sys/devices/system/node/online");
+  if (online.empty()) {
+    return nodes;
+  }
+  try {
+    for (int node : parse_cpu_list(online)) {
+      for (int cpu : parse_cpu_list(read_sys_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))) {
+        nodes[cpu] = node;
+      }
+    }
+  } catch (const InvalidThreadPlacement&) {
+    nodes.clear();
+  }
+  return nodes;
+}
+
+// The hyperthread siblings of cpu, including itself
+std::vector<int>
+get_siblings(int cpu)
+{
+  std::string list =
+    read_sys_file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+  try {
+    return list.empty() ? std::vector<int>{ cpu } : parse_cpu_list(list);
+  } catch (const InvalidThreadPlacement&) {
+    return { cpu };
+  }
+}
+
+void
+set_node(node_mask_t& mask, int node)
+{
+  std::memset(mask, 0, sizeof(node_mask_t));
+  mask[node / s_bits_per_word] |= 1UL << (node % s_bits_per_word);
+}
+
+std::vector<int>
+get_nodes(const node_mask_t& mask)
+{
+  std::vector<int> nodes;
+  for (int node = 0; node < s_max_numa_nodes; ++node) {
+    if (mask[node / s_bits_per_word] & (1UL << (node % s_bits_per_word))) {
+      nodes.push_back(node);
+    }
+  }
+  return nodes;
+}
+
+} // namespace
+
+std::vector<int>
+parse_cpu_list(const std::string& list)
+{
+  std::set<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+    if (range.empty()) {
+      continue;
+    }
+    try {
+      size_t used = 0;
+      int first = std::stoi(range, &used);
+      int last = first;
+      if (used < range.size()) {
+        if (range[used] != '-') {
+          throw std::invalid_argument(range);
+        }
+        std::string rest = range.substr(used + 1);
+        last = std::stoi(rest, &used);
+        if (used != rest.size()) {
+          throw std::invalid_argument(range);
+        }
+      }
+      if (first < 0 || last < first) {
+        throw std::invalid_argument(range);
+      }
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.insert(cpu);
+      }
+    } catch (const std::logic_error&) {
+      throw InvalidThreadPlacement(ERS_HERE, "\"" + range + "\" in CPU list \"" + list + "\" isn't a number or range");
+    }
+  }
+  return { cpus.begin(), cpus.end() };
+}
+
+std::string
+format_cpu_list(std::vector<int> cpus)
+{
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  std::ostringstream oss;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+    oss << (i == 0 ? "" : ",") << cpus[i];
+    if (j > i) {
+      oss << "-" << cpus[j];
+    }
+    i = j + 1;
+  }
+  return oss.str();
+}
+
+ThreadPlacement
+make_thread_placement(const std::string& cpus, int numa_node, bool huge_pages)
+{
+  ThreadPlacement placement;
+  placement.cpus = parse_cpu_list(cpus);
+  placement.numa_node = numa_node < 0 ? -1 : numa_node;
+  placement.huge_pages = huge_pages;
+
+  long n_cpus = ::sysconf(_SC_NPROCESSORS_CONF); // NOLINT(runtime/int)
+  for (int cpu : placement.cpus) {
+    if (cpu >= n_cpus || cpu >= CPU_SETSIZE) {
+      throw InvalidThreadPlacement(ERS_HERE,
+                                   "CPU " + std::to_string(cpu) + " doesn't exist, this machine has " +
+                                     std::to_string(n_cpus));
+    }
+  }
+  if (placement.numa_node >= 0 &&
+      (placement.numa_node >= s_max_numa_nodes ||
+       !path_exists("/sys/devices/system/node/node" + std::to_string(placement.numa_node)))) {
+    throw InvalidThreadPlacement(ERS_HERE, "NUMA node " + std::to_string(placement.numa_node) + " doesn't exist");
+  }
+  return placement;
+}
+
+void
+apply_thread_placement(const ThreadPlacement& placement, const std::string& who)
+{
+  if (!placement.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : placement.cpus) {
+      CPU_SET(cpu, &set);
+    }
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+      ers::warning(ThreadPlacementFailed(
+        ERS_HERE, who, "can't run on CPUs " + format_cpu_list(placement.cpus) + ": " + std::strerror(err)));
+    }
+  }
+  if (placement.numa_node >= 0) {
+    node_mask_t mask;
+    set_node(mask, placement.numa_node);
+    // Preferred rather than bound, so that a full node falls back to another rather than failing
+    if (::syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, s_mask_maxnode) != 0) {
+      ers::warning(ThreadPlacementFailed(
+        ERS_HERE, who, "can't prefer NUMA node " + std::to_string(placement.numa_node) + ": " + std::strerror(errno)));
+    }
+  }
+  TLOG() << who << ": " << describe_thread_placement();
+}
+
+std::string
+describe_thread_placement()
+{
+  std::ostringstream oss;
+
+  std::vector<int> cpus;
+  cpu_set_t set;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  auto cpu_nodes = get_cpu_nodes();
+  std::set<int> nodes_of_cpus;
+  for (int cpu : cpus) {
+    auto it = cpu_nodes.find(cpu);
+    if (it != cpu_nodes.end()) {
+      nodes_of_cpus.insert(it->second);
+    }
+  }
+  oss << "running on CPUs " << format_cpu_list(cpus);
+  if (!nodes_of_cpus.empty()) {
+    oss << (nodes_of_cpus.size() == 1 ? " (NUMA node " : " (NUMA nodes ")
+        << format_cpu_list({ nodes_of_cpus.begin(), nodes_of_cpus.end() }) << ")";
+  }
+
+  int mode = MPOL_DEFAULT;
+  node_mask_t mask;
+  std::memset(mask, 0, sizeof(mask));
+  std::vector<int> memory_nodes;
+  if (::syscall(SYS_get_mempolicy, &mode, mask, s_mask_maxnode, nullptr, 0) == 0) {
+    memory_nodes = get_nodes(mask);
+  }
+  switch (mode) {
+    case MPOL_PREFERRED:
+      oss << ", memory preferred on NUMA node " << format_cpu_list(memory_nodes);
+      break;
+    case MPOL_BIND:
+      oss << ", memory bound to NUMA nodes " << format_cpu_list(memory_nodes);
+      break;
+    case MPOL_INTERLEAVE:
+      oss << ", memory interleaved over NUMA nodes " << format_cpu_list(memory_nodes);
+      break;
+    default:
+      oss << ", memory from the local NUMA node";
+      break;
+  }
+
+  // Only worth pointing out if the thread is pinned to some of the CPUs
+  if (cpus.size() < static_cast<size_t>(::sysconf(_SC_NPROCESSORS_ONLN))) {
+    std::set<int> in_set(cpus.begin(), cpus.end());
+    std::vector<std::string> shared;
+    for (int cpu : cpus) {
+      for (int sibling : get_siblings(cpu)) {
+        if (sibling > cpu && in_set.count(sibling)) {
+          shared.push_back(std::to_string(cpu) + "/" + std::to_string(sibling));
+        }
+      }
+    }
+    if (!shared.empty()) {
+      oss << ". Hyperthread siblings share cores:";
+      for (auto& pair : shared) {
+        oss << " " << pair;
+      }
+    }
+    for (int node : memory_nodes) {
+      if (!nodes_of_cpus.empty() && !nodes_of_cpus.count(node)) {
+        oss << ". Memory node " << node << " is remote from the CPUs";
+      }
+    }
+  }
+  return oss.str();
+}
+
+HugePageBuffer::HugePageBuffer(size_t size, int numa_node)
+  : m_size(size)
+  , m_mapping_size(std::max<size_t>((size + s_huge_page_size - 1) / s_huge_page_size, 1) * s_huge_page_size)
+  , m_numa_node(numa_node)
+{
+  // Reserved huge pages first. This fails straight away if there aren't enough
+  m_data = ::mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (m_data != MAP_FAILED) { // NOLINT
+    m_backing = Backing::kHugeTLB;
+  } else {
+    // Transparent huge pages need the region to be aligned to a huge
+    // page, so map an extra page's worth and trim the ends
+    size_t padded_size = m_mapping_size + s_huge_page_size;
+    void* padded = ::mmap(nullptr, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (padded == MAP_FAILED) { // NOLINT
+      m_data = nullptr;
+      throw std::bad_alloc();
+    }
+    auto start = reinterpret_cast<uintptr_t>(padded);
+    auto aligned = (start + s_huge_page_size - 1) & ~(uintptr_t(s_huge_page_size) - 1);
+    if (aligned > start) {
+      ::munmap(padded, aligned - start);
+    }
+    size_t tail = start + padded_size - (aligned + m_mapping_size);
+    if (tail > 0) {
+      ::munmap(reinterpret_cast<void*>(aligned + m_mapping_size), tail);
+    }
+    m_data = reinterpret_cast<void*>(aligned);
+    m_backing = ::madvise(m_data, m_mapping_size, MADV_HUGEPAGE) == 0 ? Backing::kTransparent : Backing::kNormal;
+  }
+
+  // Nothing has been touched yet, so every page is allocated by this policy
+  if (numa_node >= 0 && numa_node < s_max_numa_nodes) {
+    node_mask_t mask;
+    set_node(mask, numa_node);
+    if (::syscall(SYS_mbind, m_data, m_mapping_size, MPOL_PREFERRED, mask, s_mask_maxnode, 0) != 0) {
+      m_numa_node = -1;
+    }
+  }
+}
+
+HugePageBuffer::~HugePageBuffer()
+{
+  if (m_data != nullptr) {
+    ::munmap(m_data, m_mapping_size);
+  }
+}
+
+std::string
+HugePageBuffer::describe() const
+{
+  std::ostringstream oss;
+  oss << m_size / double(1 << 20) << " MiB";
+  switch (m_backing) {
+    case Backing::kHugeTLB:
+      oss << " in reserved huge pages";
+      break;
+    case Backing::kTransparent:
+      oss << " in transparent huge pages";
+      break;
+    case Backing::kNormal:
+      oss << " in ordinary pages, since huge pages aren't available";
+      break;
+  }
+  if (m_numa_node >= 0) {
+    oss << " on NUMA node " << m_numa_node;
+  }
+  return oss.str();
+}
+
+} // namespace dunedaq::trigger
@@ -0,0 +1,371 @@
+/**
+ * @file TimeWindowKernels.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TimeWindowKernels.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+// NOLINTNEXTLINE(build/define_used)
+#define TRIGGER_TIME_WINDOW_X86 1
+#endif
+
+namespace dunedaq::trigger {
+
+namespace {
+
+using timestamp_t = daqdataformats::timestamp_t;
+
+// The kernels for one instruction set
+struct Kernels
+{
+  TimeWindowIsa isa;
+  uint64_t (*mask)(const timestamp_t*, size_t, size_t, timestamp_t, timestamp_t); // NOLINT(build/unsigned)
+  size_t (*count)(const timestamp_t*, size_t, size_t, timestamp_t, timestamp_t);
+  size_t (*find_outside)(const timestamp_t*, size_t, size_t, timestamp_t, timestamp_t);
+};
+
+// Scalar
+
+uint64_t // NOLINT(build/unsigned)
+scalar_mask(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  uint64_t mask = 0; // NOLINT(build/unsigned)
+  for (size_t i = 0; i < n; ++i) {
+    timestamp_t t = times[i * stride];
+    mask |= uint64_t(t >= begin && t <= end) << i; // NOLINT(build/unsigned)
+  }
+  return mask;
+}
+
+size_t
+scalar_count(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    timestamp_t t = times[i * stride];
+    count += (t >= begin && t <= end);
+  }
+  return count;
+}
+
+size_t
+scalar_find_outside(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  for (size_t i = 0; i < n; ++i) {
+    timestamp_t t = times[i * stride];
+    if (t < begin || t > end) {
+      return i;
+    }
+  }
+  return n;
+}
+
+constexpr Kernels s_scalar_kernels{ TimeWindowIsa::kScalar, scalar_mask, scalar_count, scalar_find_outside };
+
+#ifdef TRIGGER_TIME_WINDOW_X86
+
+// AVX2, four timestamps at a time. AVX2 only has signed 64-bit
+// comparisons, so the timestamps and the window are shifted by 2^63 to
+// compare them as signed numbers. Strided timestamps are gathered; the
+// tail of fewer than four is done by the scalar loop
+
+struct AVX2Window
+{
+  __m256i sign;
+  __m256i begin;
+  __m256i end;
+  __m256i index;
+  size_t stride;
+};
+
+__attribute__((target("avx2"))) AVX2Window
+avx2_window(size_t stride, timestamp_t begin, timestamp_t end)
+{
+  AVX2Window w;
+  w.sign = _mm256_set1_epi64x(static_cast<int64_t>(uint64_t(1) << 63)); // NOLINT(build/unsigned)
+  w.begin = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(begin)), w.sign);
+  w.end = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(end)), w.sign);
+  auto s = static_cast<int64_t>(stride);
+  w.index = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+  w.stride = stride;
+  return w;
+}
+
+// -1 in each lane that's outside the window, 0 in each lane that's in it
+__attribute__((target("avx2"))) inline __m256i
+avx2_outside(const timestamp_t* times, const AVX2Window& w)
+{
+  __m256i t = w.stride == 1
+                ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(times))
+                : _mm256_i64gather_epi64(reinterpret_cast<const long long*>(times), w.index, 8); // NOLINT(runtime/int)
+  t = _mm256_xor_si256(t, w.sign);
+  return _mm256_or_si256(_mm256_cmpgt_epi64(t, w.end), _mm256_cmpgt_epi64(w.begin, t));
+}
+
+__attribute__((target("avx2"))) inline unsigned
+avx2_outside_bits(const timestamp_t* times, const AVX2Window& w)
+{
+  return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(avx2_outside(times, w))));
+}
+
+__attribute__((target("avx2"))) uint64_t // NOLINT(build/unsigned)
+avx2_mask(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  auto w = avx2_window(stride, begin, end);
+  uint64_t mask = 0; // NOLINT(build/unsigned)
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    mask |= uint64_t(~avx2_outside_bits(times + i * stride, w) & 0xf) << i; // NOLINT(build/unsigned)
+  }
+  if (i < n) {
+    mask |= scalar_mask(times + i * stride, stride, n - i, begin, end) << i;
+  }
+  return mask;
+}
+
+__attribute__((target("avx2"))) size_t
+avx2_count(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  auto w = avx2_window(stride, begin, end);
+  // Each lane counts down by one for each timestamp outside the window
+  __m256i outside = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    outside = _mm256_add_epi64(outside, avx2_outside(times + i * stride, w));
+  }
+  alignas(32) int64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), outside);
+  size_t n_outside = static_cast<size_t>(-(lanes[0] + lanes[1] + lanes[2] + lanes[3]));
+  return i - n_outside + scalar_count(times + i * stride, stride, n - i, begin, end);
+}
+
+__attribute__((target("avx2"))) size_t
+avx2_find_outside(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  auto w = avx2_window(stride, begin, end);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    if (unsigned bits = avx2_outside_bits(times + i * stride, w); bits != 0) {
+      return i + __builtin_ctz(bits);
+    }
+  }
+  return i + scalar_find_outside(times + i * stride, stride, n - i, begin, end);
+}
+
+constexpr Kernels s_avx2_kernels{ TimeWindowIsa::kAVX2, avx2_mask, avx2_count, avx2_find_outside };
+
+// AVX-512, eight timestamps at a time, with unsigned comparisons into
+// mask registers. The tail is done with masked loads
+
+struct AVX512Window
+{
+  __m512i begin;
+  __m512i end;
+  __m512i index;
+  size_t stride;
+};
+
+__attribute__((target("avx512f"))) AVX512Window
+avx512_window(size_t stride, timestamp_t begin, timestamp_t end)
+{
+  AVX512Window w;
+  w.begin = _mm512_set1_epi64(static_cast<int64_t>(begin));
+  w.end = _mm512_set1_epi64(static_cast<int64_t>(end));
+  auto s = static_cast<int64_t>(stride);
+  w.index = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+  w.stride = stride;
+  return w;
+}
+
+// A bit for each of the first n (at most 8) lanes that's in the window
+__attribute__((target("avx512f"))) inline __mmask8
+avx512_inside(const timestamp_t* times, const AVX512Window& w, size_t n = 8)
+{
+  __mmask8 valid = n >= 8 ? 0xff : static_cast<__mmask8>((1u << n) - 1);
+  __m512i t = w.stride == 1 ? _mm512_maskz_loadu_epi64(valid, times)
+                            : _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), valid, w.index, times, 8);
+  return _mm512_mask_cmp_epu64_mask(_mm512_mask_cmp_epu64_mask(valid, t, w.begin, _MM_CMPINT_NLT),
+                                    t,
+                                    w.end,
+                                    _MM_CMPINT_LE);
+}
+
+__attribute__((target("avx512f"))) uint64_t // NOLINT(build/unsigned)
+avx512_mask(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  auto w = avx512_window(stride, begin, end);
+  uint64_t mask = 0; // NOLINT(build/unsigned)
+  for (size_t i = 0; i < n; i += 8) {
+    mask |= uint64_t(avx512_inside(times + i * stride, w, n - i)) << i; // NOLINT(build/unsigned)
+  }
+  return mask;
+}
+
+__attribute__((target("avx512f"))) size_t
+avx512_count(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  auto w = avx512_window(stride, begin, end);
+  size_t count = 0;
+  for (size_t i = 0; i < n; i += 8) {
+    count += __builtin_popcount(avx512_inside(times + i * stride, w, n - i));
+  }
+  return count;
+}
+
+__attribute__((target("avx512f"))) size_t
+avx512_find_outside(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  auto w = avx512_window(stride, begin, end);
+  for (size_t i = 0; i < n; i += 8) {
+    size_t n_block = n - i < 8 ? n - i : 8;
+    unsigned outside = ~unsigned(avx512_inside(times + i * stride, w, n_block)) & ((1u << n_block) - 1);
+    if (outside != 0) {
+      return i + __builtin_ctz(outside);
+    }
+  }
+  return n;
+}
+
+constexpr Kernels s_avx512_kernels{ TimeWindowIsa::kAVX512, avx512_mask, avx512_count, avx512_find_outside };
+
+#endif // TRIGGER_TIME_WINDOW_X86
+
+const Kernels&
+get_kernels(TimeWindowIsa isa)
+{
+  switch (isa) {
+#ifdef TRIGGER_TIME_WINDOW_X86
+    case TimeWindowIsa::kAVX2:
+      return s_avx2_kernels;
+    case TimeWindowIsa::kAVX512:
+      return s_avx512_kernels;
+#endif
+    default:
+      return s_scalar_kernels;
+  }
+}
+
+TimeWindowIsa
+get_best_isa()
+{
+  for (auto isa : { TimeWindowIsa::kAVX512, TimeWindowIsa::kAVX2 }) {
+    if (is_time_window_isa_supported(isa)) {
+      return isa;
+    }
+  }
+  return TimeWindowIsa::kScalar;
+}
+
+// The kernels in use. This is constant-initialized, and the best kernels
+// are only chosen on first use, so that the kernels can be used from
+// other translation units' static initializers
+std::atomic<const Kernels*> s_kernels{ nullptr };
+
+const Kernels&
+kernels()
+{
+  const Kernels* current = s_kernels.load(std::memory_order_acquire);
+  if (current == nullptr) {
+    // Threads racing to get here all make the same choice, unless
+    // set_time_window_isa() has made one already, which wins
+    const Kernels* best = &get_kernels(get_best_isa());
+    current = s_kernels.compare_exchange_strong(current, best) ? best : current;
+  }
+  return *current;
+}
+
+} // namespace
+
+std::string
+get_time_window_isa_name(TimeWindowIsa isa)
+{
+  switch (isa) {
+    case TimeWindowIsa::kScalar:
+      return "scalar";
+    case TimeWindowIsa::kAVX2:
+      return "AVX2";
+    case TimeWindowIsa::kAVX512:
+      return "AVX-512";
+  }
+  return "unknown";
+}
+
+bool
+is_time_window_isa_supported(TimeWindowIsa isa)
+{
+  switch (isa) {
+    case TimeWindowIsa::kScalar:
+      return true;
+#ifdef TRIGGER_TIME_WINDOW_X86
+    case TimeWindowIsa::kAVX2:
+      // We may be called during static initialization, before the CPU has been probed
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+    case TimeWindowIsa::kAVX512:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+TimeWindowIsa
+get_time_window_isa()
+{
+  return kernels().isa;
+}
+
+bool
+set_time_window_isa(TimeWindowIsa isa)
+{
+  if (!is_time_window_isa_supported(isa)) {
+    return false;
+  }
+  s_kernels.store(&get_kernels(isa));
+  return true;
+}
+
+uint64_t // NOLINT(build/unsigned)
+time_window_mask(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  return kernels().mask(times, stride, n, begin, end);
+}
+
+size_t
+count_in_time_window(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  return kernels().count(times, stride, n, begin, end);
+}
+
+size_t
+find_outside_time_window(const timestamp_t* times, size_t stride, size_t n, timestamp_t begin, timestamp_t end)
+{
+  return kernels().find_outside(times, stride, n, begin, end);
+}
+
+size_t
+lower_bound_time(const timestamp_t* times, size_t stride, size_t n, timestamp_t t)
+{
+  // Branchless binary search down to a block small enough to count in
+  // one go, which is cheaper than the last few steps of the search
+  size_t first = 0;
+  while (n > 16) {
+    size_t half = n / 2;
+    first = times[(first + half - 1) * stride] < t ? first + half : first;
+    n -= half;
+  }
+  if (t == 0) {
+    return first;
+  }
+  return first + count_in_time_window(times + first * stride, stride, n, 0, t - 1);
+}
+
+} // namespace dunedaq::trigger
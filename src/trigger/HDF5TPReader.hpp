@@ -0,0 +1,121 @@
+/**
+ * @file HDF5TPReader.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_HDF5TPREADER_HPP_
+#define TRIGGER_SRC_TRIGGER_HDF5TPREADER_HPP_
+
+#include "trigger/TPSet.hpp"
+#include "trigger/TPSetAccumulator.hpp"
+
+#include "hdf5libs/HDF5RawDataFile.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief Streams TPSets from the TP fragments in an HDF5 raw data file
+ *
+ * Records are read one at a time by a background thread, and the TPs
+ * in the trigger primitive fragments from the selected source IDs are
+ * grouped into TPSets with a TPSetAccumulator. At most
+ * max_buffered_records records' worth of TPSets are held in memory, so
+ * files of any size can be replayed.
+ *
+ * The HDF5 library is not assumed to be thread-safe, so all access to
+ * HDF5 files from any HDF5TPReader is serialized
+ */
+class HDF5TPReader
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+
+  // An empty source_ids means fragments from every source ID are read.
+  // Throws BadTPReplayFile if the file can't be read or has no TPs
+  HDF5TPReader(const std::string& filename,
+               std::set<uint32_t> source_ids, // NOLINT(build/unsigned)
+               uint64_t tpset_time_width,     // NOLINT(build/unsigned)
+               uint64_t tpset_time_offset,    // NOLINT(build/unsigned)
+               size_t max_buffered_records);
+
+  ~HDF5TPReader();
+
+  HDF5TPReader(const HDF5TPReader&) = delete;
+  HDF5TPReader& operator=(const HDF5TPReader&) = delete;
+
+  // Start (or restart) reading from the beginning of the file. Does
+  // nothing once stopped, until restart() is called
+  void rewind();
+
+  // Move the next TPSet into tpset, waiting for it to be read if
+  // necessary. Returns false at the end of the file, or once stopped
+  bool next(TPSet& tpset);
+
+  // Stop reading ahead, so that the reader thread doesn't hold on to a
+  // full buffer between runs. next() returns false, and rewind() does
+  // nothing, until restart() is called. May be called from any thread
+  void stop();
+
+  // Let rewind() start reading again after stop()
+  void restart();
+
+  // Start times of the first and last TPSets in the file, found at construction
+  triggeralgs::timestamp_t get_first_start_time() const { return m_first_start_time; }
+  triggeralgs::timestamp_t get_last_start_time() const { return m_last_start_time; }
+
+  size_t get_n_records() const { return m_record_ids.size(); }
+  // TPs that were out of order by more than a TPSet and were dropped
+  size_t get_n_dropped() const { return m_n_dropped.load(); }
+  const std::string& get_filename() const { return m_filename; }
+
+private:
+  // Append the TPs in the selected fragments of the index'th record to tps
+  void read_record(size_t index, std::vector<TriggerPrimitive>& tps);
+  void reader_thread();
+
+  std::string m_filename;
+  std::set<uint32_t> m_source_ids; // NOLINT(build/unsigned)
+  size_t m_max_buffered_records;
+  std::unique_ptr<hdf5libs::HDF5RawDataFile> m_file;
+  std::vector<hdf5libs::HDF5RawDataFile::record_id_t> m_record_ids;
+
+  triggeralgs::timestamp_t m_first_start_time{ 0 };
+  triggeralgs::timestamp_t m_last_start_time{ 0 };
+
+  TPSetAccumulator m_accumulator;
+
+  // The TPSets from each record read ahead, and the position in the front one
+  std::mutex m_buffer_mutex;
+  std::condition_variable m_buffer_cv;
+  std::deque<std::vector<TPSet>> m_buffer;
+  size_t m_front_index{ 0 };
+  bool m_done{ false };
+  bool m_stop{ false };
+  // Set while rewind() ends the previous pass, which doesn't stop the reader
+  bool m_rewinding{ false };
+  std::atomic<size_t> m_n_dropped{ 0 };
+
+  // Held while m_thread is joined or replaced, by rewind() and stop()
+  std::mutex m_thread_mutex;
+  std::thread m_thread;
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_HDF5TPREADER_HPP_
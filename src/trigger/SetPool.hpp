@@ -0,0 +1,169 @@
+/**
+ * @file SetPool.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_SETPOOL_HPP_
+#define TRIGGER_SRC_TRIGGER_SETPOOL_HPP_
+
+#include "trigger/Set.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+// Counters of what a SetPool has done since it was created
+struct SetPoolStats
+{
+  uint64_t hits{ 0 };      // NOLINT(build/unsigned) acquire()s that got a recycled vector
+  uint64_t misses{ 0 };    // NOLINT(build/unsigned) acquire()s that found the pool empty
+  uint64_t released{ 0 };  // NOLINT(build/unsigned) release()s that kept the vector
+  uint64_t discarded{ 0 }; // NOLINT(build/unsigned) release()s that freed the vector because the pool was full or
+                           // the vector was too big
+  size_t pooled{ 0 };      // Vectors currently in the pool
+};
+
+inline std::ostream&
+operator<<(std::ostream& os, const SetPoolStats& stats)
+{
+  return os << stats.hits << " hits, " << stats.misses << " misses, " << stats.released << " released, "
+            << stats.discarded << " discarded, " << stats.pooled << " pooled";
+}
+
+/**
+ * @brief A process-wide pool of Set<T> objects vectors, so that Sets can be recycled with their capacity
+ *
+ * Producers acquire() a Set, fill it and send it on. Whoever is finally
+ * done with a Set release()s it, and its objects vector is kept, cleared
+ * but with its capacity, for the next acquire(). Sets passed by value
+ * through in-process queues keep their vectors, so a pipeline of
+ * modules in one application can run without allocating Sets once the
+ * pool has warmed up. A Set that's never released is simply freed as
+ * usual, so modules that don't use the pool still work
+ */
+template<class T>
+class SetPool
+{
+public:
+  using Stats = SetPoolStats;
+
+  // The pool shared by every module in the process
+  static SetPool& get()
+  {
+    static SetPool pool;
+    return pool;
+  }
+
+  SetPool() = default;
+
+  SetPool(const SetPool&) = delete;
+  SetPool& operator=(const SetPool&) = delete;
+  SetPool(SetPool&&) = delete;
+  SetPool& operator=(SetPool&&) = delete;
+
+  // A default-constructed Set whose objects vector has room for at least `capacity` objects
+  Set<T> acquire(size_t capacity = 0)
+  {
+    Set<T> set;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (!m_vectors.empty()) {
+        set.objects = std::move(m_vectors.back());
+        m_vectors.pop_back();
+      }
+    }
+    if (set.objects.capacity() > 0) {
+      ++m_hits;
+    } else {
+      ++m_misses;
+    }
+    set.objects.reserve(capacity);
+    return set;
+  }
+
+  // Give a Set's objects vector back to the pool. The set is left with an
+  // empty vector. Releasing a set that has already been moved from, or
+  // that never had any objects, does nothing
+  void release(Set<T>&& set) { release(std::move(set.objects)); }
+
+  void release(std::vector<T>&& objects)
+  {
+    std::vector<T> vec(std::move(objects));
+    objects.clear();
+    if (vec.capacity() == 0) {
+      return;
+    }
+    if (vec.capacity() > m_max_capacity.load(std::memory_order_relaxed)) {
+      ++m_discarded;
+      return;
+    }
+    vec.clear();
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (m_vectors.size() < m_max_pooled) {
+        m_vectors.push_back(std::move(vec));
+        ++m_released;
+        return;
+      }
+    }
+    // Over the limit: vec is freed here, outside the lock
+    ++m_discarded;
+  }
+
+  // Keep at most max_pooled vectors, and don't keep vectors with room for more than max_capacity objects
+  void set_limits(size_t max_pooled, size_t max_capacity)
+  {
+    m_max_capacity.store(max_capacity, std::memory_order_relaxed);
+    std::vector<std::vector<T>> excess;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_max_pooled = max_pooled;
+    while (m_vectors.size() > m_max_pooled) {
+      excess.push_back(std::move(m_vectors.back()));
+      m_vectors.pop_back();
+    }
+  }
+
+  Stats get_stats() const
+  {
+    Stats stats;
+    stats.hits = m_hits.load();
+    stats.misses = m_misses.load();
+    stats.released = m_released.load();
+    stats.discarded = m_discarded.load();
+    std::lock_guard<std::mutex> lk(m_mutex);
+    stats.pooled = m_vectors.size();
+    return stats;
+  }
+
+  // Free the pooled vectors
+  void clear()
+  {
+    std::vector<std::vector<T>> vectors;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    vectors.swap(m_vectors);
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  std::vector<std::vector<T>> m_vectors;
+  size_t m_max_pooled{ 1024 };
+  std::atomic<size_t> m_max_capacity{ 1 << 16 };
+
+  std::atomic<uint64_t> m_hits{ 0 };      // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_misses{ 0 };    // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_released{ 0 };  // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_discarded{ 0 }; // NOLINT(build/unsigned)
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_SETPOOL_HPP_
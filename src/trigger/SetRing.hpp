@@ -0,0 +1,292 @@
+/**
+ * @file SetRing.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_SETRING_HPP_
+#define TRIGGER_SRC_TRIGGER_SETRING_HPP_
+
+#include "trigger/TaskExecutor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief A bounded lock-free ring for passing objects between threads in one process
+ *
+ * Any number of threads can push(), and one thread pop()s. Objects are
+ * moved in and out of the slots, so a Set's objects vector goes from
+ * producer to consumer without being copied. Neither side takes a lock
+ * while the ring is neither empty nor full: a side only sleeps after it
+ * has spun for a while, and the other side only makes the system call to
+ * wake it if it's asleep, so under load there's no wakeup per object.
+ *
+ * The slot scheme is the bounded queue of D. Vyukov: each slot has a
+ * sequence number saying whether it's ready to be written or read at a
+ * given position
+ */
+template<class T>
+class SetRing
+{
+public:
+  using duration_t = std::chrono::milliseconds;
+
+  // The capacity is rounded up to a power of two
+  explicit SetRing(size_t capacity)
+  {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; ++i) {
+      m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  SetRing(const SetRing&) = delete;
+  SetRing& operator=(const SetRing&) = delete;
+  SetRing(SetRing&&) = delete;
+  SetRing& operator=(SetRing&&) = delete;
+
+  size_t capacity() const { return m_mask + 1; }
+
+  // Returns false, and leaves obj alone, if the ring is full
+  bool try_push(T&& obj)
+  {
+    size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &m_slots[pos & m_mask];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(obj);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    wake(m_consumer_waiting, m_not_empty);
+    if (auto* task = m_consumer_task.load(std::memory_order_acquire)) {
+      task->notify();
+    }
+    return true;
+  }
+
+  // Returns false, and leaves obj alone, if the ring is empty. Only one thread may pop
+  bool try_pop(T& obj)
+  {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[pos & m_mask];
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1) {
+      return false;
+    }
+    obj = std::move(slot.value);
+    slot.seq.store(pos + m_mask + 1, std::memory_order_release);
+    m_dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+    wake(m_producers_waiting, m_not_full);
+    return true;
+  }
+
+  // Wait up to timeout for room. Returns false, and leaves obj alone, if there was none
+  bool push(T&& obj, duration_t timeout)
+  {
+    if (try_push(std::move(obj))) {
+      return true;
+    }
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+      for (int i = 0; i < s_n_spins; ++i) {
+        std::this_thread::yield();
+        if (try_push(std::move(obj))) {
+          return true;
+        }
+      }
+      if (!wait(m_producers_waiting, m_not_full, deadline, [this] { return !full(); })) {
+        return try_push(std::move(obj));
+      }
+      if (try_push(std::move(obj))) {
+        return true;
+      }
+      // Another producer took the room
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+    }
+  }
+
+  // Wait up to timeout for an object. Returns false if there was none
+  bool pop(T& obj, duration_t timeout)
+  {
+    if (try_pop(obj)) {
+      return true;
+    }
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (int i = 0; i < s_n_spins; ++i) {
+      std::this_thread::yield();
+      if (try_pop(obj)) {
+        return true;
+      }
+    }
+    // Only the consumer pops, so once the ring isn't empty it stays that way until we pop
+    wait(m_consumer_waiting, m_not_empty, deadline, [this] { return !empty(); });
+    return try_pop(obj);
+  }
+
+  // Only exact when called from the consumer
+  bool empty() const
+  {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    return m_slots[pos & m_mask].seq.load(std::memory_order_acquire) != pos + 1;
+  }
+
+  bool full() const
+  {
+    size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    return m_slots[pos & m_mask].seq.load(std::memory_order_acquire) != pos;
+  }
+
+  // Notify task after every push, for a consumer run by a TaskExecutor
+  // rather than waiting in pop(). nullptr for none. The task must live
+  // until the producers can no longer push
+  void set_consumer_task(TaskExecutor::Task* task) { m_consumer_task.store(task, std::memory_order_release); }
+
+private:
+  struct alignas(64) Slot
+  {
+    std::atomic<size_t> seq{ 0 };
+    T value{};
+  };
+
+  // How many times a side yields before it goes to sleep
+  static constexpr int s_n_spins = 64;
+
+  // Called after publishing a change the other side might be waiting for.
+  // The fence orders our change before the read of waiting, and pairs
+  // with the increment of waiting in wait(), so that either we see the
+  // waiter or the waiter sees our change
+  void wake(std::atomic<int>& waiting, std::condition_variable& cv)
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      cv.notify_all();
+    }
+  }
+
+  template<class Predicate>
+  bool wait(std::atomic<int>& waiting,
+            std::condition_variable& cv,
+            std::chrono::steady_clock::time_point deadline,
+            Predicate ready)
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    waiting.fetch_add(1, std::memory_order_seq_cst);
+    bool ok = cv.wait_until(lk, deadline, ready);
+    waiting.fetch_sub(1, std::memory_order_relaxed);
+    return ok;
+  }
+
+  std::unique_ptr<Slot[]> m_slots;
+  size_t m_mask;
+
+  alignas(64) std::atomic<size_t> m_enqueue_pos{ 0 };
+  alignas(64) std::atomic<size_t> m_dequeue_pos{ 0 };
+
+  alignas(64) std::atomic<int> m_consumer_waiting{ 0 };
+  std::atomic<int> m_producers_waiting{ 0 };
+  std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+
+  std::atomic<TaskExecutor::Task*> m_consumer_task{ nullptr };
+};
+
+/**
+ * @brief The SetRings of the process, by the uid of the connection they replace
+ *
+ * A consumer module that's configured to take its input locally attaches
+ * a ring to its input connection's uid when it's configured. Producer
+ * modules look for a ring on their output connection's uid when they
+ * start, which is after every module has been configured, and send
+ * through it instead of through the connection if there is one.
+ * So every producer feeding a connection with a ring must be a module
+ * that looks for it.
+ *
+ * A consumer that only reads its input can attach a ring of
+ * std::shared_ptr<const T> instead, so that a producer that sends the same
+ * object to several consumers, like a Tee, doesn't have to copy it for each
+ */
+template<class T>
+class SetRingRegistry
+{
+public:
+  static constexpr size_t s_default_capacity = 1024;
+
+  // The ring for uid, made if there isn't one yet
+  static std::shared_ptr<SetRing<T>> attach_consumer(const std::string& uid, size_t capacity = s_default_capacity)
+  {
+    auto& reg = get();
+    std::lock_guard<std::mutex> lk(reg.mutex);
+    auto& ring = reg.rings[uid];
+    if (!ring) {
+      ring = std::make_shared<SetRing<T>>(capacity);
+    }
+    return ring;
+  }
+
+  // The ring for uid, or nullptr if no consumer has attached one
+  static std::shared_ptr<SetRing<T>> find(const std::string& uid)
+  {
+    auto& reg = get();
+    std::lock_guard<std::mutex> lk(reg.mutex);
+    auto it = reg.rings.find(uid);
+    return it == reg.rings.end() ? nullptr : it->second;
+  }
+
+  // Stop producers that start from now on from finding the ring for uid
+  static void detach_consumer(const std::string& uid)
+  {
+    auto& reg = get();
+    std::lock_guard<std::mutex> lk(reg.mutex);
+    reg.rings.erase(uid);
+  }
+
+private:
+  struct Registry
+  {
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<SetRing<T>>> rings;
+  };
+
+  static Registry& get()
+  {
+    static Registry registry;
+    return registry;
+  }
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_SETRING_HPP_
@@ -0,0 +1,66 @@
+/**
+ * @file SpeedProfile.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_SPEEDPROFILE_HPP_
+#define TRIGGER_SRC_TRIGGER_SPEEDPROFILE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief A replay speed factor that varies with wall-clock time since the start of a replay
+ *
+ * A speed factor of 2 means that data time passes twice as fast as
+ * wall-clock time. The profile is a sequence of steps, in each of
+ * which the speed factor changes linearly from its start value to its
+ * end value. After the last step, the last step's end value is held.
+ * The steps are also the intervals over which replay statistics are
+ * reported, so a linear ramp is split into several steps
+ */
+class SpeedProfile
+{
+public:
+  using duration = std::chrono::steady_clock::duration;
+
+  struct Step
+  {
+    double start_factor;
+    double end_factor;
+    duration length;
+  };
+
+  // A constant speed factor
+  explicit SpeedProfile(double speed_factor = 1.0);
+
+  explicit SpeedProfile(std::vector<Step> steps);
+
+  // A ramp from start_factor to end_factor over length, split into n_steps equal steps
+  static SpeedProfile linear_ramp(double start_factor, double end_factor, duration length, size_t n_steps);
+
+  // The index of the step that elapsed falls in. Times after the
+  // end of the profile are in step get_n_steps()-1
+  size_t get_step_index(duration elapsed) const;
+
+  double get_speed_factor(duration elapsed) const;
+
+  // The number of steps, including the final open-ended one that holds the last speed factor
+  size_t get_n_steps() const { return m_steps.size(); }
+
+  // The index'th step. The final step's length is zero, meaning it never ends
+  const Step& get_step(size_t index) const { return m_steps.at(index); }
+
+private:
+  std::vector<Step> m_steps;
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_SPEEDPROFILE_HPP_
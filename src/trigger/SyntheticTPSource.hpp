@@ -0,0 +1,111 @@
+/**
+ * @file SyntheticTPSource.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_SYNTHETICTPSOURCE_HPP_
+#define TRIGGER_SRC_TRIGGER_SYNTHETICTPSOURCE_HPP_
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief Generates a deterministic, endless stream of synthetic TPs
+ *
+ * The TPs are a mixture of:
+ *
+ *  - Noise: independent Poisson-distributed hits on each channel
+ *  - Bursts: periods in which the noise rate is multiplied
+ *  - Clusters: groups of hits close together in channel and time
+ *  - Tracks: lines of hits, one per channel on consecutive channels
+ *
+ * Bursts, clusters and tracks start at Poisson-distributed times.
+ * TPs are generated one time window at a time, with generate(), and
+ * the same seed always gives the same TPs for the same windows
+ */
+class SyntheticTPSource
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+  using timestamp_t = triggeralgs::timestamp_t;
+
+  struct Params
+  {
+    uint32_t first_channel{ 0 }; // NOLINT(build/unsigned)
+    uint32_t n_channels{ 1 };    // NOLINT(build/unsigned)
+    uint16_t detid{ 0 };         // NOLINT(build/unsigned)
+    double clock_frequency_hz{ 50'000'000 };
+
+    double noise_rate_hz{ 0 }; // per channel
+
+    double burst_rate_hz{ 0 };
+    timestamp_t burst_duration_ticks{ 0 };
+    double burst_noise_factor{ 1 };
+
+    double cluster_rate_hz{ 0 };
+    double cluster_mean_n_tps{ 0 };
+    uint32_t cluster_channel_spread{ 1 }; // NOLINT(build/unsigned)
+    timestamp_t cluster_time_spread_ticks{ 1 };
+
+    double track_rate_hz{ 0 };
+    uint32_t track_n_channels{ 1 }; // NOLINT(build/unsigned)
+    timestamp_t track_ticks_per_channel{ 0 };
+
+    uint64_t seed{ 0 }; // NOLINT(build/unsigned)
+  };
+
+  // Generate TPs from start_time onwards
+  SyntheticTPSource(const Params& params, timestamp_t start_time);
+
+  // Append the TPs with time_start in [ window_start, window_end ) to
+  // tps, in time_start order. Windows must be contiguous: each call's
+  // window_start is the previous call's window_end
+  void generate(timestamp_t window_start, timestamp_t window_end, std::vector<TriggerPrimitive>& tps);
+
+  // Counts of what has been generated so far
+  size_t get_n_bursts() const { return m_n_bursts; }
+  size_t get_n_clusters() const { return m_n_clusters; }
+  size_t get_n_tracks() const { return m_n_tracks; }
+
+private:
+  // The time of the next event of a Poisson process with the given rate, after `after`
+  timestamp_t next_event_time(double rate_hz, timestamp_t after);
+  void add_noise(timestamp_t start, timestamp_t end, double rate_factor, std::vector<TriggerPrimitive>& tps);
+  void add_cluster(timestamp_t time);
+  void add_track(timestamp_t time);
+  TriggerPrimitive make_tp(timestamp_t time,
+                           uint32_t channel, // NOLINT(build/unsigned)
+                           timestamp_t time_over_threshold,
+                           uint16_t adc_peak) const; // NOLINT(build/unsigned)
+
+  Params m_params;
+  std::mt19937_64 m_gen;
+
+  timestamp_t m_next_burst_start;
+  timestamp_t m_burst_end{ 0 };
+  timestamp_t m_next_cluster;
+  timestamp_t m_next_track;
+
+  // TPs from clusters and tracks that have started but are not yet
+  // all in a window, in the order they were made. A cluster's TPs aren't
+  // in time order, so generate() sorts each window's TPs once it has them
+  std::vector<TriggerPrimitive> m_pending;
+
+  size_t m_n_bursts{ 0 };
+  size_t m_n_clusters{ 0 };
+  size_t m_n_tracks{ 0 };
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_SYNTHETICTPSOURCE_HPP_
@@ -0,0 +1,140 @@
+/**
+ * @file TCLoadProfile.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_TCLOADPROFILE_HPP_
+#define TRIGGER_SRC_TRIGGER_TCLOADPROFILE_HPP_
+
+#include "triggeralgs/TriggerCandidate.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief Generates a deterministic sequence of TCs for load testing the MLT and dataflow
+ *
+ * The TCs come from two kinds of source, merged in time_candidate order:
+ *
+ *  - A background whose rate ramps linearly from start_rate_hz to
+ *    end_rate_hz over ramp_duration_s of data time, and is held at
+ *    end_rate_hz after that. The TCs are evenly spaced or Poisson
+ *    distributed
+ *  - Trains: every period_s, n_tcs TCs spaced spacing_ticks apart. A
+ *    train whose window_ticks is larger than its spacing_ticks is a
+ *    storm of overlapping TCs. A train must end before the next one
+ *    starts, ie period_s must be at least n_tcs * spacing_ticks
+ *
+ * Each TC's type is drawn from a weighted mixture, and its readout
+ * window length from a configurable distribution. Its algorithm is
+ * kCustom, so that it can't be mistaken for a TC from a real source. The
+ * same seed always gives the same TCs
+ */
+class TCLoadProfile
+{
+public:
+  using TriggerCandidate = triggeralgs::TriggerCandidate;
+  using timestamp_t = triggeralgs::timestamp_t;
+
+  enum class WindowDistribution
+  {
+    kFixed,      // Always window_ticks
+    kUniform,    // Uniform in [ min_window_ticks, max_window_ticks ]
+    kExponential // Mean window_ticks, clamped to [ min_window_ticks, max_window_ticks ]
+  };
+
+  struct TypeWeight
+  {
+    TriggerCandidate::Type type;
+    double weight;
+  };
+
+  struct Train
+  {
+    double start_s{ 0 }; // Data time of the first train, after the start of the profile
+    double period_s{ 1 };
+    uint32_t n_tcs{ 1 };           // NOLINT(build/unsigned)
+    timestamp_t spacing_ticks{ 0 };
+    timestamp_t window_ticks{ 0 }; // 0 means the window length is drawn as for the background
+  };
+
+  struct Params
+  {
+    double clock_frequency_hz{ 50'000'000 };
+
+    double start_rate_hz{ 1 };
+    double end_rate_hz{ 1 };
+    double ramp_duration_s{ 0 };
+    bool poisson{ true };
+
+    // Empty means every TC is kRandom
+    std::vector<TypeWeight> type_mix;
+
+    WindowDistribution window_distribution{ WindowDistribution::kFixed };
+    timestamp_t window_ticks{ 0 };
+    timestamp_t min_window_ticks{ 0 };
+    timestamp_t max_window_ticks{ 0 };
+    // The fraction of the window before time_candidate
+    double window_pre_fraction{ 0.5 };
+
+    std::vector<Train> trains;
+
+    uint64_t seed{ 0 }; // NOLINT(build/unsigned)
+  };
+
+  // Why params can't be used, or empty if they can. The constructor
+  // doesn't check, so call this first
+  static std::string check_params(const Params& params);
+
+  // Generate TCs from start_time onwards
+  TCLoadProfile(const Params& params, timestamp_t start_time);
+
+  // The next TC. TCs are returned in time_candidate order. If the
+  // background rate is zero and there are no trains, the TC's
+  // time_candidate is the maximum timestamp
+  TriggerCandidate next();
+
+  // The background rate at the given data time
+  double get_rate_hz(timestamp_t time) const;
+
+  // Counts of what has been generated so far
+  size_t get_n_background() const { return m_n_background; }
+  size_t get_n_train_tcs() const { return m_n_train_tcs; }
+
+private:
+  struct TrainState
+  {
+    timestamp_t train_start;
+    timestamp_t next_time;
+    uint32_t index_in_train{ 0 }; // NOLINT(build/unsigned)
+  };
+
+  timestamp_t next_background_time(timestamp_t after);
+  timestamp_t draw_window_ticks();
+  TriggerCandidate::Type draw_type();
+  TriggerCandidate make_candidate(timestamp_t time, timestamp_t window_ticks);
+
+  Params m_params;
+  timestamp_t m_start_time;
+  std::mt19937_64 m_gen;
+  std::discrete_distribution<size_t> m_type_dist;
+
+  timestamp_t m_next_background;
+  std::vector<TrainState> m_train_states;
+
+  size_t m_n_background{ 0 };
+  size_t m_n_train_tcs{ 0 };
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_TCLOADPROFILE_HPP_
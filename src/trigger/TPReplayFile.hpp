@@ -0,0 +1,161 @@
+/**
+ * @file TPReplayFile.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_TPREPLAYFILE_HPP_
+#define TRIGGER_SRC_TRIGGER_TPREPLAYFILE_HPP_
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+#include "detdataformats/trigger/Types.hpp"
+#include "trigger/ThreadPlacement.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+// Binary TP replay file layout:
+//
+//   TPReplayFileHeader
+//   n_tps * TriggerPrimitive, sorted by time_start
+//   n_sets * TPReplayFileSet, the TPSet index
+//
+// The TPs are stored exactly as they are laid out in memory, so the
+// reader can hand out pointers directly into the mapped file. The
+// index records the TPSet boundaries for the tpset_time_width and
+// tpset_time_offset in the header. A reader configured with different
+// values rebuilds the index by binary search over the TP array, which
+// is still much cheaper than reading the whole file
+struct TPReplayFileHeader
+{
+  static constexpr uint64_t s_magic = 0x46525054454e5544; // "DUNETPRF", little-endian NOLINT(build/unsigned)
+  static constexpr uint32_t s_version = 1;                 // NOLINT(build/unsigned)
+
+  uint64_t magic{ s_magic };                                     // NOLINT(build/unsigned)
+  uint32_t version{ s_version };                                 // NOLINT(build/unsigned)
+  uint32_t tp_size{ sizeof(detdataformats::trigger::TriggerPrimitive) }; // NOLINT(build/unsigned)
+  uint64_t n_tps{ 0 };                                           // NOLINT(build/unsigned)
+  uint64_t n_sets{ 0 };                                          // NOLINT(build/unsigned)
+  uint64_t tpset_time_width{ 0 };                                // NOLINT(build/unsigned)
+  uint64_t tpset_time_offset{ 0 };                               // NOLINT(build/unsigned)
+  uint64_t tps_offset{ 0 };   // Byte offset of the TP array NOLINT(build/unsigned)
+  uint64_t index_offset{ 0 }; // Byte offset of the TPSet index NOLINT(build/unsigned)
+};
+
+// One entry in the TPSet index: the TPSet start time and the range of
+// TPs in the TP array that belong to it
+struct TPReplayFileSet
+{
+  uint64_t start_time{ 0 }; // NOLINT(build/unsigned)
+  uint64_t first_tp{ 0 };   // NOLINT(build/unsigned)
+  uint64_t n_tps{ 0 };      // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief Writes a binary TP replay file from a time-ordered sequence of TPs
+ *
+ * TPs are streamed to disk as they are added, and only the (small)
+ * TPSet index is kept in memory until close()
+ */
+class TPReplayFileWriter
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+  using timestamp_t = detdataformats::trigger::timestamp_t;
+
+  TPReplayFileWriter(const std::string& filename, timestamp_t tpset_time_width, timestamp_t tpset_time_offset);
+  ~TPReplayFileWriter();
+
+  TPReplayFileWriter(TPReplayFileWriter const&) = delete;
+  TPReplayFileWriter(TPReplayFileWriter&&) = delete;
+  TPReplayFileWriter& operator=(TPReplayFileWriter const&) = delete;
+  TPReplayFileWriter& operator=(TPReplayFileWriter&&) = delete;
+
+  // Append a TP to the file. Returns false, and drops the TP, if its
+  // time_start is earlier than that of the previous TP
+  bool add(const TriggerPrimitive& tp);
+
+  // Write the TPSet index and the final header. Called by the destructor if needed
+  void close();
+
+  uint64_t get_n_tps() const { return m_header.n_tps; }           // NOLINT(build/unsigned)
+  uint64_t get_n_sets() const { return m_index.size(); }          // NOLINT(build/unsigned)
+
+private:
+  std::string m_filename;
+  std::ofstream m_file;
+  TPReplayFileHeader m_header;
+  std::vector<TPReplayFileSet> m_index;
+  timestamp_t m_prev_time_start{ 0 };
+};
+
+/**
+ * @brief Read-only, memory-mapped view of a binary TP replay file
+ *
+ * Opening the file only maps it and reads the header and index: TPs are
+ * paged in by the kernel as they are accessed, so memory use is bounded
+ * by the page cache rather than by the file size
+ */
+class TPReplayFile
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+  using timestamp_t = detdataformats::trigger::timestamp_t;
+
+  explicit TPReplayFile(const std::string& filename);
+  ~TPReplayFile();
+
+  TPReplayFile(TPReplayFile const&) = delete;
+  TPReplayFile(TPReplayFile&&) = delete;
+  TPReplayFile& operator=(TPReplayFile const&) = delete;
+  TPReplayFile& operator=(TPReplayFile&&) = delete;
+
+  // Set up the TPSet boundaries to be returned by get_set(). Uses the
+  // index stored in the file if it was written with the same width and
+  // offset, otherwise rebuilds it from the TP array
+  void index_sets(timestamp_t tpset_time_width, timestamp_t tpset_time_offset);
+
+  // Copy the TPs and index out of the file into a buffer of huge pages
+  // on numa_node, and close the file, so that replay doesn't take page
+  // faults or TLB misses. Memory use becomes the size of the file
+  void load_into_memory(int numa_node);
+
+  // Where the TPs are read from, for the log
+  std::string describe_memory() const;
+
+  size_t get_n_sets() const { return m_sets.size(); }
+  const TPReplayFileSet& get_set(size_t i) const { return m_sets[i]; }
+
+  uint64_t get_n_tps() const { return m_header.n_tps; } // NOLINT(build/unsigned)
+
+  // Pointer to the first TP of the set. The set's TPs are contiguous
+  const TriggerPrimitive* get_tps(const TPReplayFileSet& set) const { return m_tps + set.first_tp; }
+
+  const std::string& get_filename() const { return m_filename; }
+
+private:
+  std::string m_filename;
+  int m_fd{ -1 };
+  void* m_mapping{ nullptr };
+  size_t m_mapping_size{ 0 };
+
+  TPReplayFileHeader m_header;
+  const TriggerPrimitive* m_tps{ nullptr };
+  const TPReplayFileSet* m_stored_index{ nullptr };
+  // Holds the TPs and index instead of the mapping, after load_into_memory()
+  std::unique_ptr<HugePageBuffer> m_buffer;
+
+  std::vector<TPReplayFileSet> m_sets;
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_TPREPLAYFILE_HPP_
@@ -0,0 +1,70 @@
+/**
+ * @file TPSetAccumulator.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_TPSETACCUMULATOR_HPP_
+#define TRIGGER_SRC_TRIGGER_TPSETACCUMULATOR_HPP_
+
+#include "trigger/TPSet.hpp"
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief Groups TPs that arrive in batches into TPSets with fixed time boundaries
+ *
+ * TPSets have time boundaries ( n*width + offset ), and TPs are placed
+ * in TPSets based on the TP start time, as in TriggerPrimitiveMaker's
+ * text input. TPs within a batch, and between neighbouring batches,
+ * needn't be in order: a TPSet is only emitted once a later TPSet has
+ * received TPs. TPs that arrive for a TPSet that has already been
+ * emitted are dropped and counted
+ */
+class TPSetAccumulator
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+
+  TPSetAccumulator(uint64_t width, uint64_t offset); // NOLINT(build/unsigned)
+
+  void add(const TriggerPrimitive* tps, size_t n_tps);
+
+  // Append every TPSet before the latest one that has TPs to sets.
+  // Empty TPSets are not emitted
+  void emit_complete(std::vector<TPSet>& sets);
+
+  // Append all of the remaining TPSets to sets
+  void flush(std::vector<TPSet>& sets);
+
+  // Discard any pending TPs and start again from the beginning of time
+  void reset();
+
+  size_t get_n_dropped() const { return m_n_dropped; }
+
+private:
+  uint64_t set_number(const TriggerPrimitive& tp) const; // NOLINT(build/unsigned)
+  // Append the TPSets before set number `end` to sets
+  void emit_before(uint64_t end, std::vector<TPSet>& sets); // NOLINT(build/unsigned)
+
+  uint64_t m_width;  // NOLINT(build/unsigned)
+  uint64_t m_offset; // NOLINT(build/unsigned)
+
+  std::vector<TriggerPrimitive> m_pending;
+  // TPs in sets before this one have already been emitted
+  uint64_t m_next_set_number{ 0 }; // NOLINT(build/unsigned)
+  uint64_t m_latest_set_number{ 0 }; // NOLINT(build/unsigned)
+  size_t m_n_dropped{ 0 };
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_TPSETACCUMULATOR_HPP_
@@ -0,0 +1,65 @@
+/**
+ * @file TPTextReader.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_SRC_TRIGGER_TPTEXTREADER_HPP_
+#define TRIGGER_SRC_TRIGGER_TPTEXTREADER_HPP_
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace dunedaq::trigger {
+
+/**
+ * @brief Reads TPs from the whitespace-separated text format used by TriggerPrimitiveMaker
+ *
+ * Each TP is eight fields: time_start, time_over_threshold, time_peak,
+ * channel, adc_integral, adc_peak, detid and type. The file is read in
+ * large chunks and the fields are parsed with std::from_chars, which is
+ * several times faster than iostream extraction. As with iostream
+ * extraction, reading stops at the first field that can't be parsed
+ */
+class TPTextReader
+{
+public:
+  using TriggerPrimitive = detdataformats::trigger::TriggerPrimitive;
+
+  static constexpr size_t s_default_chunk_size = 4 << 20;
+
+  explicit TPTextReader(const std::string& filename, size_t chunk_size = s_default_chunk_size);
+
+  // Whether the file was opened successfully
+  bool is_open() const { return m_file.is_open(); }
+
+  // Read the next TP into tp. Returns false at the end of the file or on a parse error
+  bool next(TriggerPrimitive& tp);
+
+  size_t get_bytes_read() const { return m_bytes_read; }
+
+private:
+  // Find the next whitespace-delimited token, reading more of the file as needed
+  bool next_token(const char*& begin, const char*& end);
+  template<class T>
+  bool parse_field(T& value);
+  // Move any unconsumed bytes to the front of the buffer and fill the rest from the file
+  bool refill();
+
+  std::ifstream m_file;
+  std::vector<char> m_buffer;
+  size_t m_pos{ 0 };
+  size_t m_end{ 0 };
+  bool m_eof{ false };
+  size_t m_bytes_read{ 0 };
+};
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_SRC_TRIGGER_TPTEXTREADER_HPP_
@@ -11,11 +11,13 @@
 
 #include "trigger/Issues.hpp"
 #include "trigger/Set.hpp"
+#include "trigger/SetPool.hpp"
 
 #include "logging/Logging.hpp"
 
 #include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace dunedaq::trigger {
@@ -43,13 +45,13 @@ public:
   {
     if (m_buffer.size() == 0 || m_buffer.back().start_time == in.start_time) {
       // if `in` is the current time slice
-      m_buffer.emplace_back(in);
+      m_buffer.emplace_back(std::move(in));
       return false; // buffer the time slice
     }
     // obtain the current (complete) time slice
     flush(time_slice, start_time, end_time);
     // add `in`, which is the next time slice
-    m_buffer.emplace_back(in);
+    m_buffer.emplace_back(std::move(in));
     return true;
   }
   // Fill time_slice with the sorted buffer, clear the buffer, and return true
@@ -67,6 +69,8 @@ public:
         ers::warning(InconsistentSetTimeError(ERS_HERE, m_name, m_algorithm));
       }
       time_slice.insert(time_slice.end(), x.objects.begin(), x.objects.end());
+      // we're the last user of the set, so its vector can be reused upstream
+      SetPool<T>::get().release(std::move(x.objects));
     }
     // clear the buffer
     m_buffer.clear();
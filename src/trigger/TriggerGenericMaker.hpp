@@ -11,12 +11,20 @@
 
 #include "trigger/Issues.hpp"
 #include "trigger/Set.hpp"
+#include "trigger/SetPool.hpp"
+#include "trigger/SetRing.hpp"
+#include "trigger/TaskExecutor.hpp"
+#include "trigger/ThreadPlacement.hpp"
+#include "trigger/WireFormatSender.hpp"
+#include "trigger/TPSetSoA.hpp"
 #include "trigger/TimeSliceInputBuffer.hpp"
 #include "trigger/TimeSliceOutputBuffer.hpp"
+#include "trigger/triggergenericmakerinfo/InfoNljs.hpp"
 
 #include "appfwk/DAQModule.hpp"
 #include "appfwk/DAQModuleHelper.hpp"
 #include "daqdataformats/SourceID.hpp"
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
 #include "detdataformats/trigger/Types.hpp"
 #include "iomanager/IOManager.hpp"
 #include "iomanager/Receiver.hpp"
@@ -25,8 +33,11 @@
 #include "utilities/WorkerThread.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace dunedaq::trigger {
@@ -50,7 +61,6 @@ public:
     : DAQModule(name)
     , m_thread(std::bind(&TriggerGenericMaker::do_work, this, std::placeholders::_1))
     , m_input_queue(nullptr)
-    , m_output_queue(nullptr)
     , m_queue_timeout(100)
     , m_algorithm_name("[uninitialized]")
     , m_sourceid(dunedaq::daqdataformats::SourceID::s_invalid_id)
@@ -61,9 +71,10 @@ public:
     register_command("start", &TriggerGenericMaker::do_start);
     register_command("stop", &TriggerGenericMaker::do_stop);
     register_command("conf", &TriggerGenericMaker::do_configure);
+    register_command("scrap", &TriggerGenericMaker::do_scrap);
   }
 
-  virtual ~TriggerGenericMaker() {}
+  virtual ~TriggerGenericMaker() { detach_input_ring(); }
 
   TriggerGenericMaker(const TriggerGenericMaker&) = delete;
   TriggerGenericMaker& operator=(const TriggerGenericMaker&) = delete;
@@ -72,8 +83,19 @@ public:
 
   void init(const nlohmann::json& obj) override
   {
-    m_input_queue = get_iom_receiver<IN>(appfwk::connection_uid(obj, "input"));
-    m_output_queue = get_iom_sender<OUT>(appfwk::connection_uid(obj, "output"));
+    m_input_uid = appfwk::connection_uid(obj, "input");
+    m_output_uid = appfwk::connection_uid(obj, "output");
+    m_input_queue = get_iom_receiver<IN>(m_input_uid);
+    m_output_queue = WireFormatSender<OUT>(get_iom_sender<OUT>(m_output_uid), wire_format_t::kMsgPack);
+  }
+
+  void get_info(opmonlib::InfoCollector& ci, int /*level*/) override
+  {
+    triggergenericmakerinfo::Info info;
+    info.received_count = m_received_count.load();
+    info.sent_count = m_sent_count.load();
+    info.cpu_time_us = std::chrono::duration_cast<std::chrono::microseconds>(get_run_cpu_time()).count();
+    ci.add(info);
   }
 
 protected:
@@ -85,6 +107,24 @@ protected:
     m_sourceid = element_id;
   }
 
+  // Whether the conf command asks for the input to come from a SetRing
+  // rather than the input connection. Makers with a local_input option override this
+  virtual bool use_local_input(const nlohmann::json& /*obj*/) const { return false; }
+
+  // Whether the conf command asks for the work to be run as a task by
+  // the process's TaskExecutor rather than by a thread of our own. Makers
+  // with a use_executor option override this
+  virtual bool use_executor(const nlohmann::json& /*obj*/) const { return false; }
+
+  // Where the conf command asks for our thread to run. Makers with cpus
+  // and numa_node options override this
+  virtual ThreadPlacement get_thread_placement(const nlohmann::json& /*obj*/) const { return {}; }
+
+  using wire_format_t = typename WireFormatSender<OUT>::format_t;
+  // How the output is serialized if it's a network connection. Makers
+  // with an output_wire_format option override this
+  virtual wire_format_t get_output_wire_format(const nlohmann::json& /*obj*/) const { return wire_format_t::kMsgPack; }
+
   // Only applies to makers that output Set<B>
   void set_windowing(daqdataformats::timestamp_t window_time, daqdataformats::timestamp_t buffer_time)
   {
@@ -95,17 +135,42 @@ protected:
 private:
   dunedaq::utilities::WorkerThread m_thread;
 
-  size_t m_received_count;
-  size_t m_sent_count;
+  std::atomic<size_t> m_received_count{ 0 };
+  std::atomic<size_t> m_sent_count{ 0 };
 
   using source_t = dunedaq::iomanager::ReceiverConcept<IN>;
   std::shared_ptr<source_t> m_input_queue;
 
-  using sink_t = dunedaq::iomanager::SenderConcept<OUT>;
-  std::shared_ptr<sink_t> m_output_queue;
+  WireFormatSender<OUT> m_output_queue;
 
   std::chrono::milliseconds m_queue_timeout;
 
+  // How often an idle task polls an input connection, which can't notify
+  // it. A task that found input runs again straight away, so this only
+  // adds latency to the first input after a quiet spell
+  static constexpr std::chrono::milliseconds s_task_poll_interval{ 5 };
+  // The most inputs a task processes in one run, so that the others on its thread get a turn
+  static constexpr size_t s_task_batch_size = 16;
+  // How many inputs our own thread processes between updates of m_run_cpu_ns
+  static constexpr size_t s_cpu_time_update_interval = 64;
+
+  bool m_use_executor{ false };
+  ThreadPlacement m_placement;
+  // Made the first time it's needed, and kept, since a ring may still notify it after a stop
+  std::shared_ptr<TaskExecutor::Task> m_task;
+  std::atomic<bool> m_task_running{ false };
+  // For get_info(): the task's CPU time when the run started, and the CPU
+  // time of the run so far, which is updated by our own thread as it
+  // goes, or set from the task's when it stops
+  std::atomic<int64_t> m_task_cpu_ns_at_start{ 0 };
+  std::atomic<int64_t> m_run_cpu_ns{ 0 };
+
+  // Used instead of the queues when the modules at both ends are in this process
+  std::string m_input_uid;
+  std::string m_output_uid;
+  std::shared_ptr<SetRing<IN>> m_input_ring;
+  std::shared_ptr<SetRing<OUT>> m_output_ring;
+
   std::string m_algorithm_name;
 
   uint32_t m_sourceid; // NOLINT(build/unsigned)
@@ -126,12 +191,56 @@ private:
   {
     m_received_count = 0;
     m_sent_count = 0;
+    m_run_cpu_ns = 0;
     m_maker = make_maker(m_maker_conf);
     worker.reconfigure();
-    m_thread.start_working_thread(get_name());
+    // Every module has been configured by now, so if our consumer takes its input locally, its ring exists
+    m_output_ring = SetRingRegistry<OUT>::find(m_output_uid);
+    if (m_output_ring) {
+      TLOG() << get_name() << ": Sending to " << m_output_uid << " through a local ring";
+    }
+    if (!m_use_executor) {
+      if (m_input_ring) {
+        m_input_ring->set_consumer_task(nullptr);
+      }
+      m_thread.start_working_thread(get_name());
+      return;
+    }
+    if (!m_placement.is_default()) {
+      TLOG() << get_name() << ": Ignoring the thread placement, since the executor's threads are shared";
+    }
+    // A ring notifies the task when there's input, so it only needs polling as a fallback
+    auto& executor = TaskExecutor::get();
+    if (!m_task) {
+      m_task = executor.make_task(get_name(), [this] { return run_task(); }, s_task_poll_interval);
+    }
+    if (m_input_ring) {
+      m_input_ring->set_consumer_task(m_task.get());
+    }
+    m_task->set_poll_interval(m_input_ring ? m_queue_timeout : s_task_poll_interval);
+    m_task_cpu_ns_at_start = m_task->get_stats().cpu_time.count();
+    executor.start_task(*m_task);
+    m_task_running = true;
+    TLOG() << get_name() << ": Running as a task on the shared executor, which has " << executor.n_threads()
+           << " threads";
   }
 
-  void do_stop(const nlohmann::json& /*obj*/) { m_thread.stop_working_thread(); }
+  void do_stop(const nlohmann::json& /*obj*/)
+  {
+    if (!m_task_running) {
+      m_thread.stop_working_thread();
+      return;
+    }
+    // As do_work() does, process what's left of the input before finishing
+    TaskExecutor::get().stop_task(*m_task);
+    m_run_cpu_ns = get_run_cpu_time().count();
+    m_task_running = false;
+    IN in;
+    while (receive(in, std::chrono::milliseconds(0))) {
+      worker.process(in);
+    }
+    finish_run(std::chrono::nanoseconds(m_run_cpu_ns.load()));
+  }
 
   void do_configure(const nlohmann::json& obj)
   {
@@ -141,22 +250,85 @@ private:
     // persist between runs and hold onto its state from the previous
     // run
     m_maker_conf = obj;
+
+    // Attach our ring now, so that producers find it when they start
+    if (use_local_input(obj)) {
+      m_input_ring = SetRingRegistry<IN>::attach_consumer(m_input_uid);
+      TLOG() << get_name() << ": Receiving from " << m_input_uid << " through a local ring";
+    } else {
+      detach_input_ring();
+    }
    
+    m_use_executor = use_executor(obj);
+    m_placement = get_thread_placement(obj);
+    m_output_queue.set_format(get_output_wire_format(obj));
+
     // worker should be notified that configuration potentially changed
     worker.reconfigure();
   }
 
+  void do_scrap(const nlohmann::json& /*obj*/) { detach_input_ring(); }
+
+  // Stop our ring from being found by producers that start from now on,
+  // and from notifying our task. Producers that already have it keep
+  // pushing to it until they stop, but nothing reads what they push
+  void detach_input_ring()
+  {
+    if (!m_input_ring) {
+      return;
+    }
+    m_input_ring->set_consumer_task(nullptr);
+    SetRingRegistry<IN>::detach_consumer(m_input_uid);
+    m_input_ring.reset();
+  }
+
   void do_work(std::atomic<bool>& running_flag)
   {
+    apply_thread_placement(m_placement, get_name() + " worker thread");
     // Loop until a stop is received
     while (running_flag.load()) {
       // While there are items in the input queue, continue draining even if
       // the running_flag is false, but stop _immediately_ when input is empty
       IN in;
-      while (receive(in)) {
+      size_t n_processed = 0;
+      while (receive(in, m_queue_timeout)) {
         worker.process(in);
+        if (++n_processed % s_cpu_time_update_interval == 0) {
+          m_run_cpu_ns = get_thread_cpu_time().count();
+        }
       }
+      m_run_cpu_ns = get_thread_cpu_time().count();
+    }
+    finish_run(std::chrono::nanoseconds(m_run_cpu_ns.load()));
+  }
+
+  // The CPU time used by our task or thread since the start of the run.
+  // For our own thread, it's as of the last update of m_run_cpu_ns
+  std::chrono::nanoseconds get_run_cpu_time() const
+  {
+    if (m_task_running) {
+      return m_task->get_stats().cpu_time - std::chrono::nanoseconds(m_task_cpu_ns_at_start.load());
+    }
+    return std::chrono::nanoseconds(m_run_cpu_ns.load());
+  }
+
+  // The executor's version of do_work(): process what input is ready,
+  // without waiting. Returns true to run again straight away, rather than
+  // after the poll interval, if there was any input, since more has
+  // likely arrived while we processed it
+  bool run_task()
+  {
+    IN in;
+    size_t n_processed = 0;
+    while (n_processed < s_task_batch_size && receive(in, std::chrono::milliseconds(0))) {
+      worker.process(in);
+      ++n_processed;
     }
+    return n_processed > 0;
+  }
+
+  void finish_run(std::chrono::nanoseconds cpu_time)
+  {
     // P. Rodrigues 2022-06-01. The argument here is whether to drop
     // buffered outputs. We choose 'true' because some significant
     // time can pass between the last input sent by readout and when
@@ -167,14 +339,32 @@ private:
     // downstream
     worker.drain(true);
     TLOG() << get_name() << ": Exiting do_work() method, received " << m_received_count << " inputs and successfully sent "
-           << m_sent_count << " outputs. ";
+           << m_sent_count << " outputs, using "
+           << std::chrono::duration<double, std::milli>(cpu_time).count() << " ms of CPU time. ";
     worker.reset();
   }
 
-  bool receive(IN& in)
+  bool receive(IN& in, std::chrono::milliseconds timeout)
   {
+    if (m_input_ring) {
+      if (!(timeout.count() == 0 ? m_input_ring->try_pop(in) : m_input_ring->pop(in, timeout))) {
+        return false;
+      }
+      ++m_received_count;
+      return true;
+    }
+    if (timeout.count() == 0) {
+      // Tasks poll like this when idle, so don't throw and catch a TimeoutExpired every time
+      std::optional<IN> opt_in = m_input_queue->try_receive(timeout);
+      if (!opt_in.has_value()) {
+        return false;
+      }
+      in = std::move(*opt_in);
+      ++m_received_count;
+      return true;
+    }
     try {
-      in = m_input_queue->receive(m_queue_timeout);
+      in = m_input_queue->receive(timeout);
     } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
       // it is perfectly reasonable that there might be no data in the queue
       // some fraction of the times that we check, so we just continue on and try again
@@ -186,8 +376,17 @@ private:
 
   bool send(OUT&& out)
   {
+    if (m_output_ring) {
+      if (!m_output_ring->push(std::move(out), m_queue_timeout)) {
+        ers::warning(dunedaq::iomanager::TimeoutExpired(
+          ERS_HERE, get_name(), "push to local ring \"" + m_output_uid + "\"", m_queue_timeout.count()));
+        return false;
+      }
+      ++m_sent_count;
+      return true;
+    }
     try {
-      m_output_queue->send(std::move(out), m_queue_timeout);
+      m_output_queue.send(std::move(out), m_queue_timeout);
     } catch (const dunedaq::iomanager::TimeoutExpired& excpt) {
       ers::warning(excpt);
       return false;
@@ -261,10 +460,21 @@ public: // NOLINT
 
   daqdataformats::timestamp_t m_prev_start_time = 0;
 
+  // TP -> TA only: passes whole slices, as columns, to algorithms that take them
+  static constexpr bool s_tp_to_ta = std::is_same_v<A, detdataformats::trigger::TriggerPrimitive> &&
+                                     std::is_same_v<B, triggeralgs::TriggerActivity>;
+  TPSliceDispatcher m_slice_dispatcher;
+
   void reconfigure()
   {
     m_out_buffer.set_window_time(m_parent.m_window_time);
     m_out_buffer.set_buffer_time(m_parent.m_buffer_time);
+    if constexpr (s_tp_to_ta) {
+      m_slice_dispatcher.set_maker(m_parent.m_maker.get());
+      if (m_slice_dispatcher.takes_slices()) {
+        TLOG() << m_parent.get_name() << ": " << m_parent.m_algorithm_name << " takes time slices as TP columns";
+      }
+    }
   }
 
   void reset()
@@ -276,6 +486,16 @@ public: // NOLINT
   void process_slice(const std::vector<A>& time_slice, std::vector<B>& out_vec)
   {
     // time_slice is a full slice (all Set<A> combined), time ordered, vector of A
+    if constexpr (s_tp_to_ta) {
+      if (m_slice_dispatcher.takes_slices()) {
+        try {
+          m_slice_dispatcher(time_slice, out_vec);
+        } catch (...) { // NOLINT
+          ers::fatal(AlgorithmFatalError(ERS_HERE, m_parent.get_name(), m_parent.m_algorithm_name));
+        }
+        return;
+      }
+    }
     // call operator for each of the objects in the vector
     for (const A& x : time_slice) {
       try {
@@ -299,7 +519,7 @@ public: // NOLINT
         m_prev_start_time = in.start_time;
         std::vector<A> time_slice;
         daqdataformats::timestamp_t start_time, end_time;
-        if (!m_in_buffer.buffer(in, time_slice, start_time, end_time)) {
+        if (!m_in_buffer.buffer(std::move(in), time_slice, start_time, end_time)) {
           return; // no complete time slice yet (`in` was part of buffered slice)
         }
         process_slice(time_slice, elems);
@@ -357,13 +577,15 @@ public: // NOLINT
     // emit completed windows
     while (m_out_buffer.ready()) {
       ++n_output_windows;
-      Set<B> out;
+      Set<B> out = SetPool<B>::get().acquire();
       m_out_buffer.flush(out);
       out.seqno = m_parent.m_sent_count;
       out.origin = daqdataformats::SourceID(
           daqdataformats::SourceID::Subsystem::kTrigger, m_parent.m_sourceid);
 
       if (out.type == Set<B>::Type::kHeartbeat) {
+        // heartbeats carry no objects, so keep the vector for the next payload
+        SetPool<B>::get().release(std::move(out.objects));
         TLOG_DEBUG(4) << "Sending heartbeat with start time " << out.start_time;
         if (!m_parent.send(std::move(out))) {
           ers::error(AlgorithmFailedToSend(ERS_HERE, m_parent.get_name(), m_parent.m_algorithm_name));
@@ -379,7 +601,10 @@ public: // NOLINT
           // out is dropped
         }
       }
+      // recycle out if it wasn't sent. This does nothing if it was
+      SetPool<B>::get().release(std::move(out));
     }
+    SetPool<A>::get().release(std::move(in));
     TLOG_DEBUG(4) << "process() done. Advanced output buffer by " << n_output_windows << " output windows";
   }
 
@@ -399,13 +624,15 @@ public: // NOLINT
     // Second, drain the output buffer onto the queue. These may not be "fully
     // formed" windows, but at this point we're getting no more data anyway.
     while (!m_out_buffer.empty()) {
-      Set<B> out;
+      Set<B> out = SetPool<B>::get().acquire();
       m_out_buffer.flush(out);
       out.seqno = m_parent.m_sent_count;
       out.origin = daqdataformats::SourceID(
           daqdataformats::SourceID::Subsystem::kTrigger, m_parent.m_sourceid);
 
       if (out.type == Set<B>::Type::kHeartbeat) {
+        // heartbeats carry no objects, so keep the vector for the next payload
+        SetPool<B>::get().release(std::move(out.objects));
         if(!drop) {
           if (!m_parent.send(std::move(out))) {
             ers::error(AlgorithmFailedToSend(ERS_HERE, m_parent.get_name(), m_parent.m_algorithm_name));
@@ -424,6 +651,7 @@ public: // NOLINT
           }
         }
       }
+      SetPool<B>::get().release(std::move(out));
     }
   }
 };
@@ -469,7 +697,7 @@ public: // NOLINT
       case Set<A>::Type::kPayload: {
         std::vector<A> time_slice;
         daqdataformats::timestamp_t start_time, end_time;
-        if (!m_in_buffer.buffer(in, time_slice, start_time, end_time)) {
+        if (!m_in_buffer.buffer(std::move(in), time_slice, start_time, end_time)) {
           return; // no complete time slice yet (`in` was part of buffered slice)
         }
         process_slice(time_slice, out_vec);
@@ -510,6 +738,7 @@ public: // NOLINT
       }
       out_vec.pop_back();
     }
+    SetPool<A>::get().release(std::move(in));
   }
 
   void drain(bool drop)
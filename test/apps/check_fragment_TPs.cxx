@@ -9,6 +9,7 @@
 
 #include "detdataformats/trigger/TriggerPrimitive.hpp"
 #include "hdf5libs/HDF5RawDataFile.hpp"
+#include "trigger/TimeWindowKernels.hpp"
 
 #include <daqdataformats/Fragment.hpp>
 #include <daqdataformats/FragmentHeader.hpp>
@@ -70,6 +71,7 @@ main(int argc, char** argv)
   int n_failures = 0;
 
   using dunedaq::detdataformats::trigger::TriggerPrimitive;
+  using dunedaq::trigger::find_outside_time_window;
   for (auto const& [trigger_number, record] : trigger_records) {
     std::cout << "Trigger number " << trigger_number << " with TRH pointer " << record.header.get() << " and "
               << record.fragments.size() << " fragments" << std::endl;
@@ -97,14 +99,12 @@ main(int argc, char** argv)
       const size_t n_prim =
         (frag->get_size() - sizeof(dunedaq::daqdataformats::FragmentHeader)) / sizeof(TriggerPrimitive);
       std::cout << "  Fragment has " << n_prim << " primitives" << std::endl;
-      const TriggerPrimitive* prim = reinterpret_cast<TriggerPrimitive*>(frag->get_data());
-      for (size_t i = 0; i < n_prim; ++i) {
-        if (prim->time_start < window_begin || prim->time_start > window_end) {
-          std::cout << "Primitive with time_start " << prim->time_start << " is outside request window of ("
-                    << window_begin << ", " << window_end << ")" << std::endl;
-          ++n_failures;
-        }
-        ++prim;
+      const TriggerPrimitive* prims = reinterpret_cast<TriggerPrimitive*>(frag->get_data());
+      for (size_t i = find_outside_time_window(prims, n_prim, 0, window_begin, window_end); i < n_prim;
+           i = find_outside_time_window(prims, n_prim, i + 1, window_begin, window_end)) {
+        std::cout << "Primitive with time_start " << prims[i].time_start << " is outside request window of ("
+                  << window_begin << ", " << window_end << ")" << std::endl;
+        ++n_failures;
       }
     }
   }
@@ -0,0 +1,445 @@
+/**
+ * @file serialization_benchmark.cxx Benchmark the serialization of the trigger data types
+ *
+ * Times serialization and deserialization separately for TPSets and
+ * TASets (in each of their wire formats), TCSets and TriggerCandidates, over
+ * a sweep of sizes, and reports the serialized size, the allocations
+ * per message and the throughput. The results can be written as JSON,
+ * so that releases can be compared
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#include "CLI/CLI.hpp"
+
+#include "logging/Logging.hpp"
+#include "serialization/Serialization.hpp"
+#include "trigger/TASet.hpp"
+#include "trigger/TASetSharedTPs.hpp"
+#include "trigger/TCSet.hpp"
+#include "trigger/TPSet.hpp"
+#include "trigger/TPSetFlatSerialization.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerCandidate.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// Count every allocation made by the program, so we can report the
+// allocations per message. The array forms of new and delete call these
+namespace {
+std::atomic<uint64_t> g_n_allocations{ 0 }; // NOLINT(build/unsigned)
+}
+
+void*
+operator new(size_t size)
+{
+  ++g_n_allocations;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace {
+
+using namespace dunedaq;
+using triggeralgs::TriggerActivity;
+using triggeralgs::TriggerCandidate;
+using triggeralgs::TriggerPrimitive;
+
+struct Result
+{
+  std::string type;
+  std::string format;
+  size_t size;       // The number of objects (TPs, TAs or TCs) in each message
+  size_t n_messages;
+  double bytes_per_message;
+  double serialize_s;
+  double deserialize_s;
+  double serialize_allocations_per_message;
+  double deserialize_allocations_per_message;
+};
+
+nlohmann::json
+result_to_json(const Result& result)
+{
+  auto per_s = [&](double count, double seconds) { return seconds > 0 ? count / seconds : 0.; };
+  double total_bytes = result.bytes_per_message * result.n_messages;
+  return nlohmann::json{
+    { "type", result.type },
+    { "format", result.format },
+    { "size", result.size },
+    { "n_messages", result.n_messages },
+    { "bytes_per_message", result.bytes_per_message },
+    { "bytes_per_object", result.size > 0 ? result.bytes_per_message / result.size : 0. },
+    { "serialize",
+      { { "seconds", result.serialize_s },
+        { "messages_per_s", per_s(result.n_messages, result.serialize_s) },
+        { "objects_per_s", per_s(result.n_messages * result.size, result.serialize_s) },
+        { "MB_per_s", per_s(1e-6 * total_bytes, result.serialize_s) },
+        { "allocations_per_message", result.serialize_allocations_per_message } } },
+    { "deserialize",
+      { { "seconds", result.deserialize_s },
+        { "messages_per_s", per_s(result.n_messages, result.deserialize_s) },
+        { "objects_per_s", per_s(result.n_messages * result.size, result.deserialize_s) },
+        { "MB_per_s", per_s(1e-6 * total_bytes, result.deserialize_s) },
+        { "allocations_per_message", result.deserialize_allocations_per_message } } }
+  };
+}
+
+// Serialize all of the messages, then deserialize all of them, timing and counting the allocations of each separately
+template<class T>
+Result
+run_benchmark(const std::string& type, const std::string& format, const std::vector<T>& messages, size_t size)
+{
+  using clock = std::chrono::steady_clock;
+  const size_t n_messages = messages.size();
+
+  // Keep the bytes so they can be deserialized in a separate pass
+  std::vector<std::vector<uint8_t>> serialized(n_messages); // NOLINT(build/unsigned)
+
+  auto allocations_start = g_n_allocations.load();
+  auto start = clock::now();
+  for (size_t i = 0; i < n_messages; ++i) {
+    serialized[i] = serialization::serialize(messages[i], serialization::kMsgPack);
+  }
+  std::chrono::duration<double> serialize_time = clock::now() - start;
+  auto serialize_allocations = g_n_allocations.load() - allocations_start;
+
+  // Each object is destroyed straight after it's made, so destruction
+  // counts towards deserialization, as it would in a real receiver
+  allocations_start = g_n_allocations.load();
+  start = clock::now();
+  for (size_t i = 0; i < n_messages; ++i) {
+    T object = serialization::deserialize<T>(serialized[i]);
+  }
+  std::chrono::duration<double> deserialize_time = clock::now() - start;
+  auto deserialize_allocations = g_n_allocations.load() - allocations_start;
+
+  size_t total_bytes = 0;
+  for (auto const& bytes : serialized) {
+    total_bytes += bytes.size();
+  }
+
+  double n = std::max<size_t>(n_messages, 1);
+  return Result{ type,
+                 format,
+                 size,
+                 n_messages,
+                 total_bytes / n,
+                 serialize_time.count(),
+                 deserialize_time.count(),
+                 serialize_allocations / n,
+                 deserialize_allocations / n };
+}
+
+// Generates realistic-looking TPs: in time order within a window, on clustered channels
+class TPGenerator
+{
+public:
+  explicit TPGenerator(uint64_t seed) // NOLINT(build/unsigned)
+    : m_gen(seed)
+  {}
+
+  std::vector<TriggerPrimitive> make_tps(size_t n, triggeralgs::timestamp_t start_time, triggeralgs::timestamp_t width)
+  {
+    std::uniform_int_distribution<triggeralgs::timestamp_t> time_dist(0, width > 0 ? width - 1 : 0);
+    std::uniform_int_distribution<int> channel_dist(0, 2559);
+    std::normal_distribution<double> cluster_dist(0, 5);
+    std::uniform_int_distribution<int> tot_dist(2, 40);
+    std::exponential_distribution<double> adc_dist(1. / 300);
+
+    std::vector<triggeralgs::timestamp_t> times(n);
+    for (auto& time : times) {
+      time = start_time + time_dist(m_gen);
+    }
+    std::sort(times.begin(), times.end());
+
+    std::vector<TriggerPrimitive> tps(n);
+    int cluster_channel = channel_dist(m_gen);
+    for (size_t i = 0; i < n; ++i) {
+      if (i % 8 == 0) {
+        cluster_channel = channel_dist(m_gen);
+      }
+      auto& tp = tps[i];
+      tp.time_start = times[i];
+      tp.time_over_threshold = 32 * tot_dist(m_gen);
+      tp.time_peak = tp.time_start + tp.time_over_threshold / 3;
+      tp.channel = std::max(0, cluster_channel + static_cast<int>(cluster_dist(m_gen)));
+      tp.adc_integral = 100 + static_cast<uint32_t>(adc_dist(m_gen)); // NOLINT(build/unsigned)
+      tp.adc_peak = std::min<uint32_t>(tp.adc_integral / 4, 4095);  // NOLINT(build/unsigned)
+      tp.detid = 3;
+      tp.type = TriggerPrimitive::Type::kTPC;
+      tp.algorithm = TriggerPrimitive::Algorithm::kTPCDefault;
+      tp.flag = 0;
+    }
+    return tps;
+  }
+
+private:
+  std::mt19937_64 m_gen;
+};
+
+template<class T>
+void
+fill_set_header(T& set, size_t index, triggeralgs::timestamp_t width)
+{
+  set.seqno = index;
+  set.run_number = 1;
+  set.type = T::Type::kPayload;
+  set.start_time = 100'000'000'000 + index * width;
+  set.end_time = set.start_time + width - 1;
+}
+
+// Make a TA from the TPs, filling in its summary fields as a TA maker would
+TriggerActivity
+make_ta(std::vector<TriggerPrimitive> inputs)
+{
+  TriggerActivity ta;
+  ta.inputs = std::move(inputs);
+  if (ta.inputs.empty()) {
+    return ta;
+  }
+  ta.time_start = ta.inputs.front().time_start;
+  ta.time_end = ta.inputs.back().time_start + ta.inputs.back().time_over_threshold;
+  ta.channel_start = ta.inputs.front().channel;
+  ta.channel_end = ta.inputs.front().channel;
+  for (auto const& tp : ta.inputs) {
+    ta.channel_start = std::min(ta.channel_start, tp.channel);
+    ta.channel_end = std::max(ta.channel_end, tp.channel);
+    ta.adc_integral += tp.adc_integral;
+    if (tp.adc_peak > ta.adc_peak) {
+      ta.adc_peak = tp.adc_peak;
+      ta.time_peak = tp.time_peak;
+      ta.channel_peak = tp.channel;
+    }
+  }
+  ta.time_activity = ta.time_peak;
+  ta.detid = ta.inputs.front().detid;
+  ta.type = TriggerActivity::Type::kTPC;
+  ta.algorithm = TriggerActivity::Algorithm::kSupernova;
+  return ta;
+}
+
+struct Options
+{
+  std::vector<size_t> sizes{ 0, 1, 10, 100, 1000 };
+  size_t objects_per_point{ 200'000 };
+  size_t min_messages{ 100 };
+  size_t tps_per_ta{ 10 };
+  double ta_overlap{ 0.5 };
+  size_t tas_per_tc{ 3 };
+  std::set<std::string> types{ "TPSet", "TASet", "TCSet", "TriggerCandidate" };
+  uint64_t seed{ 1 }; // NOLINT(build/unsigned)
+};
+
+size_t
+get_n_messages(const Options& options, size_t size)
+{
+  return std::max(options.min_messages, options.objects_per_point / std::max<size_t>(size, 1));
+}
+
+const triggeralgs::timestamp_t s_set_width = 62500; // 1.25 ms at 50 MHz
+
+std::vector<Result>
+benchmark_tpsets(const Options& options, size_t size)
+{
+  TPGenerator generator(options.seed);
+  std::vector<trigger::TPSet> sets(get_n_messages(options, size));
+  for (size_t i = 0; i < sets.size(); ++i) {
+    fill_set_header(sets[i], i, s_set_width);
+    sets[i].objects = generator.make_tps(size, sets[i].start_time, s_set_width);
+  }
+
+  std::vector<Result> results;
+  for (auto [format, name] : { std::make_pair(trigger::TPSetWireFormat::kMsgPack, "msgpack"),
+                               std::make_pair(trigger::TPSetWireFormat::kFlat, "flat"),
+                               std::make_pair(trigger::TPSetWireFormat::kCompact, "compact") }) {
+    trigger::TPSetWireFormatScope wire_format_scope(format);
+    results.push_back(run_benchmark("TPSet", name, sets, size));
+  }
+  return results;
+}
+
+// TAs whose inputs overlap by ta_overlap, as they do when TAs are made from sliding windows
+std::vector<TriggerActivity>
+make_tas(const Options& options, TPGenerator& generator, size_t n_tas, triggeralgs::timestamp_t start_time)
+{
+  size_t const stride = std::max<size_t>(1, options.tps_per_ta * (1 - options.ta_overlap));
+  size_t const n_tps = n_tas > 0 ? (n_tas - 1) * stride + options.tps_per_ta : 0;
+  auto tps = generator.make_tps(n_tps, start_time, s_set_width);
+  std::vector<TriggerActivity> tas;
+  for (size_t i = 0; i < n_tas; ++i) {
+    auto first = tps.begin() + i * stride;
+    tas.push_back(make_ta(std::vector<TriggerPrimitive>(first, first + options.tps_per_ta)));
+  }
+  return tas;
+}
+
+std::vector<Result>
+benchmark_tasets(const Options& options, size_t size)
+{
+  TPGenerator generator(options.seed);
+  std::vector<trigger::TASet> sets(get_n_messages(options, size));
+  for (size_t i = 0; i < sets.size(); ++i) {
+    fill_set_header(sets[i], i, s_set_width);
+    sets[i].objects = make_tas(options, generator, size, sets[i].start_time);
+  }
+
+  std::vector<Result> results;
+  for (auto [format, name] : { std::make_pair(trigger::TASetWireFormat::kMsgPack, "msgpack"),
+                               std::make_pair(trigger::TASetWireFormat::kSharedTPs, "shared_tps") }) {
+    trigger::TASetWireFormatScope wire_format_scope(format);
+    results.push_back(run_benchmark("TASet", name, sets, size));
+  }
+  return results;
+}
+
+TriggerCandidate
+make_tc(const Options& options, TPGenerator& generator, size_t n_tas, triggeralgs::timestamp_t start_time)
+{
+  TriggerCandidate tc;
+  for (auto const& ta : make_tas(options, generator, n_tas, start_time)) {
+    tc.inputs.push_back(ta);
+  }
+  tc.time_start = start_time;
+  tc.time_end = start_time + s_set_width;
+  tc.time_candidate = start_time + s_set_width / 2;
+  tc.detid = { 3 };
+  tc.type = TriggerCandidate::Type::kSupernova;
+  tc.algorithm = TriggerCandidate::Algorithm::kSupernova;
+  return tc;
+}
+
+std::vector<Result>
+benchmark_tcsets(const Options& options, size_t size)
+{
+  TPGenerator generator(options.seed);
+  std::vector<trigger::TCSet> sets(get_n_messages(options, size));
+  for (size_t i = 0; i < sets.size(); ++i) {
+    fill_set_header(sets[i], i, s_set_width);
+    for (size_t j = 0; j < size; ++j) {
+      sets[i].objects.push_back(make_tc(options, generator, options.tas_per_tc, sets[i].start_time));
+    }
+  }
+  return { run_benchmark("TCSet", "msgpack", sets, size) };
+}
+
+// For a single TC, the size is the number of TAs it was made from
+std::vector<Result>
+benchmark_tcs(const Options& options, size_t size)
+{
+  TPGenerator generator(options.seed);
+  std::vector<TriggerCandidate> tcs;
+  for (size_t i = 0; i < get_n_messages(options, size); ++i) {
+    tcs.push_back(make_tc(options, generator, size, 100'000'000'000 + i * s_set_width));
+  }
+  return { run_benchmark("TriggerCandidate", "msgpack", tcs, size) };
+}
+
+void
+log_result(const Result& result)
+{
+  auto rate = [](double count, double seconds) { return seconds > 0 ? 1e-3 * count / seconds : 0.; };
+  TLOG() << result.type << " " << result.format << " size " << result.size << ": " << result.bytes_per_message
+         << " bytes/msg. Serialize " << rate(result.n_messages, result.serialize_s) << " kHz, "
+         << result.serialize_allocations_per_message << " allocs/msg. Deserialize "
+         << rate(result.n_messages, result.deserialize_s) << " kHz, " << result.deserialize_allocations_per_message
+         << " allocs/msg";
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  CLI::App app{ "Benchmark the serialization of the trigger data types" };
+
+  Options options;
+  std::string json_filename;
+  std::vector<std::string> types(options.types.begin(), options.types.end());
+  app.add_option("-s,--sizes", options.sizes, "Numbers of objects per message to sweep over");
+  app.add_option("-n,--objects-per-point", options.objects_per_point, "Objects to serialize at each size");
+  app.add_option("-m,--min-messages", options.min_messages, "Minimum messages to serialize at each size");
+  app.add_option("--tps-per-ta", options.tps_per_ta, "Input TPs per TA");
+  app.add_option("--ta-overlap", options.ta_overlap, "Fraction of each TA's input TPs shared with the next TA");
+  app.add_option("--tas-per-tc", options.tas_per_tc, "Input TAs per TC in TCSets");
+  app.add_option("-t,--types", types, "Types to benchmark: TPSet, TASet, TCSet, TriggerCandidate");
+  app.add_option("--seed", options.seed, "Random seed for the generated objects");
+  app.add_option("-o,--output", json_filename, "Write the results to this JSON file");
+
+  CLI11_PARSE(app, argc, argv);
+  options.types = std::set<std::string>(types.begin(), types.end());
+  options.ta_overlap = std::clamp(options.ta_overlap, 0., 1.);
+
+  std::vector<Result> results;
+  for (auto size : options.sizes) {
+    std::vector<Result> size_results;
+    auto add = [&](const std::vector<Result>& new_results) {
+      size_results.insert(size_results.end(), new_results.begin(), new_results.end());
+    };
+    if (options.types.count("TPSet")) {
+      add(benchmark_tpsets(options, size));
+    }
+    if (options.types.count("TASet")) {
+      add(benchmark_tasets(options, size));
+    }
+    if (options.types.count("TCSet")) {
+      add(benchmark_tcsets(options, size));
+    }
+    if (options.types.count("TriggerCandidate")) {
+      add(benchmark_tcs(options, size));
+    }
+    for (auto const& result : size_results) {
+      log_result(result);
+    }
+    results.insert(results.end(), size_results.begin(), size_results.end());
+  }
+
+  if (!json_filename.empty()) {
+    nlohmann::json json;
+    json["options"] = { { "objects_per_point", options.objects_per_point },
+                        { "min_messages", options.min_messages },
+                        { "tps_per_ta", options.tps_per_ta },
+                        { "ta_overlap", options.ta_overlap },
+                        { "tas_per_tc", options.tas_per_tc },
+                        { "seed", options.seed } };
+    json["results"] = nlohmann::json::array();
+    for (auto const& result : results) {
+      json["results"].push_back(result_to_json(result));
+    }
+    std::ofstream fout(json_filename);
+    fout << json.dump(2) << std::endl;
+    if (!fout) {
+      std::cerr << "Failed to write results to " << json_filename << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
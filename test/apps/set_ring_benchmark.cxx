@@ -0,0 +1,205 @@
+/**
+ * @file set_ring_benchmark.cxx Compare SetRing with the iomanager queues for passing TPSets between threads
+ *
+ * One or more producer threads send TPSets to one consumer thread, as
+ * trigger modules in one application do, through a SetRing and through
+ * each kind of iomanager queue. Each TPSet carries the time at which it
+ * was sent, so the consumer measures the latency of each hop. With a
+ * rate of 0 the producers send as fast as they can, which measures
+ * throughput; with a rate, the queue is mostly empty, which measures
+ * the latency of one hop, including waking the consumer
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#include "CLI/CLI.hpp"
+
+#include "iomanager/IOManager.hpp"
+#include "iomanager/Receiver.hpp"
+#include "iomanager/Sender.hpp"
+#include "logging/Logging.hpp"
+#include "trigger/SetPool.hpp"
+#include "trigger/SetRing.hpp"
+#include "trigger/TPSet.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace dunedaq;
+using namespace std::chrono_literals;
+using trigger::TPSet;
+
+uint64_t // NOLINT(build/unsigned)
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+struct Transport
+{
+  std::string name;
+  std::function<bool(TPSet&&)> send;
+  std::function<bool(TPSet&)> receive;
+};
+
+struct Result
+{
+  double seconds{ 0 };
+  size_t n_received{ 0 };
+  std::vector<uint64_t> latencies_ns; // NOLINT(build/unsigned)
+};
+
+Result
+run(Transport& transport, size_t n_producers, size_t n_sets, size_t n_tps, double rate_hz)
+{
+  auto& pool = trigger::SetPool<TPSet::element_t>::get();
+  size_t n_per_producer = n_sets / n_producers;
+  size_t n_total = n_per_producer * n_producers;
+
+  Result result;
+  result.latencies_ns.reserve(n_total);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < n_producers; ++p) {
+    producers.emplace_back([&, p] {
+      auto next_send = std::chrono::steady_clock::now();
+      auto period = rate_hz > 0 ? std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate_hz)) : 0ns;
+      for (size_t i = 0; i < n_per_producer; ++i) {
+        TPSet tpset = pool.acquire(n_tps);
+        tpset.objects.resize(n_tps);
+        tpset.origin.id = p;
+        tpset.seqno = i;
+        if (period > 0ns) {
+          next_send += period;
+          while (std::chrono::steady_clock::now() < next_send) {
+          }
+        }
+        tpset.start_time = now_ns();
+        while (!transport.send(std::move(tpset))) {
+        }
+      }
+    });
+  }
+
+  while (result.n_received < n_total) {
+    TPSet tpset;
+    if (!transport.receive(tpset)) {
+      std::cerr << transport.name << ": timed out after " << result.n_received << " sets" << std::endl;
+      break;
+    }
+    result.latencies_ns.push_back(now_ns() - tpset.start_time);
+    pool.release(std::move(tpset));
+    ++result.n_received;
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  return result;
+}
+
+void
+print_result(const std::string& name, const Result& result)
+{
+  auto latencies = result.latencies_ns;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double f) {
+    return latencies.empty() ? 0. : latencies[static_cast<size_t>(f * (latencies.size() - 1))] / 1000.;
+  };
+  std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3) << std::setw(12)
+            << result.n_received / result.seconds / 1e6 << std::setprecision(1) << std::setw(10) << percentile(0.5)
+            << std::setw(10) << percentile(0.99) << std::setw(12) << percentile(1.) << std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_sets = 1000000;
+  size_t n_producers = 1;
+  size_t n_tps = 50;
+  size_t capacity = 1024;
+  double rate_hz = 0;
+  int n_repeats = 3;
+
+  CLI::App app{ "Compare SetRing with the iomanager queues for passing TPSets between threads" };
+  app.add_option("-n,--n-sets", n_sets, "Number of TPSets to send in each run");
+  app.add_option("-p,--producers", n_producers, "Number of producer threads");
+  app.add_option("-t,--tps", n_tps, "Number of TPs in each TPSet");
+  app.add_option("-c,--capacity", capacity, "Capacity of the ring and the queues");
+  app.add_option("-r,--rate", rate_hz, "TPSets per second from each producer, or 0 to send as fast as possible");
+  app.add_option("--repeats", n_repeats, "Number of times to run each transport");
+  CLI11_PARSE(app, argc, argv);
+
+  setenv("DUNEDAQ_PARTITION", "set_ring_benchmark", 0);
+
+  std::vector<std::pair<std::string, iomanager::QueueType>> queue_types = {
+    { "StdDeQueue", iomanager::QueueType::kStdDeQueue },
+    { "FollyMPMCQueue", iomanager::QueueType::kFollyMPMCQueue },
+  };
+  if (n_producers == 1) {
+    queue_types.emplace_back("FollySPSCQueue", iomanager::QueueType::kFollySPSCQueue);
+  }
+
+  iomanager::Queues_t queues;
+  for (auto& [name, type] : queue_types) {
+    queues.emplace_back(iomanager::QueueConfig{ { name, "TPSet" }, type, capacity });
+  }
+  iomanager::IOManager::get()->configure(queues, {}, false, 0ms); // Not using Connectivity Service
+
+  std::vector<Transport> transports;
+  auto ring = std::make_shared<trigger::SetRing<TPSet>>(capacity);
+  transports.push_back(Transport{ "SetRing",
+                                  [ring](TPSet&& tpset) { return ring->push(std::move(tpset), 100ms); },
+                                  [ring](TPSet& tpset) { return ring->pop(tpset, 1000ms); } });
+  for (auto& [name, type] : queue_types) {
+    auto sender = get_iom_sender<TPSet>(name);
+    auto receiver = get_iom_receiver<TPSet>(name);
+    transports.push_back(Transport{ name,
+                                    [sender](TPSet&& tpset) {
+                                      try {
+                                        sender->send(std::move(tpset), 100ms);
+                                      } catch (const iomanager::TimeoutExpired&) {
+                                        return false;
+                                      }
+                                      return true;
+                                    },
+                                    [receiver](TPSet& tpset) {
+                                      try {
+                                        tpset = receiver->receive(1000ms);
+                                      } catch (const iomanager::TimeoutExpired&) {
+                                        return false;
+                                      }
+                                      return true;
+                                    } });
+  }
+
+  std::cout << n_sets << " TPSets of " << n_tps << " TPs from " << n_producers << " producer(s), capacity " << capacity
+            << ", rate " << (rate_hz > 0 ? std::to_string(rate_hz) + " Hz per producer" : "unlimited") << std::endl;
+  std::cout << std::left << std::setw(16) << "transport" << std::right << std::setw(12) << "Msets/s" << std::setw(10)
+            << "p50 us" << std::setw(10) << "p99 us" << std::setw(12) << "max us" << std::endl;
+  for (int repeat = 0; repeat < n_repeats; ++repeat) {
+    for (auto& transport : transports) {
+      print_result(transport.name, run(transport, n_producers, n_sets, n_tps, rate_hz));
+    }
+  }
+  std::cout << "Set pool: " << trigger::SetPool<TPSet::element_t>::get().get_stats() << std::endl;
+
+  iomanager::IOManager::get()->reset();
+  return 0;
+}
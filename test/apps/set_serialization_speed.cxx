@@ -10,6 +10,7 @@
 #include "serialization/Serialization.hpp"
 #include "trigger/TASet.hpp"
 #include "trigger/TPSet.hpp"
+#include "trigger/TPSetFlatSerialization.hpp"
 #include "triggeralgs/TriggerPrimitive.hpp"
 #include "detdataformats/trigger/Types.hpp"
 
@@ -27,11 +28,14 @@ now_us()
   return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
 }
 
-void
-time_serialization(int tps_per_set)
+// Serialize and deserialize sets of tps_per_set TPs in the given wire
+// format, log the rates, and return the average serialized size in bytes
+double
+time_serialization(int tps_per_set, dunedaq::trigger::TPSetWireFormat wire_format)
 {
   const int N = 100000;
   int total = 0;
+  size_t total_bytes = 0;
 
   std::default_random_engine generator;
   std::uniform_int_distribution<int> uniform(0, 1000);
@@ -40,12 +44,13 @@ time_serialization(int tps_per_set)
   for (int i = 0; i < N; ++i) {
     dunedaq::trigger::TPSet set;
     set.seqno = i + 1;
-    set.start_time = (i + 1) * 5000;
-    set.end_time = (i + 2) * 5000 - 1;
+    set.start_time = 1234963454 + (i + 1) * 5000;
+    set.end_time = set.start_time + 4999;
     for (int j = 0; j < tps_per_set; ++j) {
       triggeralgs::TriggerPrimitive tp;
-      tp.time_start = 1234963454;
-      tp.time_peak = tp.time_start + 10000;
+      // Realistic timestamps: inside the set, with the peak shortly after the start
+      tp.time_start = set.start_time + uniform(generator) * 4;
+      tp.time_peak = tp.time_start + uniform(generator) / 10;
       tp.time_over_threshold = uniform(generator);
       tp.channel = uniform(generator);
       tp.adc_integral = uniform(generator);
@@ -60,11 +65,13 @@ time_serialization(int tps_per_set)
     sets.push_back(set);
   }
 
+  dunedaq::trigger::TPSetWireFormatScope wire_format_scope(wire_format);
   uint64_t start_time = now_us(); // NOLINT(build/unsigned)
 
   for (int i = 0; i < N; ++i) {
     // NOLINTNEXTLINE(build/unsigned)
     std::vector<uint8_t> bytes = dunedaq::serialization::serialize(sets[i], dunedaq::serialization::kMsgPack);
+    total_bytes += bytes.size();
     dunedaq::trigger::TPSet set_recv = dunedaq::serialization::deserialize<dunedaq::trigger::TPSet>(bytes);
     total += set_recv.seqno;
   }
@@ -73,8 +80,10 @@ time_serialization(int tps_per_set)
   double time_taken_s = 1e-6 * (end_time - start_time);
   double msg_kHz = 1e-3 * N / time_taken_s;
   double tp_kHz = 1e-3 * tps_per_set * N / time_taken_s;
+  double MB_per_s = 1e-6 * total_bytes / time_taken_s;
   TLOG() << "Sent " << N << " messages in " << time_taken_s << " (" << msg_kHz << " kHz of msgs, " << tp_kHz
-         << " kHz of TPs) " << total;
+         << " kHz of TPs, " << MB_per_s << " MB/s serialized) " << total;
+  return static_cast<double>(total_bytes) / N;
 }
 
 int
@@ -82,8 +91,16 @@ main()
 {
   std::vector<int> n_tps{ 0, 1, 10, 100, 1000 };
   for (auto n : n_tps) {
-    TLOG() << n << " TPs per set: " << std::flush;
-    time_serialization(n);
+    TLOG() << n << " TPs per set, msgpack: " << std::flush;
+    double msgpack_size = time_serialization(n, dunedaq::trigger::TPSetWireFormat::kMsgPack);
+    TLOG() << n << " TPs per set, flat: " << std::flush;
+    double flat_size = time_serialization(n, dunedaq::trigger::TPSetWireFormat::kFlat);
+    TLOG() << n << " TPs per set, compact: " << std::flush;
+    double compact_size = time_serialization(n, dunedaq::trigger::TPSetWireFormat::kCompact);
+    // The compression ratio is relative to msgpack, which is what's sent by default
+    TLOG() << n << " TPs per set: bytes per set msgpack " << msgpack_size << ", flat " << flat_size << " (ratio "
+           << msgpack_size / flat_size << "), compact " << compact_size << " (ratio " << msgpack_size / compact_size
+           << ")";
   }
 
   dunedaq::trigger::TASet taset;
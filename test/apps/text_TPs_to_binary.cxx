@@ -0,0 +1,61 @@
+/**
+ * @file text_TPs_to_binary.cxx Convert a TP text file, as read by TriggerPrimitiveMaker, into the binary TP replay format
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#include "CLI/CLI.hpp"
+
+#include "trigger/TPReplayFile.hpp"
+#include "trigger/TPTextReader.hpp"
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+
+#include <iostream>
+#include <string>
+
+int
+main(int argc, char** argv)
+{
+  CLI::App app{ "Convert a TP text file into the binary TP replay format used by TriggerPrimitiveMaker" };
+
+  std::string in_filename;
+  app.add_option("-i,--input", in_filename, "Input text file")->required();
+
+  std::string out_filename;
+  app.add_option("-o,--output", out_filename, "Output binary file")->required();
+
+  uint64_t tpset_time_width = 10000; // NOLINT(build/unsigned)
+  app.add_option("-w,--tpset-time-width", tpset_time_width, "Width in time of the TPSets to index (default 10000)");
+
+  uint64_t tpset_time_offset = 0; // NOLINT(build/unsigned)
+  app.add_option("--tpset-time-offset", tpset_time_offset, "Offset of the TPSet boundaries to index (default 0)");
+
+  CLI11_PARSE(app, argc, argv);
+
+  dunedaq::trigger::TPTextReader reader(in_filename);
+  if (!reader.is_open()) {
+    std::cerr << "Could not open input file " << in_filename << std::endl;
+    return 1;
+  }
+
+  dunedaq::trigger::TPReplayFileWriter writer(out_filename, tpset_time_width, tpset_time_offset);
+
+  using dunedaq::detdataformats::trigger::TriggerPrimitive;
+  TriggerPrimitive tp;
+  size_t n_unsorted = 0;
+  while (reader.next(tp)) {
+    if (!writer.add(tp)) {
+      ++n_unsorted;
+    }
+  }
+  writer.close();
+
+  std::cout << "Wrote " << writer.get_n_tps() << " TPs in " << writer.get_n_sets() << " TPSets to " << out_filename
+            << std::endl;
+  if (n_unsorted > 0) {
+    std::cout << n_unsorted << " TPs were earlier than the preceding TP and were dropped" << std::endl;
+  }
+  return 0;
+}
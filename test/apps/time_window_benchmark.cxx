@@ -0,0 +1,204 @@
+/**
+ * @file time_window_benchmark.cxx Compare the time window kernels with the loops they replace
+ *
+ * Selects, counts, checks and finds the bounds of TPs in a time window,
+ * with the plain loops that the trigger modules used to have and with
+ * the kernels in TimeWindowKernels.hpp, for each instruction set that
+ * this machine can run. The TPs are in time order with some jitter, as
+ * they are in a TPSet, and the window covers a given fraction of them
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#include "CLI/CLI.hpp"
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+#include "trigger/TimeWindowKernels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace dunedaq;
+using daqdataformats::timestamp_t;
+using detdataformats::trigger::TriggerPrimitive;
+
+// Nanoseconds per item for the best of n_repeats runs of f over n_items items
+double
+time_per_item(size_t n_items, int n_repeats, const std::function<size_t()>& f, size_t& result)
+{
+  double best = 0;
+  for (int i = 0; i < n_repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    result = f();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (i == 0 || ns < best) {
+      best = ns;
+    }
+  }
+  return best / n_items;
+}
+
+struct Benchmark
+{
+  std::string name;
+  // TPs, or searches for the lower bound
+  size_t n_items;
+  std::function<size_t()> naive;
+  std::function<size_t()> kernel;
+};
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_tps = 1000000;
+  double window_fraction = 0.5;
+  int n_repeats = 20;
+
+  CLI::App app{ "Compare the time window kernels with the loops they replace" };
+  app.add_option("-n,--n-tps", n_tps, "Number of TPs");
+  app.add_option("-w,--window", window_fraction, "Fraction of the TPs in the window");
+  app.add_option("-r,--repeats", n_repeats, "Number of times to run each benchmark. The fastest run is reported");
+  CLI11_PARSE(app, argc, argv);
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<timestamp_t> jitter(0, 32);
+  std::vector<TriggerPrimitive> tps(n_tps);
+  std::vector<timestamp_t> column(n_tps);
+  for (size_t i = 0; i < n_tps; ++i) {
+    tps[i].time_start = 100 * i + jitter(rng);
+    tps[i].channel = i % 2560;
+    column[i] = tps[i].time_start;
+  }
+  timestamp_t begin = 100 * static_cast<timestamp_t>(n_tps * (0.5 - window_fraction / 2));
+  timestamp_t end = 100 * static_cast<timestamp_t>(n_tps * (0.5 + window_fraction / 2));
+  std::vector<TriggerPrimitive> selection;
+
+  std::vector<Benchmark> benchmarks = {
+    { "select",
+      n_tps,
+      // TPSetBufferCreator::convert_to_fragment
+      [&] {
+        selection.clear();
+        for (auto const& tp : tps) {
+          if (tp.time_start >= begin && tp.time_start <= end) {
+            selection.push_back(tp);
+          }
+        }
+        return selection.size();
+      },
+      [&] {
+        selection.clear();
+        selection.reserve(trigger::count_in_time_window(tps.data(), n_tps, begin, end));
+        return trigger::select_in_time_window(tps.data(), n_tps, begin, end, selection);
+      } },
+    { "check",
+      n_tps,
+      // The TPSetSink check, with every TP in bounds
+      [&] {
+        size_t n_outside = 0;
+        for (auto const& tp : tps) {
+          if (tp.time_start < tps.front().time_start || tp.time_start > tps.back().time_start + 100) {
+            ++n_outside;
+          }
+        }
+        return n_outside;
+      },
+      [&] {
+        size_t n_outside = 0;
+        timestamp_t first = tps.front().time_start, last = tps.back().time_start + 100;
+        for (size_t i = trigger::find_outside_time_window(tps.data(), n_tps, 0, first, last); i < n_tps;
+             i = trigger::find_outside_time_window(tps.data(), n_tps, i + 1, first, last)) {
+          ++n_outside;
+        }
+        return n_outside;
+      } },
+    { "count",
+      n_tps,
+      [&] {
+        size_t n = 0;
+        for (auto const& tp : tps) {
+          n += (tp.time_start >= begin && tp.time_start <= end);
+        }
+        return n;
+      },
+      [&] { return trigger::count_in_time_window(tps.data(), n_tps, begin, end); } },
+    { "count column",
+      n_tps,
+      // The time_start column of a TPSetSoA
+      [&] {
+        size_t n = 0;
+        for (auto t : column) {
+          n += (t >= begin && t <= end);
+        }
+        return n;
+      },
+      [&] { return trigger::count_in_time_window(column.data(), 1, n_tps, begin, end); } },
+    { "lower bound",
+      1000,
+      [&] {
+        size_t sum = 0;
+        for (size_t i = 0; i < 1000; ++i) {
+          timestamp_t t = 100 * (i * n_tps / 1000);
+          sum += std::lower_bound(tps.begin(), tps.end(), t, [](auto const& tp, timestamp_t value) {
+                   return tp.time_start < value;
+                 }) - tps.begin();
+        }
+        return sum;
+      },
+      [&] {
+        size_t sum = 0;
+        for (size_t i = 0; i < 1000; ++i) {
+          sum += trigger::lower_bound_time_start(tps.data(), n_tps, 100 * (i * n_tps / 1000));
+        }
+        return sum;
+      } },
+  };
+
+  std::vector<trigger::TimeWindowIsa> isas;
+  for (auto isa : { trigger::TimeWindowIsa::kScalar, trigger::TimeWindowIsa::kAVX2, trigger::TimeWindowIsa::kAVX512 }) {
+    if (trigger::is_time_window_isa_supported(isa)) {
+      isas.push_back(isa);
+    }
+  }
+
+  std::cout << n_tps << " TPs, " << window_fraction * 100 << "% in the window. ns per TP, best of " << n_repeats
+            << " runs; speedup over the plain loop in brackets" << std::endl;
+  std::cout << std::left << std::setw(20) << "benchmark" << std::right << std::setw(10) << "loop";
+  for (auto isa : isas) {
+    std::cout << std::setw(20) << trigger::get_time_window_isa_name(isa);
+  }
+  std::cout << std::endl;
+
+  auto default_isa = trigger::get_time_window_isa();
+  for (auto& benchmark : benchmarks) {
+    size_t expected = 0;
+    double naive_ns = time_per_item(benchmark.n_items, n_repeats, benchmark.naive, expected);
+    std::cout << std::left << std::setw(20) << benchmark.name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << naive_ns;
+    for (auto isa : isas) {
+      trigger::set_time_window_isa(isa);
+      size_t result = 0;
+      double ns = time_per_item(benchmark.n_items, n_repeats, benchmark.kernel, result);
+      std::cout << std::setw(10) << ns << " (" << std::setprecision(1) << std::setw(5) << naive_ns / ns << "x)"
+                << std::setprecision(3);
+      if (result != expected) {
+        std::cout << std::endl << "Result " << result << " doesn't match the loop's " << expected << std::endl;
+        return 1;
+      }
+    }
+    std::cout << std::endl;
+  }
+  trigger::set_time_window_isa(default_isa);
+  return 0;
+}
@@ -13,8 +13,11 @@
 #include "appfwk/DAQModuleHelper.hpp"
 #include "appfwk/app/Nljs.hpp"
 #include "iomanager/IOManager.hpp"
+#include "trigger/TimeWindowKernels.hpp"
 #include "triggeralgs/Types.hpp"
 #include <chrono>
+#include <memory>
+#include <optional>
 #include <sstream>
 
 namespace dunedaq {
@@ -26,12 +29,19 @@ TASetSink::TASetSink(const std::string& name)
   register_command("start", &TASetSink::do_start);
   register_command("stop", &TASetSink::do_stop);
   register_command("conf", &TASetSink::do_conf);
+  register_command("scrap", &TASetSink::do_scrap);
+}
+
+TASetSink::~TASetSink()
+{
+  detach_input_ring();
 }
 
 void
 TASetSink::init(const nlohmann::json& obj)
 {
-  m_taset_source = get_iom_receiver<TASet>(appfwk::connection_uid(obj, "taset_source"));
+  m_taset_source_uid = appfwk::connection_uid(obj, "taset_source");
+  m_taset_source = get_iom_receiver<TASet>(m_taset_source_uid);
 }
 
 void
@@ -59,6 +69,29 @@ TASetSink::do_conf(const nlohmann::json& obj)
   else {
     TLOG() << "Output filename is null, so not opening an output file";
   }
+
+  // Attach our ring now, so that producers find it when they start
+  if (m_conf.local_input) {
+    m_input_ring = SetRingRegistry<std::shared_ptr<const TASet>>::attach_consumer(m_taset_source_uid);
+    TLOG() << get_name() << ": Receiving from " << m_taset_source_uid << " through a local ring";
+  } else {
+    detach_input_ring();
+  }
+}
+
+void
+TASetSink::do_scrap(const nlohmann::json& /*obj*/)
+{
+  detach_input_ring();
+}
+
+void
+TASetSink::detach_input_ring()
+{
+  if (m_input_ring) {
+    SetRingRegistry<std::shared_ptr<const TASet>>::detach_consumer(m_taset_source_uid);
+    m_input_ring.reset();
+  }
 }
 
 
@@ -77,8 +110,17 @@ TASetSink::do_work()
   uint32_t last_seqno = 0;
 
   while (true) {
-    std::optional<TASet> taset_opt = m_taset_source->try_receive(std::chrono::milliseconds(100));
-    if (!taset_opt.has_value()) {
+    // A TASet from the ring is shared with other consumers, so we only read it
+    std::shared_ptr<const TASet> shared_taset;
+    std::optional<TASet> taset_opt;
+    bool received = false;
+    if (m_input_ring) {
+      received = m_input_ring->pop(shared_taset, std::chrono::milliseconds(100));
+    } else {
+      taset_opt = m_taset_source->try_receive(std::chrono::milliseconds(100));
+      received = taset_opt.has_value();
+    }
+    if (!received) {
       // The condition to exit the loop is that we've been stopped and
       // there's nothing left on the input queue
       if (!m_running_flag.load()) {
@@ -88,8 +130,8 @@ TASetSink::do_work()
       }
     }
 
-    TASet taset = *taset_opt;
-    
+    const TASet& taset = shared_taset ? *shared_taset : *taset_opt;
+
     ++n_taset_received;
     if (m_outfile.is_open()) {
       for (auto const& ta : taset.objects) {
@@ -119,11 +161,12 @@ TASetSink::do_work()
       } else if (taset.objects.empty()) {
         TLOG_DEBUG(1) << "Empty TASet with start time " << taset.start_time;
       }
-      for (auto const& tp : taset.objects) {
-        if (tp.time_start < taset.start_time || tp.time_start > taset.end_time) {
-          TLOG() << "TASet with start time " << taset.start_time << ", end time " << taset.end_time
-                 << " contains out-of-bounds TP with start time " << tp.time_start;
-        }
+      auto const* tas = taset.objects.data();
+      size_t const n_tas = taset.objects.size();
+      for (size_t i = find_outside_time_window(tas, n_tas, 0, taset.start_time, taset.end_time); i < n_tas;
+           i = find_outside_time_window(tas, n_tas, i + 1, taset.start_time, taset.end_time)) {
+        TLOG() << "TASet with start time " << taset.start_time << ", end time " << taset.end_time
+               << " contains out-of-bounds TP with start time " << tas[i].time_start;
       }
     } // end if(m_conf.do_checks)
 
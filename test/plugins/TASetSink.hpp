@@ -12,6 +12,7 @@
 #ifndef TRIGGER_TEST_PLUGINS_TASETSINK_HPP_
 #define TRIGGER_TEST_PLUGINS_TASETSINK_HPP_
 
+#include "trigger/SetRing.hpp"
 #include "trigger/TASet.hpp"
 #include "trigger/tasetsink/Nljs.hpp"
 
@@ -20,6 +21,7 @@
 
 #include <fstream>
 #include <memory>
+#include <string>
 
 namespace dunedaq {
 
@@ -36,6 +38,7 @@ public:
    * @param name Instance name for this TASetSink instance
    */
   explicit TASetSink(const std::string& name);
+  ~TASetSink();
 
   TASetSink(const TASetSink&) = delete;            ///< TASetSink is not copy-constructible
   TASetSink& operator=(const TASetSink&) = delete; ///< TASetSink is not copy-assignable
@@ -49,6 +52,10 @@ private:
   void do_start(const nlohmann::json& obj);
   void do_stop(const nlohmann::json& obj);
   void do_conf(const nlohmann::json& obj);
+  void do_scrap(const nlohmann::json& obj);
+
+  // Stop our ring from being found by producers that start from now on
+  void detach_input_ring();
 
   void do_work();
 
@@ -60,6 +67,10 @@ private:
   // Queue sources and sinks
   using source_t = iomanager::ReceiverConcept<TASet>;
   std::shared_ptr<source_t> m_taset_source;
+
+  // Used instead of the source when local_input is set
+  std::string m_taset_source_uid;
+  std::shared_ptr<SetRing<std::shared_ptr<const TASet>>> m_input_ring;
 };
 } // namespace trigger
 } // namespace dunedaq
@@ -12,6 +12,7 @@
 #include "appfwk/app/Nljs.hpp"
 #include "iomanager/IOManager.hpp"
 #include "logging/Logging.hpp"
+#include "trigger/TimeWindowKernels.hpp"
 #include "triggeralgs/Types.hpp"
 
 #include <chrono>
@@ -93,11 +94,13 @@ TPSetSink::do_work()
     } else if (tpset.objects.empty()) {
       TLOG() << "Empty TPSet with start time " << tpset.start_time;
     }
-    for (auto const& tp : tpset.objects) {
-      if (tp.time_start < tpset.start_time || tp.time_start > tpset.end_time) {
-        TLOG() << "TPSet with start time " << tpset.start_time << ", end time " << tpset.end_time
-               << " contains out-of-bounds TP with start time " << tp.time_start;
-      }
+    // Jump from one out-of-bounds TP to the next, since there usually aren't any
+    auto const* tps = tpset.objects.data();
+    size_t const n_tps = tpset.objects.size();
+    for (size_t i = find_outside_time_window(tps, n_tps, 0, tpset.start_time, tpset.end_time); i < n_tps;
+         i = find_outside_time_window(tps, n_tps, i + 1, tpset.start_time, tpset.end_time)) {
+      TLOG() << "TPSet with start time " << tpset.start_time << ", end time " << tpset.end_time
+             << " contains out-of-bounds TP with start time " << tps[i].time_start;
     }
 
     if (first_timestamp == 0) {
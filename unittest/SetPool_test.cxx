@@ -0,0 +1,126 @@
+/**
+ * @file SetPool_test.cxx  SetPool class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/SetPool.hpp"
+#include "trigger/TimeSliceInputBuffer.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE SetPool_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using triggeralgs::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+BOOST_AUTO_TEST_CASE(RecycledWithCapacity)
+{
+  SetPool<TriggerPrimitive> pool;
+
+  auto set = pool.acquire(100);
+  BOOST_CHECK_GE(set.objects.capacity(), 100);
+  set.objects.resize(50);
+  set.start_time = 1234;
+  auto const* data = set.objects.data();
+  pool.release(std::move(set));
+  BOOST_CHECK(set.objects.empty());
+
+  auto set2 = pool.acquire();
+  BOOST_CHECK_EQUAL(set2.objects.data(), data);
+  BOOST_CHECK(set2.objects.empty());
+  BOOST_CHECK_GE(set2.objects.capacity(), 100);
+  BOOST_CHECK_EQUAL(set2.start_time, 0);
+
+  auto stats = pool.get_stats();
+  BOOST_CHECK_EQUAL(stats.hits, 1);
+  BOOST_CHECK_EQUAL(stats.misses, 1);
+  BOOST_CHECK_EQUAL(stats.released, 1);
+  BOOST_CHECK_EQUAL(stats.discarded, 0);
+  BOOST_CHECK_EQUAL(stats.pooled, 0);
+}
+
+BOOST_AUTO_TEST_CASE(EmptySetsIgnored)
+{
+  SetPool<TriggerPrimitive> pool;
+  Set<TriggerPrimitive> set;
+  pool.release(std::move(set));
+
+  auto stats = pool.get_stats();
+  BOOST_CHECK_EQUAL(stats.released, 0);
+  BOOST_CHECK_EQUAL(stats.discarded, 0);
+  BOOST_CHECK_EQUAL(stats.pooled, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Limits)
+{
+  SetPool<TriggerPrimitive> pool;
+  pool.set_limits(2, 1000);
+
+  for (size_t i = 0; i < 3; ++i) {
+    pool.release(pool.acquire(10));
+  }
+  // Only one vector is ever in the pool in that loop
+  BOOST_CHECK_EQUAL(pool.get_stats().pooled, 1);
+
+  std::vector<Set<TriggerPrimitive>> sets;
+  for (size_t i = 0; i < 3; ++i) {
+    sets.push_back(pool.acquire(10));
+  }
+  for (auto& set : sets) {
+    pool.release(std::move(set));
+  }
+  Set<TriggerPrimitive> too_big;
+  too_big.objects.reserve(2000);
+  pool.release(std::move(too_big));
+
+  auto stats = pool.get_stats();
+  BOOST_CHECK_EQUAL(stats.pooled, 2);
+  BOOST_CHECK_EQUAL(stats.discarded, 2);
+
+  pool.set_limits(1, 1000);
+  BOOST_CHECK_EQUAL(pool.get_stats().pooled, 1);
+  pool.clear();
+  BOOST_CHECK_EQUAL(pool.get_stats().pooled, 0);
+}
+
+BOOST_AUTO_TEST_CASE(InputBufferRecycles)
+{
+  auto& pool = SetPool<TriggerPrimitive>::get();
+  pool.clear();
+  auto stats_before = pool.get_stats();
+
+  std::string name = "test", algorithm = "test";
+  TimeSliceInputBuffer<TriggerPrimitive> buffer(name, algorithm);
+  for (size_t i = 0; i < 2; ++i) {
+    Set<TriggerPrimitive> set = pool.acquire(10);
+    set.start_time = 100;
+    set.end_time = 200;
+    set.objects.resize(5);
+    std::vector<TriggerPrimitive> time_slice;
+    dunedaq::daqdataformats::timestamp_t start_time, end_time;
+    BOOST_CHECK(!buffer.buffer(std::move(set), time_slice, start_time, end_time));
+  }
+  std::vector<TriggerPrimitive> time_slice;
+  dunedaq::daqdataformats::timestamp_t start_time, end_time;
+  BOOST_CHECK(buffer.flush(time_slice, start_time, end_time));
+  BOOST_CHECK_EQUAL(time_slice.size(), 10);
+
+  auto stats = pool.get_stats();
+  BOOST_CHECK_EQUAL(stats.released - stats_before.released, 2);
+  BOOST_CHECK_EQUAL(stats.pooled, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
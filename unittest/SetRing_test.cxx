@@ -0,0 +1,161 @@
+/**
+ * @file SetRing_test.cxx  SetRing class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/SetRing.hpp"
+#include "trigger/TPSet.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE SetRing_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+BOOST_AUTO_TEST_CASE(FullAndEmpty)
+{
+  SetRing<TPSet> ring(3);
+  BOOST_CHECK_EQUAL(ring.capacity(), 4);
+  BOOST_CHECK(ring.empty());
+
+  for (size_t i = 0; i < 4; ++i) {
+    TPSet tpset;
+    tpset.seqno = i;
+    tpset.objects.resize(10);
+    BOOST_CHECK(ring.try_push(std::move(tpset)));
+  }
+  BOOST_CHECK(ring.full());
+
+  TPSet extra;
+  extra.objects.resize(5);
+  BOOST_CHECK(!ring.try_push(std::move(extra)));
+  // A failed push leaves the object alone
+  BOOST_CHECK_EQUAL(extra.objects.size(), 5);
+  BOOST_CHECK(!ring.push(std::move(extra), 10ms));
+
+  for (size_t i = 0; i < 4; ++i) {
+    TPSet tpset;
+    BOOST_REQUIRE(ring.try_pop(tpset));
+    BOOST_CHECK_EQUAL(tpset.seqno, i);
+    BOOST_CHECK_EQUAL(tpset.objects.size(), 10);
+  }
+  TPSet tpset;
+  BOOST_CHECK(!ring.try_pop(tpset));
+  BOOST_CHECK(!ring.pop(tpset, 10ms));
+}
+
+BOOST_AUTO_TEST_CASE(ObjectsNotCopied)
+{
+  SetRing<TPSet> ring(4);
+  TPSet tpset;
+  tpset.objects.resize(100);
+  auto const* data = tpset.objects.data();
+  BOOST_CHECK(ring.push(std::move(tpset), 10ms));
+  TPSet out;
+  BOOST_CHECK(ring.pop(out, 10ms));
+  BOOST_CHECK_EQUAL(out.objects.data(), data);
+}
+
+BOOST_AUTO_TEST_CASE(ManyProducers)
+{
+  const size_t n_producers = 4;
+  const size_t n_per_producer = 20000;
+  SetRing<TPSet> ring(16);
+
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < n_producers; ++p) {
+    producers.emplace_back([&ring, p] {
+      for (size_t i = 0; i < n_per_producer; ++i) {
+        TPSet tpset;
+        tpset.origin.id = p;
+        tpset.seqno = i;
+        while (!ring.push(std::move(tpset), 100ms)) {
+        }
+      }
+    });
+  }
+
+  // Each producer's sets come out in the order it pushed them
+  std::vector<size_t> next_seqno(n_producers, 0);
+  size_t n_received = 0;
+  while (n_received < n_producers * n_per_producer) {
+    TPSet tpset;
+    if (!ring.pop(tpset, 1000ms)) {
+      break;
+    }
+    BOOST_REQUIRE_LT(tpset.origin.id, n_producers);
+    BOOST_CHECK_EQUAL(tpset.seqno, next_seqno[tpset.origin.id]);
+    next_seqno[tpset.origin.id] = tpset.seqno + 1;
+    ++n_received;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  BOOST_CHECK_EQUAL(n_received, n_producers * n_per_producer);
+}
+
+BOOST_AUTO_TEST_CASE(SleepingConsumerWoken)
+{
+  SetRing<TPSet> ring(4);
+  std::thread producer([&ring] {
+    std::this_thread::sleep_for(50ms);
+    TPSet tpset;
+    tpset.seqno = 7;
+    ring.push(std::move(tpset), 10ms);
+  });
+  TPSet tpset;
+  auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK(ring.pop(tpset, 5000ms));
+  BOOST_CHECK_EQUAL(tpset.seqno, 7);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < 2000ms);
+  producer.join();
+}
+
+BOOST_AUTO_TEST_CASE(Registry)
+{
+  BOOST_CHECK(!SetRingRegistry<TPSet>::find("conn"));
+  auto ring = SetRingRegistry<TPSet>::attach_consumer("conn", 8);
+  BOOST_CHECK_EQUAL(ring->capacity(), 8);
+  BOOST_CHECK_EQUAL(SetRingRegistry<TPSet>::find("conn"), ring);
+  BOOST_CHECK_EQUAL(SetRingRegistry<TPSet>::attach_consumer("conn"), ring);
+  BOOST_CHECK(!SetRingRegistry<TPSet>::find("other"));
+  SetRingRegistry<TPSet>::detach_consumer("conn");
+  BOOST_CHECK(!SetRingRegistry<TPSet>::find("conn"));
+}
+
+BOOST_AUTO_TEST_CASE(SharedRing)
+{
+  // A reader's ring is separate from an owner's ring on the same connection
+  using shared_t = std::shared_ptr<const TPSet>;
+  auto ring = SetRingRegistry<shared_t>::attach_consumer("shared_conn", 4);
+  BOOST_CHECK(!SetRingRegistry<TPSet>::find("shared_conn"));
+
+  // Two readers can be passed the same TPSet
+  auto tpset = std::make_shared<TPSet>();
+  tpset->seqno = 7;
+  tpset->objects.resize(100);
+  BOOST_REQUIRE(ring->try_push(shared_t(tpset)));
+  shared_t popped;
+  BOOST_REQUIRE(ring->try_pop(popped));
+  BOOST_CHECK_EQUAL(popped.get(), tpset.get());
+  BOOST_CHECK_EQUAL(popped->seqno, 7);
+  BOOST_CHECK_EQUAL(tpset.use_count(), 2);
+  SetRingRegistry<shared_t>::detach_consumer("shared_conn");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
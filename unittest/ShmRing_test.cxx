@@ -0,0 +1,211 @@
+/**
+ * @file ShmRing_test.cxx  ShmRing class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/Issues.hpp"
+#include "trigger/ShmRing.hpp"
+#include "trigger/TPSetFlatSerialization.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE ShmRing_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "TPSetTestHelpers.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace dunedaq::trigger;
+using namespace std::chrono_literals;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+// A ring name that no other run of the test is using, removed at the end of the test
+struct RingName
+{
+  RingName()
+    : name("trigger_ShmRing_test_" + std::to_string(getpid()))
+  {
+    ShmRing::remove(name);
+  }
+  ~RingName() { ShmRing::remove(name); }
+  std::string name;
+};
+
+bool
+write_tpset(ShmRing& ring, const Set<TriggerPrimitive>& tpset)
+{
+  uint8_t* slot = ring.begin_write(10ms); // NOLINT(build/unsigned)
+  if (slot == nullptr) {
+    return false;
+  }
+  size_t size = serialize_flat_tpset(tpset, slot, ring.slot_size());
+  BOOST_REQUIRE(size > 0);
+  ring.commit_write(size);
+  return true;
+}
+
+bool
+read_tpset(ShmRing& ring, Set<TriggerPrimitive>& tpset, std::chrono::milliseconds timeout = 10ms)
+{
+  size_t size = 0;
+  const uint8_t* slot = ring.begin_read(size, timeout); // NOLINT(build/unsigned)
+  if (slot == nullptr) {
+    return false;
+  }
+  FlatTPSetView(slot, size).to_tpset(tpset);
+  return true;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  RingName ring_name;
+  ShmRing writer(ring_name.name, ShmRing::Role::kWriter, 3, 4096);
+  ShmRing reader(ring_name.name, ShmRing::Role::kReader, 3, 4096);
+  BOOST_CHECK_EQUAL(writer.n_slots(), 4);
+
+  for (size_t i = 0; i < 10; ++i) {
+    auto sent = make_tpset(i, i);
+    BOOST_REQUIRE(write_tpset(writer, sent));
+    BOOST_CHECK_EQUAL(reader.size(), 1);
+    Set<TriggerPrimitive> tpset;
+    BOOST_REQUIRE(read_tpset(reader, tpset));
+    reader.commit_read();
+    check_equal(tpset, sent);
+  }
+
+  // A set that's too large for a slot isn't written
+  auto big = make_tpset(4096 / sizeof(TriggerPrimitive), 0);
+  BOOST_CHECK_EQUAL(serialize_flat_tpset(big, writer.begin_write(10ms), writer.slot_size()), 0);
+}
+
+BOOST_AUTO_TEST_CASE(FullAndEmpty)
+{
+  RingName ring_name;
+  ShmRing writer(ring_name.name, ShmRing::Role::kWriter, 2, 1024);
+  ShmRing reader(ring_name.name, ShmRing::Role::kReader, 2, 1024);
+
+  Set<TriggerPrimitive> tpset;
+  BOOST_CHECK(!read_tpset(reader, tpset));
+  BOOST_CHECK(write_tpset(writer, make_tpset(1, 0)));
+  BOOST_CHECK(write_tpset(writer, make_tpset(1, 1)));
+  BOOST_CHECK(!write_tpset(writer, make_tpset(1, 2)));
+
+  // The slot stays full until the read is committed
+  BOOST_REQUIRE(read_tpset(reader, tpset));
+  BOOST_CHECK(!write_tpset(writer, make_tpset(1, 2)));
+  reader.commit_read();
+  BOOST_CHECK(write_tpset(writer, make_tpset(1, 2)));
+}
+
+BOOST_AUTO_TEST_CASE(Attach)
+{
+  RingName ring_name;
+  ShmRing reader(ring_name.name, ShmRing::Role::kReader, 4, 1024);
+  // Only one ShmRing in a process can have a role
+  BOOST_CHECK_THROW(ShmRing(ring_name.name, ShmRing::Role::kReader, 4, 1024), ShmRingError);
+  // The geometry must match
+  BOOST_CHECK_THROW(ShmRing(ring_name.name, ShmRing::Role::kWriter, 4, 2048), ShmRingError);
+  BOOST_CHECK_THROW(ShmRing(ring_name.name, ShmRing::Role::kWriter, 8, 1024), ShmRingError);
+
+  // A role can't be taken from a live process...
+  int to_child[2];
+  int from_child[2];
+  BOOST_REQUIRE(pipe(to_child) == 0 && pipe(from_child) == 0);
+  pid_t child = fork();
+  if (child == 0) {
+    ShmRing writer(ring_name.name, ShmRing::Role::kWriter, 4, 1024);
+    char c = 0;
+    (void)!write(from_child[1], &c, 1);
+    (void)!read(to_child[0], &c, 1);
+    _exit(0);
+  }
+  BOOST_REQUIRE(child > 0);
+  char c = 0;
+  BOOST_REQUIRE(read(from_child[0], &c, 1) == 1);
+  BOOST_CHECK_THROW(ShmRing(ring_name.name, ShmRing::Role::kWriter, 4, 1024), ShmRingError);
+
+  // ...but it can once that process has let it go
+  BOOST_REQUIRE(write(to_child[1], &c, 1) == 1);
+  int status = 0;
+  waitpid(child, &status, 0);
+  ShmRing writer(ring_name.name, ShmRing::Role::kWriter, 4, 1024);
+}
+
+BOOST_AUTO_TEST_CASE(ReattachAfterCrash)
+{
+  RingName ring_name;
+
+  // The child dies holding the writer role, part way through writing its second set
+  pid_t child = fork();
+  if (child == 0) {
+    ShmRing writer(ring_name.name, ShmRing::Role::kWriter, 4, 1024);
+    write_tpset(writer, make_tpset(5, 0));
+    std::memset(writer.begin_write(10ms), 0xff, 100);
+    _exit(0);
+  }
+  BOOST_REQUIRE(child > 0);
+  int status = 0;
+  waitpid(child, &status, 0);
+  BOOST_REQUIRE(WIFEXITED(status));
+
+  // We can take over the role, and only the committed set was sent
+  ShmRing writer(ring_name.name, ShmRing::Role::kWriter, 4, 1024);
+  BOOST_CHECK(write_tpset(writer, make_tpset(5, 1)));
+  Set<TriggerPrimitive> tpset;
+  {
+    ShmRing reader(ring_name.name, ShmRing::Role::kReader, 4, 1024);
+    BOOST_CHECK_EQUAL(reader.size(), 2);
+    BOOST_REQUIRE(read_tpset(reader, tpset));
+    BOOST_CHECK_EQUAL(tpset.seqno, 0);
+    reader.commit_read();
+    // The reader goes away before committing its read of the second set...
+    BOOST_REQUIRE(read_tpset(reader, tpset));
+    BOOST_CHECK_EQUAL(tpset.seqno, 1);
+  }
+  // ...so the next reader gets it again
+  ShmRing reader(ring_name.name, ShmRing::Role::kReader, 4, 1024);
+  BOOST_REQUIRE(read_tpset(reader, tpset));
+  BOOST_CHECK_EQUAL(tpset.seqno, 1);
+  BOOST_CHECK_EQUAL(tpset.objects.size(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(SleepingReaderWoken)
+{
+  RingName ring_name;
+  ShmRing reader(ring_name.name, ShmRing::Role::kReader, 4, 1024);
+
+  pid_t child = fork();
+  if (child == 0) {
+    ShmRing writer(ring_name.name, ShmRing::Role::kWriter, 4, 1024);
+    std::this_thread::sleep_for(50ms);
+    write_tpset(writer, make_tpset(1, 7));
+    _exit(0);
+  }
+  BOOST_REQUIRE(child > 0);
+
+  Set<TriggerPrimitive> tpset;
+  auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK(read_tpset(reader, tpset, 5000ms));
+  BOOST_CHECK_EQUAL(tpset.seqno, 7);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < 2000ms);
+  int status = 0;
+  waitpid(child, &status, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+/**
+ * @file SpeedProfile_test.cxx  SpeedProfile class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/SpeedProfile.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE SpeedProfile_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+BOOST_AUTO_TEST_CASE(Constant)
+{
+  SpeedProfile profile(2.5);
+  BOOST_CHECK_EQUAL(profile.get_n_steps(), 1);
+  BOOST_CHECK_EQUAL(profile.get_step_index(0s), 0);
+  BOOST_CHECK_EQUAL(profile.get_step_index(1000s), 0);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(0s), 2.5, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(1000s), 2.5, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(LinearRamp)
+{
+  auto profile = SpeedProfile::linear_ramp(1.0, 10.0, 9s, 3);
+  // Three ramp steps plus the final step holding the end factor
+  BOOST_REQUIRE_EQUAL(profile.get_n_steps(), 4);
+
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(0s), 1.0, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(1500ms), 2.5, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(3s), 4.0, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(8s), 9.0, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(100s), 10.0, 1e-9);
+
+  BOOST_CHECK_EQUAL(profile.get_step_index(2999ms), 0);
+  BOOST_CHECK_EQUAL(profile.get_step_index(3s), 1);
+  BOOST_CHECK_EQUAL(profile.get_step_index(8s), 2);
+  BOOST_CHECK_EQUAL(profile.get_step_index(9s), 3);
+  BOOST_CHECK_CLOSE(profile.get_step(1).start_factor, 4.0, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_step(1).end_factor, 7.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(Steps)
+{
+  SpeedProfile profile(std::vector<SpeedProfile::Step>{ { 1.0, 1.0, 2s }, { 5.0, 5.0, 0s }, { 3.0, 3.0, 1s } });
+  // The zero-length step is dropped
+  BOOST_REQUIRE_EQUAL(profile.get_n_steps(), 3);
+
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(1s), 1.0, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(2500ms), 3.0, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_speed_factor(10s), 3.0, 1e-9);
+  BOOST_CHECK_EQUAL(profile.get_step_index(1s), 0);
+  BOOST_CHECK_EQUAL(profile.get_step_index(2500ms), 1);
+  BOOST_CHECK_EQUAL(profile.get_step_index(10s), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
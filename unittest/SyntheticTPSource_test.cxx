@@ -0,0 +1,122 @@
+/**
+ * @file SyntheticTPSource_test.cxx  SyntheticTPSource class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/SyntheticTPSource.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE SyntheticTPSource_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <vector>
+
+using namespace dunedaq::trigger;
+using TriggerPrimitive = SyntheticTPSource::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+
+SyntheticTPSource::Params
+make_params()
+{
+  SyntheticTPSource::Params params;
+  params.first_channel = 1000;
+  params.n_channels = 500;
+  params.clock_frequency_hz = 50'000'000;
+  params.noise_rate_hz = 100;
+  params.burst_rate_hz = 5;
+  params.burst_duration_ticks = 1'000'000;
+  params.burst_noise_factor = 10;
+  params.cluster_rate_hz = 50;
+  params.cluster_mean_n_tps = 10;
+  params.cluster_channel_spread = 3;
+  params.cluster_time_spread_ticks = 500;
+  params.track_rate_hz = 20;
+  params.track_n_channels = 100;
+  params.track_ticks_per_channel = 200;
+  params.seed = 42;
+  return params;
+}
+
+std::vector<TriggerPrimitive>
+generate_all(SyntheticTPSource& source, uint64_t start, uint64_t width, size_t n_windows) // NOLINT(build/unsigned)
+{
+  std::vector<TriggerPrimitive> all_tps;
+  for (size_t i = 0; i < n_windows; ++i) {
+    std::vector<TriggerPrimitive> tps;
+    uint64_t window_start = start + i * width; // NOLINT(build/unsigned)
+    source.generate(window_start, window_start + width, tps);
+    for (size_t j = 0; j < tps.size(); ++j) {
+      BOOST_REQUIRE(tps[j].time_start >= window_start);
+      BOOST_REQUIRE(tps[j].time_start < window_start + width);
+      if (j > 0) {
+        BOOST_REQUIRE(tps[j].time_start >= tps[j - 1].time_start);
+      }
+    }
+    all_tps.insert(all_tps.end(), tps.begin(), tps.end());
+  }
+  return all_tps;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Deterministic)
+{
+  SyntheticTPSource source1(make_params(), 1'000'000);
+  SyntheticTPSource source2(make_params(), 1'000'000);
+  auto tps1 = generate_all(source1, 1'000'000, 10'000, 500);
+  auto tps2 = generate_all(source2, 1'000'000, 10'000, 500);
+  BOOST_REQUIRE_EQUAL(tps1.size(), tps2.size());
+  for (size_t i = 0; i < tps1.size(); ++i) {
+    BOOST_CHECK_EQUAL(tps1[i].time_start, tps2[i].time_start);
+    BOOST_CHECK_EQUAL(tps1[i].channel, tps2[i].channel);
+  }
+
+  auto params = make_params();
+  params.seed = 43;
+  SyntheticTPSource source3(params, 1'000'000);
+  auto tps3 = generate_all(source3, 1'000'000, 10'000, 500);
+  BOOST_CHECK(tps3.size() != tps1.size() || tps3.front().time_start != tps1.front().time_start);
+}
+
+BOOST_AUTO_TEST_CASE(NoiseRate)
+{
+  auto params = make_params();
+  params.burst_rate_hz = 0;
+  params.cluster_rate_hz = 0;
+  params.track_rate_hz = 0;
+  SyntheticTPSource source(params, 0);
+
+  // 0.1 s of data at 100 Hz on each of 500 channels: 5000 TPs expected
+  auto tps = generate_all(source, 0, 10'000, 500);
+  BOOST_CHECK(tps.size() > 4700 && tps.size() < 5300);
+  for (auto const& tp : tps) {
+    BOOST_REQUIRE(tp.channel >= 1000 && tp.channel < 1500);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ClustersTracksAndBursts)
+{
+  auto params = make_params();
+  params.noise_rate_hz = 0;
+  SyntheticTPSource source(params, 0);
+
+  // 1 s of data
+  auto tps = generate_all(source, 0, 50'000, 1000);
+  BOOST_CHECK(source.get_n_clusters() > 30 && source.get_n_clusters() < 75);
+  BOOST_CHECK(source.get_n_tracks() > 8 && source.get_n_tracks() < 35);
+  BOOST_CHECK(source.get_n_bursts() > 0);
+  // No noise, so only cluster and track TPs. The TPs still pending at the end make this an upper bound
+  BOOST_CHECK(tps.size() <= source.get_n_tracks() * 100 + source.get_n_clusters() * 40);
+  BOOST_CHECK(tps.size() >= (source.get_n_tracks() - 1) * 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
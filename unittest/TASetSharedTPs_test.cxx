@@ -0,0 +1,158 @@
+/**
+ * @file TASetSharedTPs_test.cxx  Unit tests for TASetSharedTPs
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TASet.hpp"
+#include "trigger/TASetSharedTPs.hpp"
+#include "triggeralgs/Types.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TASetSharedTPs_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <vector>
+
+using namespace dunedaq;
+using triggeralgs::TriggerActivity;
+using triggeralgs::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+TriggerPrimitive
+make_tp(triggeralgs::timestamp_t time, triggeralgs::channel_t channel)
+{
+  TriggerPrimitive tp;
+  tp.time_start = time;
+  tp.time_peak = time + 5;
+  tp.time_over_threshold = 10;
+  tp.channel = channel;
+  tp.adc_integral = 1000;
+  return tp;
+}
+
+// n_tas TAs of 10 TPs each, where each TA shares half of its TPs with the next
+trigger::TASet
+make_overlapping_taset(size_t n_tas)
+{
+  std::vector<TriggerPrimitive> tps;
+  for (size_t i = 0; i < 5 * n_tas + 5; ++i) {
+    tps.push_back(make_tp(1000 + 10 * i, i % 7));
+  }
+  trigger::TASet taset;
+  taset.seqno = 3;
+  taset.start_time = 1000;
+  taset.end_time = 2000;
+  for (size_t i = 0; i < n_tas; ++i) {
+    TriggerActivity ta;
+    ta.time_start = tps[5 * i].time_start;
+    ta.channel_start = i;
+    ta.inputs.assign(tps.begin() + 5 * i, tps.begin() + 5 * i + 10);
+    taset.objects.push_back(ta);
+  }
+  return taset;
+}
+
+void
+check_same_tps(const std::vector<TriggerPrimitive>& a, const std::vector<TriggerPrimitive>& b)
+{
+  BOOST_REQUIRE_EQUAL(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    BOOST_CHECK_EQUAL(a[i].time_start, b[i].time_start);
+    BOOST_CHECK_EQUAL(a[i].channel, b[i].channel);
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SharedTPsStoredOnce)
+{
+  auto taset = make_overlapping_taset(4);
+  auto shared = trigger::TASetSharedTPs::from_taset(taset);
+
+  BOOST_CHECK(shared.is_consistent());
+  BOOST_CHECK_EQUAL(shared.size(), 4);
+  BOOST_CHECK_EQUAL(shared.tps.size(), 25);
+  BOOST_CHECK_EQUAL(shared.input_indices.size(), 40);
+  BOOST_CHECK_EQUAL(shared.seqno, taset.seqno);
+  BOOST_CHECK_EQUAL(shared.end_time, taset.end_time);
+
+  for (size_t i = 0; i < shared.size(); ++i) {
+    BOOST_CHECK_EQUAL(shared.get_n_inputs(i), 10);
+    BOOST_CHECK_EQUAL(shared.activities[i].channel_start, taset.objects[i].channel_start);
+    check_same_tps(shared.get_inputs(i), taset.objects[i].inputs);
+  }
+
+  size_t n_visited = 0;
+  shared.for_each_input(2, [&](const TriggerPrimitive& tp) {
+    BOOST_CHECK_EQUAL(tp.time_start, taset.objects[2].inputs[n_visited].time_start);
+    ++n_visited;
+  });
+  BOOST_CHECK_EQUAL(n_visited, 10);
+}
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  for (size_t n_tas : { 0, 1, 10 }) {
+    auto taset = make_overlapping_taset(n_tas);
+    auto taset_back = trigger::TASetSharedTPs::from_taset(taset).to_taset();
+    BOOST_CHECK_EQUAL(taset_back.seqno, taset.seqno);
+    BOOST_CHECK_EQUAL(taset_back.start_time, taset.start_time);
+    BOOST_REQUIRE_EQUAL(taset_back.objects.size(), taset.objects.size());
+    for (size_t i = 0; i < taset.objects.size(); ++i) {
+      BOOST_CHECK_EQUAL(taset_back.objects[i].time_start, taset.objects[i].time_start);
+      check_same_tps(taset_back.objects[i].inputs, taset.objects[i].inputs);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DistinctTPsNotMerged)
+{
+  // Same time and channel, but a different ADC: not the same TP
+  trigger::TASet taset;
+  TriggerActivity ta;
+  ta.inputs.push_back(make_tp(1000, 1));
+  ta.inputs.push_back(make_tp(1000, 1));
+  ta.inputs.back().adc_integral = 2000;
+  ta.inputs.push_back(make_tp(1000, 1));
+  taset.objects.push_back(ta);
+
+  auto shared = trigger::TASetSharedTPs::from_taset(taset);
+  BOOST_CHECK_EQUAL(shared.tps.size(), 2);
+  auto inputs = shared.get_inputs(0);
+  BOOST_REQUIRE_EQUAL(inputs.size(), 3);
+  BOOST_CHECK_EQUAL(inputs[1].adc_integral, 2000);
+  BOOST_CHECK_EQUAL(inputs[2].adc_integral, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(Consistency)
+{
+  auto shared = trigger::TASetSharedTPs::from_taset(make_overlapping_taset(2));
+  BOOST_CHECK(shared.is_consistent());
+
+  auto bad_index = shared;
+  bad_index.input_indices.back() = bad_index.tps.size();
+  BOOST_CHECK(!bad_index.is_consistent());
+
+  auto bad_offsets = shared;
+  bad_offsets.input_offsets.pop_back();
+  BOOST_CHECK(!bad_offsets.is_consistent());
+}
+
+BOOST_AUTO_TEST_CASE(WireFormatScope)
+{
+  BOOST_CHECK(trigger::get_taset_wire_format() == trigger::TASetWireFormat::kMsgPack);
+  {
+    trigger::TASetWireFormatScope scope(trigger::TASetWireFormat::kSharedTPs);
+    BOOST_CHECK(trigger::get_taset_wire_format() == trigger::TASetWireFormat::kSharedTPs);
+  }
+  BOOST_CHECK(trigger::get_taset_wire_format() == trigger::TASetWireFormat::kMsgPack);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
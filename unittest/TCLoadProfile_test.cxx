@@ -0,0 +1,194 @@
+/**
+ * @file TCLoadProfile_test.cxx  TCLoadProfile class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TCLoadProfile.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TCLoadProfile_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using TriggerCandidate = TCLoadProfile::TriggerCandidate;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+
+std::vector<TriggerCandidate>
+generate_until(TCLoadProfile& profile, TCLoadProfile::timestamp_t end_time)
+{
+  std::vector<TriggerCandidate> tcs;
+  while (true) {
+    auto tc = profile.next();
+    if (tc.time_candidate >= end_time) {
+      return tcs;
+    }
+    tcs.push_back(tc);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(UniformBackground)
+{
+  TCLoadProfile::Params params;
+  params.clock_frequency_hz = 1000;
+  params.start_rate_hz = 10;
+  params.end_rate_hz = 10;
+  params.poisson = false;
+  params.window_ticks = 20;
+  params.window_pre_fraction = 0.25;
+
+  TCLoadProfile profile(params, 5000);
+  auto tcs = generate_until(profile, 6000);
+  BOOST_REQUIRE_EQUAL(tcs.size(), 9);
+  for (size_t i = 0; i < tcs.size(); ++i) {
+    BOOST_CHECK_EQUAL(tcs[i].time_candidate, 5100 + 100 * i);
+    BOOST_CHECK_EQUAL(tcs[i].time_start, tcs[i].time_candidate - 5);
+    BOOST_CHECK_EQUAL(tcs[i].time_end, tcs[i].time_candidate + 15);
+    BOOST_CHECK(tcs[i].type == TriggerCandidate::Type::kRandom);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RateRamp)
+{
+  TCLoadProfile::Params params;
+  params.clock_frequency_hz = 1'000'000;
+  params.start_rate_hz = 100;
+  params.end_rate_hz = 1000;
+  params.ramp_duration_s = 10;
+  params.seed = 7;
+
+  TCLoadProfile profile(params, 0);
+  BOOST_CHECK_CLOSE(profile.get_rate_hz(0), 100, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_rate_hz(5'000'000), 550, 1e-9);
+  BOOST_CHECK_CLOSE(profile.get_rate_hz(50'000'000), 1000, 1e-9);
+
+  auto tcs = generate_until(profile, 20'000'000);
+  size_t n_first_second = 0;
+  size_t n_last_second = 0;
+  for (auto const& tc : tcs) {
+    n_first_second += tc.time_candidate < 1'000'000;
+    n_last_second += tc.time_candidate >= 19'000'000;
+  }
+  // Expect about 145 in the first second, and 1000 in the last
+  BOOST_CHECK(n_first_second > 100 && n_first_second < 200);
+  BOOST_CHECK(n_last_second > 900 && n_last_second < 1100);
+}
+
+BOOST_AUTO_TEST_CASE(TrainsAndStorms)
+{
+  TCLoadProfile::Params params;
+  params.clock_frequency_hz = 1000;
+  params.start_rate_hz = 0;
+  params.end_rate_hz = 0;
+  params.window_ticks = 10;
+  // A train of 3 TCs every second, and a storm of 5 overlapping TCs every 2 seconds
+  params.trains = { { 0.5, 1.0, 3, 100, 0 }, { 0.25, 2.0, 5, 10, 50 } };
+
+  TCLoadProfile profile(params, 0);
+  auto tcs = generate_until(profile, 4000);
+  BOOST_REQUIRE_EQUAL(tcs.size(), 4 * 3 + 2 * 5);
+  BOOST_CHECK_EQUAL(profile.get_n_background(), 0);
+  // Including the first TC after the end time
+  BOOST_CHECK_EQUAL(profile.get_n_train_tcs(), tcs.size() + 1);
+
+  for (size_t i = 1; i < tcs.size(); ++i) {
+    BOOST_CHECK(tcs[i].time_candidate >= tcs[i - 1].time_candidate);
+  }
+  std::vector<TCLoadProfile::timestamp_t> first_times;
+  for (size_t i = 0; i < 8; ++i) {
+    first_times.push_back(tcs[i].time_candidate);
+  }
+  BOOST_CHECK((first_times == std::vector<TCLoadProfile::timestamp_t>{ 250, 260, 270, 280, 290, 500, 600, 700 }));
+  // The storm's windows overlap
+  BOOST_CHECK(tcs[1].time_start < tcs[0].time_end);
+  BOOST_CHECK_EQUAL(tcs[0].time_end - tcs[0].time_start, 50);
+  BOOST_CHECK_EQUAL(tcs[5].time_end - tcs[5].time_start, 10);
+}
+
+BOOST_AUTO_TEST_CASE(TypeMixAndWindows)
+{
+  TCLoadProfile::Params params;
+  params.clock_frequency_hz = 1'000'000;
+  params.start_rate_hz = 10000;
+  params.end_rate_hz = 10000;
+  params.type_mix = { { TriggerCandidate::Type::kTiming, 3 }, { TriggerCandidate::Type::kSupernova, 1 } };
+  params.window_distribution = TCLoadProfile::WindowDistribution::kUniform;
+  params.min_window_ticks = 100;
+  params.max_window_ticks = 200;
+  params.seed = 3;
+
+  TCLoadProfile profile(params, 0);
+  auto tcs = generate_until(profile, 1'000'000);
+  BOOST_REQUIRE(tcs.size() > 9000);
+
+  std::map<TriggerCandidate::Type, size_t> type_counts;
+  for (auto const& tc : tcs) {
+    ++type_counts[tc.type];
+    auto window = tc.time_end - tc.time_start;
+    BOOST_CHECK(window >= 100 && window <= 200);
+  }
+  BOOST_CHECK_EQUAL(type_counts.size(), 2);
+  double timing_fraction = static_cast<double>(type_counts[TriggerCandidate::Type::kTiming]) / tcs.size();
+  BOOST_CHECK(timing_fraction > 0.72 && timing_fraction < 0.78);
+}
+
+BOOST_AUTO_TEST_CASE(Deterministic)
+{
+  TCLoadProfile::Params params;
+  params.start_rate_hz = 50;
+  params.end_rate_hz = 50;
+  params.window_distribution = TCLoadProfile::WindowDistribution::kExponential;
+  params.window_ticks = 1000;
+  params.max_window_ticks = 5000;
+  params.seed = 11;
+
+  TCLoadProfile profile1(params, 12345);
+  TCLoadProfile profile2(params, 12345);
+  for (int i = 0; i < 100; ++i) {
+    auto tc1 = profile1.next();
+    auto tc2 = profile2.next();
+    BOOST_CHECK_EQUAL(tc1.time_candidate, tc2.time_candidate);
+    BOOST_CHECK_EQUAL(tc1.time_start, tc2.time_start);
+    BOOST_CHECK_EQUAL(tc1.time_end, tc2.time_end);
+    BOOST_CHECK(tc1.time_end - tc1.time_start <= 5000);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CheckParams)
+{
+  TCLoadProfile::Params params;
+  params.clock_frequency_hz = 1000;
+  params.trains = { { 0.5, 1.0, 10, 100, 0 } };
+  // Exactly n_tcs * spacing_ticks is fine: the next train starts one spacing after the last TC
+  BOOST_CHECK_EQUAL(TCLoadProfile::check_params(params), "");
+
+  params.trains[0].spacing_ticks = 101;
+  BOOST_CHECK(TCLoadProfile::check_params(params).find("train 0") != std::string::npos);
+
+  params.trains[0].spacing_ticks = 100;
+  params.end_rate_hz = -1;
+  BOOST_CHECK(!TCLoadProfile::check_params(params).empty());
+}
+
+BOOST_AUTO_TEST_CASE(AlgorithmIsCustom)
+{
+  TCLoadProfile::Params params;
+  TCLoadProfile profile(params, 0);
+  BOOST_CHECK(profile.next().algorithm == TriggerCandidate::Algorithm::kCustom);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,155 @@
+/**
+ * @file TPReplayFile_test.cxx  TPReplayFile class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPReplayFile.hpp"
+
+#include "trigger/Issues.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TPReplayFile_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+
+std::string
+temp_filename()
+{
+  return "/tmp/TPReplayFile_test_" + std::to_string(getpid()) + ".tpbin";
+}
+
+// Write TPs with time_start = 0, 100, 200, ... 9900 and channel = index
+void
+write_test_file(const std::string& filename, uint64_t width, uint64_t offset) // NOLINT(build/unsigned)
+{
+  TPReplayFileWriter writer(filename, width, offset);
+  for (int i = 0; i < 100; ++i) {
+    TriggerPrimitive tp;
+    tp.time_start = 100 * i;
+    tp.time_peak = tp.time_start + 10;
+    tp.channel = i;
+    BOOST_CHECK(writer.add(tp));
+  }
+  // An out-of-order TP is rejected
+  TriggerPrimitive late;
+  late.time_start = 50;
+  BOOST_CHECK(!writer.add(late));
+  writer.close();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  std::string filename = temp_filename();
+  write_test_file(filename, 1000, 0);
+
+  TPReplayFile file(filename);
+  BOOST_CHECK_EQUAL(file.get_n_tps(), 100);
+  BOOST_REQUIRE_EQUAL(file.get_n_sets(), 10);
+
+  size_t n_seen = 0;
+  for (size_t i = 0; i < file.get_n_sets(); ++i) {
+    auto const& set = file.get_set(i);
+    BOOST_CHECK_EQUAL(set.start_time, 1000 * i);
+    BOOST_CHECK_EQUAL(set.n_tps, 10);
+    const TriggerPrimitive* tps = file.get_tps(set);
+    for (size_t j = 0; j < set.n_tps; ++j) {
+      BOOST_CHECK_EQUAL(static_cast<size_t>(tps[j].channel), n_seen);
+      BOOST_CHECK_EQUAL(tps[j].time_start, 100 * n_seen);
+      BOOST_CHECK(tps[j].time_start >= set.start_time && tps[j].time_start < set.start_time + 1000);
+      ++n_seen;
+    }
+  }
+  BOOST_CHECK_EQUAL(n_seen, 100);
+
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(Reindex)
+{
+  std::string filename = temp_filename();
+  write_test_file(filename, 1000, 0);
+
+  TPReplayFile file(filename);
+  // A different width and offset than the file was written with:
+  // sets are [n*2500 + 500, (n+1)*2500 + 500)
+  file.index_sets(2500, 500);
+
+  BOOST_REQUIRE_EQUAL(file.get_n_sets(), 5);
+  std::vector<uint64_t> expected_n_tps{ 20, 25, 25, 25, 5 }; // NOLINT(build/unsigned)
+  uint64_t first_tp = 0;                                      // NOLINT(build/unsigned)
+  for (size_t i = 0; i < file.get_n_sets(); ++i) {
+    auto const& set = file.get_set(i);
+    BOOST_CHECK_EQUAL(set.start_time, 2500 * i + 500);
+    BOOST_CHECK_EQUAL(set.first_tp, first_tp);
+    BOOST_CHECK_EQUAL(set.n_tps, expected_n_tps[i]);
+    first_tp += set.n_tps;
+  }
+
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(LoadIntoMemory)
+{
+  std::string filename = temp_filename();
+  write_test_file(filename, 1000, 0);
+
+  TPReplayFile file(filename);
+  file.load_into_memory(-1);
+  // The file isn't needed once it's loaded
+  std::remove(filename.c_str());
+  BOOST_CHECK(file.describe_memory().find("loaded into") == 0);
+
+  BOOST_REQUIRE_EQUAL(file.get_n_sets(), 10);
+  size_t n_seen = 0;
+  for (size_t i = 0; i < file.get_n_sets(); ++i) {
+    auto const& set = file.get_set(i);
+    const TriggerPrimitive* tps = file.get_tps(set);
+    for (size_t j = 0; j < set.n_tps; ++j) {
+      BOOST_CHECK_EQUAL(tps[j].time_start, 100 * n_seen);
+      ++n_seen;
+    }
+  }
+  BOOST_CHECK_EQUAL(n_seen, 100);
+
+  // The stored index moved with the TPs
+  file.index_sets(2500, 500);
+  BOOST_CHECK_EQUAL(file.get_n_sets(), 5);
+  file.index_sets(1000, 0);
+  BOOST_CHECK_EQUAL(file.get_n_sets(), 10);
+  BOOST_CHECK_EQUAL(file.get_set(9).first_tp, 90);
+}
+
+BOOST_AUTO_TEST_CASE(BadFile)
+{
+  std::string filename = temp_filename();
+  {
+    std::ofstream f(filename);
+    f << "0 1 2 3 4 5 6 7" << std::endl;
+  }
+  BOOST_CHECK_THROW(TPReplayFile file(filename), dunedaq::trigger::BadTPReplayFile);
+  std::remove(filename.c_str());
+
+  BOOST_CHECK_THROW(TPReplayFile file("/nonexistent/file.tpbin"), dunedaq::trigger::BadTPReplayFile);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
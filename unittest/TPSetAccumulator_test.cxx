@@ -0,0 +1,99 @@
+/**
+ * @file TPSetAccumulator_test.cxx  TPSetAccumulator class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPSetAccumulator.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TPSetAccumulator_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <vector>
+
+using namespace dunedaq::trigger;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+
+std::vector<TriggerPrimitive>
+make_tps(std::vector<uint64_t> times) // NOLINT(build/unsigned)
+{
+  std::vector<TriggerPrimitive> tps;
+  for (auto t : times) {
+    TriggerPrimitive tp;
+    tp.time_start = t;
+    tps.push_back(tp);
+  }
+  return tps;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Batches)
+{
+  TPSetAccumulator accumulator(100, 0);
+  std::vector<TPSet> sets;
+
+  // Unordered within the batch. The set starting at 200 might still get more TPs
+  auto batch1 = make_tps({ 120, 10, 250, 50 });
+  accumulator.add(batch1.data(), batch1.size());
+  accumulator.emit_complete(sets);
+  BOOST_REQUIRE_EQUAL(sets.size(), 2);
+  BOOST_CHECK_EQUAL(sets[0].start_time, 0);
+  BOOST_CHECK_EQUAL(sets[0].end_time, 100);
+  BOOST_REQUIRE_EQUAL(sets[0].objects.size(), 2);
+  BOOST_CHECK_EQUAL(sets[0].objects[0].time_start, 10);
+  BOOST_CHECK_EQUAL(sets[0].objects[1].time_start, 50);
+  BOOST_CHECK_EQUAL(sets[1].start_time, 100);
+  BOOST_CHECK_EQUAL(sets[1].objects.size(), 1);
+
+  // 240 joins the pending set at 200. 90 is too late and is dropped.
+  // Nothing from 300 to 500 means no empty sets
+  sets.clear();
+  auto batch2 = make_tps({ 240, 90, 610 });
+  accumulator.add(batch2.data(), batch2.size());
+  accumulator.emit_complete(sets);
+  BOOST_REQUIRE_EQUAL(sets.size(), 1);
+  BOOST_CHECK_EQUAL(sets[0].start_time, 200);
+  BOOST_REQUIRE_EQUAL(sets[0].objects.size(), 2);
+  BOOST_CHECK_EQUAL(sets[0].objects[0].time_start, 240);
+  BOOST_CHECK_EQUAL(sets[0].objects[1].time_start, 250);
+  BOOST_CHECK_EQUAL(accumulator.get_n_dropped(), 1);
+
+  sets.clear();
+  accumulator.flush(sets);
+  BOOST_REQUIRE_EQUAL(sets.size(), 1);
+  BOOST_CHECK_EQUAL(sets[0].start_time, 600);
+
+  // Starting again accepts early times, and counts drops afresh
+  sets.clear();
+  accumulator.reset();
+  BOOST_CHECK_EQUAL(accumulator.get_n_dropped(), 0);
+  accumulator.add(batch1.data(), batch1.size());
+  accumulator.flush(sets);
+  BOOST_CHECK_EQUAL(sets.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(Offset)
+{
+  // Sets are [n*100 + 30, (n+1)*100 + 30), using the same formula as TriggerPrimitiveMaker
+  TPSetAccumulator accumulator(100, 30);
+  std::vector<TPSet> sets;
+  auto tps = make_tps({ 60, 75 });
+  accumulator.add(tps.data(), tps.size());
+  accumulator.flush(sets);
+  BOOST_REQUIRE_EQUAL(sets.size(), 2);
+  BOOST_CHECK_EQUAL(sets[0].start_time, 30);
+  BOOST_CHECK_EQUAL(sets[1].start_time, 130);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
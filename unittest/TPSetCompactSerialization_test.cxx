@@ -0,0 +1,105 @@
+/**
+ * @file TPSetCompactSerialization_test.cxx  Unit tests for the compact TPSet encoding
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/Issues.hpp"
+#include "trigger/TPSet.hpp"
+#include "trigger/TPSetCompactSerialization.hpp"
+#include "trigger/TPSetFlatSerialization.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TPSetCompactSerialization_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "TPSetTestHelpers.hpp"
+
+#include <limits>
+#include <vector>
+
+using namespace dunedaq;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+using dunedaq::trigger::make_tpset;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  for (size_t n_tps : { 0, 1, 100 }) {
+    auto tpset = make_tpset(n_tps);
+    auto bytes = trigger::serialize_compact_tpset(tpset);
+    BOOST_CHECK(trigger::is_compact_tpset(bytes.data(), bytes.size()));
+    BOOST_CHECK(!trigger::is_flat_tpset(bytes.data(), bytes.size()));
+    BOOST_CHECK_LE(bytes.size(), trigger::get_max_compact_tpset_size(n_tps));
+    check_equal(tpset, trigger::deserialize_compact_tpset(bytes.data(), bytes.size()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SmallerThanFlat)
+{
+  auto tpset = make_tpset(100);
+  auto compact_bytes = trigger::serialize_compact_tpset(tpset);
+  BOOST_CHECK_LT(compact_bytes.size() * 3, trigger::get_flat_tpset_size(tpset));
+}
+
+BOOST_AUTO_TEST_CASE(ExtremeValues)
+{
+  // TPs before the start of the set, channels going down, and values
+  // at the limits of their types all have to survive the deltas
+  auto tpset = make_tpset(0);
+  tpset.end_time = 0;
+  TriggerPrimitive tp;
+  tp.time_start = 0;
+  tp.time_peak = std::numeric_limits<decltype(tp.time_peak)>::max();
+  tp.time_over_threshold = std::numeric_limits<decltype(tp.time_over_threshold)>::max();
+  tp.channel = std::numeric_limits<decltype(tp.channel)>::max();
+  tp.adc_integral = std::numeric_limits<decltype(tp.adc_integral)>::max();
+  tp.adc_peak = std::numeric_limits<decltype(tp.adc_peak)>::max();
+  tp.detid = std::numeric_limits<decltype(tp.detid)>::max();
+  tp.flag = std::numeric_limits<decltype(tp.flag)>::max();
+  tpset.objects.push_back(tp);
+  tp.time_start = std::numeric_limits<decltype(tp.time_start)>::max();
+  tp.time_peak = 0;
+  tp.channel = std::numeric_limits<decltype(tp.channel)>::min();
+  tpset.objects.push_back(tp);
+
+  auto bytes = trigger::serialize_compact_tpset(tpset);
+  check_equal(tpset, trigger::deserialize_compact_tpset(bytes.data(), bytes.size()));
+}
+
+BOOST_AUTO_TEST_CASE(AppendToBuffer)
+{
+  std::vector<uint8_t> bytes{ 1, 2, 3 }; // NOLINT(build/unsigned)
+  auto tpset = make_tpset(10);
+  size_t n_written = trigger::serialize_compact_tpset(tpset, bytes);
+  BOOST_REQUIRE_EQUAL(bytes.size(), 3 + n_written);
+  BOOST_CHECK_EQUAL(bytes[0], 1);
+  check_equal(tpset, trigger::deserialize_compact_tpset(bytes.data() + 3, n_written));
+}
+
+BOOST_AUTO_TEST_CASE(BadData)
+{
+  auto bytes = trigger::serialize_compact_tpset(make_tpset(10));
+
+  BOOST_CHECK_THROW(trigger::deserialize_compact_tpset(bytes.data(), bytes.size() - 1), trigger::BadCompactTPSet);
+  BOOST_CHECK_THROW(trigger::deserialize_compact_tpset(bytes.data(), 3), trigger::BadCompactTPSet);
+
+  auto bad_version = bytes;
+  bad_version[4] = 99;
+  BOOST_CHECK(!trigger::is_compact_tpset(bad_version.data(), bad_version.size()));
+  BOOST_CHECK_THROW(trigger::deserialize_compact_tpset(bad_version.data(), bad_version.size()),
+                    trigger::BadCompactTPSet);
+
+  // A value that never ends
+  std::vector<uint8_t> endless(bytes.begin(), bytes.begin() + trigger::CompactTPSetFormat::s_preamble_size);
+  endless.insert(endless.end(), 20, 0xff);
+  BOOST_CHECK_THROW(trigger::deserialize_compact_tpset(endless.data(), endless.size()), trigger::BadCompactTPSet);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+/**
+ * @file TPSetFlatSerialization_test.cxx  Unit tests for the flat TPSet encoding
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/Issues.hpp"
+#include "trigger/TPSet.hpp"
+#include "trigger/TPSetFlatSerialization.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TPSetFlatSerialization_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "TPSetTestHelpers.hpp"
+
+#include <vector>
+
+using namespace dunedaq;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+using dunedaq::trigger::make_tpset;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  for (size_t n_tps : { 0, 1, 100 }) {
+    auto tpset = make_tpset(n_tps);
+    auto bytes = trigger::serialize_flat_tpset(tpset);
+    BOOST_CHECK_EQUAL(bytes.size(), trigger::get_flat_tpset_size(tpset));
+    BOOST_CHECK(trigger::is_flat_tpset(bytes.data(), bytes.size()));
+    check_equal(tpset, trigger::deserialize_flat_tpset(bytes.data(), bytes.size()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(UnalignedView)
+{
+  auto tpset = make_tpset(10);
+  auto bytes = trigger::serialize_flat_tpset(tpset);
+  // Shift the data by a byte, as it might be inside a message
+  std::vector<uint8_t> shifted(1); // NOLINT(build/unsigned)
+  shifted.insert(shifted.end(), bytes.begin(), bytes.end());
+
+  trigger::FlatTPSetView view(shifted.data() + 1, bytes.size());
+  BOOST_CHECK_EQUAL(view.header().seqno, tpset.seqno);
+  BOOST_REQUIRE_EQUAL(view.size(), tpset.objects.size());
+  for (size_t i = 0; i < view.size(); ++i) {
+    BOOST_CHECK_EQUAL(view[i].channel, tpset.objects[i].channel);
+  }
+  check_equal(tpset, view.to_tpset());
+}
+
+BOOST_AUTO_TEST_CASE(BadData)
+{
+  auto bytes = trigger::serialize_flat_tpset(make_tpset(10));
+
+  // Truncated in the header, and in the TPs
+  BOOST_CHECK(!trigger::is_flat_tpset(bytes.data(), sizeof(trigger::FlatTPSetHeader) - 1));
+  BOOST_CHECK_THROW(trigger::deserialize_flat_tpset(bytes.data(), sizeof(trigger::FlatTPSetHeader) - 1),
+                    trigger::BadFlatTPSet);
+  BOOST_CHECK_THROW(trigger::deserialize_flat_tpset(bytes.data(), bytes.size() - 1), trigger::BadFlatTPSet);
+
+  // Not a flat TPSet at all
+  auto bad_magic = bytes;
+  bad_magic[0] ^= 0xff;
+  BOOST_CHECK(!trigger::is_flat_tpset(bad_magic.data(), bad_magic.size()));
+  BOOST_CHECK_THROW(trigger::deserialize_flat_tpset(bad_magic.data(), bad_magic.size()), trigger::BadFlatTPSet);
+}
+
+BOOST_AUTO_TEST_CASE(WireFormatScope)
+{
+  BOOST_CHECK(trigger::get_tpset_wire_format() == trigger::TPSetWireFormat::kMsgPack);
+  {
+    trigger::TPSetWireFormatScope flat(trigger::TPSetWireFormat::kFlat);
+    BOOST_CHECK(trigger::get_tpset_wire_format() == trigger::TPSetWireFormat::kFlat);
+    {
+      trigger::TPSetWireFormatScope msgpack(trigger::TPSetWireFormat::kMsgPack);
+      BOOST_CHECK(trigger::get_tpset_wire_format() == trigger::TPSetWireFormat::kMsgPack);
+    }
+    BOOST_CHECK(trigger::get_tpset_wire_format() == trigger::TPSetWireFormat::kFlat);
+  }
+  BOOST_CHECK(trigger::get_tpset_wire_format() == trigger::TPSetWireFormat::kMsgPack);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+/**
+ * @file TPSetSoA_test.cxx  TPSetSoA class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPSetSoA.hpp"
+
+#include "triggeralgs/TriggerActivityMaker.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TPSetSoA_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "TPSetTestHelpers.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+// Makes one TA per TP, however the TPs are given to it
+class OneTAPerTPMaker : public triggeralgs::TriggerActivityMaker
+{
+public:
+  void operator()(const TriggerPrimitive& tp, std::vector<triggeralgs::TriggerActivity>& output_tas) override
+  {
+    triggeralgs::TriggerActivity ta;
+    ta.channel_start = tp.channel;
+    output_tas.push_back(ta);
+    ++n_tps;
+  }
+
+  size_t n_tps{ 0 };
+};
+
+// The same, but takes each slice whole
+class OneTAPerTPSliceMaker
+  : public OneTAPerTPMaker
+  , public TPSliceActivityMaker
+{
+public:
+  using OneTAPerTPMaker::operator();
+
+  void operator()(const TPSetSoA& slice, std::vector<triggeralgs::TriggerActivity>& output_tas) override
+  {
+    BOOST_CHECK(slice.is_consistent());
+    for (size_t i = 0; i < slice.size(); ++i) {
+      triggeralgs::TriggerActivity ta;
+      ta.channel_start = slice.channel[i];
+      output_tas.push_back(ta);
+    }
+    ++n_slices;
+  }
+
+  size_t n_slices{ 0 };
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  for (size_t n_tps : { 0, 1, 100 }) {
+    auto tpset = make_tpset(n_tps);
+    auto soa = TPSetSoA::from_tpset(tpset);
+    BOOST_CHECK(soa.is_consistent());
+    BOOST_REQUIRE_EQUAL(soa.size(), n_tps);
+    BOOST_CHECK_EQUAL(soa.seqno, tpset.seqno);
+    BOOST_CHECK_EQUAL(soa.run_number, tpset.run_number);
+    BOOST_CHECK(soa.type == tpset.type);
+    for (size_t i = 0; i < n_tps; ++i) {
+      BOOST_CHECK_EQUAL(soa.time_start[i], tpset.objects[i].time_start);
+      BOOST_CHECK_EQUAL(soa.channel[i], tpset.objects[i].channel);
+      BOOST_CHECK_EQUAL(soa.adc_integral[i], tpset.objects[i].adc_integral);
+    }
+
+    auto back = soa.to_tpset();
+    BOOST_CHECK_EQUAL(back.start_time, tpset.start_time);
+    BOOST_CHECK_EQUAL(back.end_time, tpset.end_time);
+    BOOST_REQUIRE_EQUAL(back.objects.size(), n_tps);
+    for (size_t i = 0; i < n_tps; ++i) {
+      check_same_tp(back.objects[i], tpset.objects[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PushBackAndReuse)
+{
+  auto tpset = make_tpset(10);
+  TPSetSoA soa;
+  for (auto const& tp : tpset.objects) {
+    soa.push_back(tp);
+  }
+  BOOST_CHECK(soa.is_consistent());
+  BOOST_REQUIRE_EQUAL(soa.size(), 10);
+  check_same_tp(soa.get_tp(7), tpset.objects[7]);
+
+  auto const* data = soa.channel.data();
+  soa.clear();
+  BOOST_CHECK(soa.empty());
+  soa.assign(make_tpset(5).objects);
+  BOOST_CHECK_EQUAL(soa.size(), 5);
+  BOOST_CHECK_EQUAL(soa.channel.data(), data);
+
+  soa.adc_peak.pop_back();
+  BOOST_CHECK(!soa.is_consistent());
+}
+
+BOOST_AUTO_TEST_CASE(SliceDispatch)
+{
+  TPSliceDispatcher dispatcher;
+  BOOST_CHECK(!dispatcher.takes_slices());
+
+  // A maker without the slice interface is left to be called one TP at a time
+  std::unique_ptr<triggeralgs::TriggerActivityMaker> maker = std::make_unique<OneTAPerTPMaker>();
+  dispatcher.set_maker(maker.get());
+  BOOST_CHECK(!dispatcher.takes_slices());
+
+  auto slice_maker = std::make_unique<OneTAPerTPSliceMaker>();
+  maker = nullptr;
+  dispatcher.set_maker(static_cast<triggeralgs::TriggerActivityMaker*>(slice_maker.get()));
+  BOOST_REQUIRE(dispatcher.takes_slices());
+
+  // Each slice is passed whole, with its TPs in order
+  std::vector<triggeralgs::TriggerActivity> tas;
+  for (size_t n_tps : { 20, 5 }) {
+    auto tpset = make_tpset(n_tps);
+    tas.clear();
+    dispatcher(tpset.objects, tas);
+    BOOST_REQUIRE_EQUAL(tas.size(), n_tps);
+    for (size_t i = 0; i < n_tps; ++i) {
+      BOOST_CHECK_EQUAL(tas[i].channel_start, tpset.objects[i].channel);
+    }
+  }
+  BOOST_CHECK_EQUAL(slice_maker->n_slices, 2);
+  BOOST_CHECK_EQUAL(slice_maker->n_tps, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
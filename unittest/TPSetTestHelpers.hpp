@@ -0,0 +1,86 @@
+/**
+ * @file TPSetTestHelpers.hpp  TPSets to test with, and checks on them, for the unit tests
+ *
+ * Include this after boost/test/unit_test.hpp, so that BOOST_TEST_MODULE
+ * is already defined
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGER_UNITTEST_TPSETTESTHELPERS_HPP_
+#define TRIGGER_UNITTEST_TPSETTESTHELPERS_HPP_
+
+#include "trigger/TPSet.hpp"
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstddef>
+
+namespace dunedaq::trigger {
+
+// A payload TPSet of n_tps TPs, spaced 10 ticks apart from start_time. Every
+// field of the TPs is set, and most vary from one TP to the next
+inline TPSet
+make_tpset(size_t n_tps, TPSet::seqno_t seqno = 42, TPSet::timestamp_t start_time = 100'000'000'000)
+{
+  using detdataformats::trigger::TriggerPrimitive;
+  TPSet tpset;
+  tpset.seqno = seqno;
+  tpset.run_number = 1234;
+  tpset.origin = daqdataformats::SourceID(daqdataformats::SourceID::Subsystem::kTrigger, 7);
+  tpset.type = TPSet::Type::kPayload;
+  tpset.start_time = start_time;
+  tpset.end_time = start_time + 10 * (n_tps + 1);
+  for (size_t i = 0; i < n_tps; ++i) {
+    TriggerPrimitive tp;
+    tp.time_start = start_time + 10 * i;
+    tp.time_peak = tp.time_start + 3;
+    tp.time_over_threshold = 7 + i;
+    tp.channel = 100 + i % 13;
+    tp.adc_integral = 5000 + i;
+    tp.adc_peak = 50 + i % 5;
+    tp.detid = 3;
+    tp.type = TriggerPrimitive::Type::kTPC;
+    tp.algorithm = TriggerPrimitive::Algorithm::kTPCDefault;
+    tp.flag = i % 2;
+    tpset.objects.push_back(tp);
+  }
+  return tpset;
+}
+
+inline void
+check_same_tp(const detdataformats::trigger::TriggerPrimitive& a, const detdataformats::trigger::TriggerPrimitive& b)
+{
+  BOOST_CHECK_EQUAL(a.time_start, b.time_start);
+  BOOST_CHECK_EQUAL(a.time_peak, b.time_peak);
+  BOOST_CHECK_EQUAL(a.time_over_threshold, b.time_over_threshold);
+  BOOST_CHECK_EQUAL(a.channel, b.channel);
+  BOOST_CHECK_EQUAL(a.adc_integral, b.adc_integral);
+  BOOST_CHECK_EQUAL(a.adc_peak, b.adc_peak);
+  BOOST_CHECK_EQUAL(a.detid, b.detid);
+  BOOST_CHECK(a.type == b.type);
+  BOOST_CHECK(a.algorithm == b.algorithm);
+  BOOST_CHECK_EQUAL(a.version, b.version);
+  BOOST_CHECK_EQUAL(a.flag, b.flag);
+}
+
+inline void
+check_equal(const TPSet& a, const TPSet& b)
+{
+  BOOST_CHECK_EQUAL(a.seqno, b.seqno);
+  BOOST_CHECK_EQUAL(a.run_number, b.run_number);
+  BOOST_CHECK(a.origin == b.origin);
+  BOOST_CHECK_EQUAL(a.type, b.type);
+  BOOST_CHECK_EQUAL(a.start_time, b.start_time);
+  BOOST_CHECK_EQUAL(a.end_time, b.end_time);
+  BOOST_REQUIRE_EQUAL(a.objects.size(), b.objects.size());
+  for (size_t i = 0; i < a.objects.size(); ++i) {
+    check_same_tp(a.objects[i], b.objects[i]);
+  }
+}
+
+} // namespace dunedaq::trigger
+
+#endif // TRIGGER_UNITTEST_TPSETTESTHELPERS_HPP_
@@ -0,0 +1,108 @@
+/**
+ * @file TPTextReader_test.cxx  TPTextReader class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TPTextReader.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TPTextReader_test // NOLINT
+
+#include "boost/test/data/test_case.hpp"
+#include "boost/test/unit_test.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+
+BOOST_TEST_DONT_PRINT_LOG_VALUE(TriggerPrimitive::Type)
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+
+std::string
+temp_filename()
+{
+  return "/tmp/TPTextReader_test_" + std::to_string(getpid()) + ".txt";
+}
+
+std::vector<TriggerPrimitive>
+read_all(const std::string& filename, size_t chunk_size)
+{
+  TPTextReader reader(filename, chunk_size);
+  BOOST_REQUIRE(reader.is_open());
+  std::vector<TriggerPrimitive> tps;
+  TriggerPrimitive tp;
+  while (reader.next(tp)) {
+    tps.push_back(tp);
+  }
+  return tps;
+}
+
+} // namespace
+
+// Small chunk sizes put chunk boundaries in the middle of fields
+BOOST_DATA_TEST_CASE(ReadAll, boost::unit_test::data::make({ 1, 3, 7, 64, 4096 }), chunk_size)
+{
+  std::string filename = temp_filename();
+  const int n_tps = 50;
+  {
+    std::ofstream f(filename);
+    for (int i = 0; i < n_tps; ++i) {
+      // Mix of tab, space and newline separators, as produced by the various writers
+      f << "\t" << 1000000 + i << "\t" << 20 << " " << 1000005 + i << "\t" << 100 + i << "\t" << 5000 + i << "\t" << 30
+        << "\t" << 3 << "\t" << 1 << std::endl;
+    }
+  }
+
+  auto tps = read_all(filename, chunk_size);
+  BOOST_REQUIRE_EQUAL(tps.size(), n_tps);
+  for (int i = 0; i < n_tps; ++i) {
+    BOOST_CHECK_EQUAL(tps[i].time_start, 1000000 + i);
+    BOOST_CHECK_EQUAL(tps[i].time_over_threshold, 20);
+    BOOST_CHECK_EQUAL(tps[i].time_peak, 1000005 + i);
+    BOOST_CHECK_EQUAL(tps[i].channel, 100 + i);
+    BOOST_CHECK_EQUAL(tps[i].adc_integral, 5000 + i);
+    BOOST_CHECK_EQUAL(tps[i].adc_peak, 30);
+    BOOST_CHECK_EQUAL(tps[i].detid, 3);
+    BOOST_CHECK_EQUAL(tps[i].type, TriggerPrimitive::Type::kTPC);
+  }
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(StopsAtBadField)
+{
+  std::string filename = temp_filename();
+  {
+    std::ofstream f(filename);
+    f << "1 2 3 4 5 6 7 1\n"
+      << "8 9 10 11 12 13 14 1\n"
+      << "15 16 x 18 19 20 21 1\n"
+      << "22 23 24 25 26 27 28 1\n";
+  }
+  auto tps = read_all(filename, 4096);
+  BOOST_CHECK_EQUAL(tps.size(), 2);
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(MissingFile)
+{
+  TPTextReader reader("/nonexistent/file.txt");
+  BOOST_CHECK(!reader.is_open());
+  TriggerPrimitive tp;
+  BOOST_CHECK(!reader.next(tp));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
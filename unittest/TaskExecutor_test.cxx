@@ -0,0 +1,256 @@
+/**
+ * @file TaskExecutor_test.cxx  TaskExecutor class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TaskExecutor.hpp"
+#include "trigger/SetRing.hpp"
+#include "trigger/TPSet.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TaskExecutor_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+// Whether ready() became true within timeout
+bool
+wait_for(const std::function<bool()>& ready, std::chrono::milliseconds timeout = 5s)
+{
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!ready()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(RunsWhenNotified)
+{
+  TaskExecutor executor(2, "test");
+  BOOST_CHECK_EQUAL(executor.n_threads(), 2);
+
+  std::atomic<int> n_runs{ 0 };
+  auto task = executor.make_task("counter", [&] {
+    ++n_runs;
+    return false;
+  }, 1h);
+
+  // Stopped tasks ignore notifications
+  task->notify();
+  std::this_thread::sleep_for(20ms);
+  BOOST_CHECK_EQUAL(n_runs.load(), 0);
+
+  // Starting runs it once
+  executor.start_task(*task);
+  BOOST_REQUIRE(wait_for([&] { return n_runs.load() == 1; }));
+
+  task->notify();
+  BOOST_REQUIRE(wait_for([&] { return n_runs.load() == 2; }));
+  executor.stop_task(*task);
+
+  task->notify();
+  std::this_thread::sleep_for(20ms);
+  BOOST_CHECK_EQUAL(n_runs.load(), 2);
+  BOOST_CHECK_EQUAL(task->get_stats().runs, 2);
+}
+
+BOOST_AUTO_TEST_CASE(NeverRunsConcurrently)
+{
+  TaskExecutor executor(4, "test");
+  std::atomic<int> in_run{ 0 };
+  std::atomic<int> max_in_run{ 0 };
+  std::atomic<int> n_runs{ 0 };
+  auto task = executor.make_task("exclusive", [&] {
+    int n = ++in_run;
+    if (n > max_in_run.load()) {
+      max_in_run.store(n);
+    }
+    std::this_thread::sleep_for(10us);
+    --in_run;
+    ++n_runs;
+    return false;
+  }, 1h);
+  executor.start_task(*task);
+
+  std::vector<std::thread> notifiers;
+  for (int i = 0; i < 4; ++i) {
+    notifiers.emplace_back([&] {
+      for (int j = 0; j < 10000; ++j) {
+        task->notify();
+      }
+    });
+  }
+  for (auto& thread : notifiers) {
+    thread.join();
+  }
+  // A notification during a run makes it run again, so the last one isn't lost
+  int n_before = n_runs.load();
+  task->notify();
+  BOOST_REQUIRE(wait_for([&] { return n_runs.load() > n_before; }));
+  executor.stop_task(*task);
+
+  BOOST_CHECK_EQUAL(max_in_run.load(), 1);
+  // Notifications while it's already due to run are merged
+  BOOST_CHECK_LT(n_runs.load(), 40000);
+}
+
+BOOST_AUTO_TEST_CASE(PollsWhenIdle)
+{
+  TaskExecutor executor(1, "test");
+  std::atomic<int> n_runs{ 0 };
+  auto task = executor.make_task("poller", [&] {
+    ++n_runs;
+    return false;
+  }, 5ms);
+  executor.start_task(*task);
+  BOOST_CHECK(wait_for([&] { return n_runs.load() >= 10; }, 2s));
+  executor.stop_task(*task);
+  int n_stopped = n_runs.load();
+  std::this_thread::sleep_for(50ms);
+  BOOST_CHECK_EQUAL(n_runs.load(), n_stopped);
+
+  // It polls again once restarted
+  executor.start_task(*task);
+  BOOST_CHECK(wait_for([&] { return n_runs.load() >= n_stopped + 5; }, 2s));
+  executor.stop_task(*task);
+}
+
+BOOST_AUTO_TEST_CASE(RunsAgainWhileThereIsMore)
+{
+  TaskExecutor executor(2, "test");
+  std::atomic<int> n_left{ 1000 };
+  auto task = executor.make_task("batches", [&] { return --n_left > 0; }, 1h);
+  executor.start_task(*task);
+  BOOST_CHECK(wait_for([&] { return n_left.load() == 0; }));
+  executor.stop_task(*task);
+  BOOST_CHECK_EQUAL(task->get_stats().runs, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(StopWaitsForRun)
+{
+  TaskExecutor executor(2, "test");
+  std::atomic<bool> started{ false };
+  std::atomic<bool> finished{ false };
+  auto task = executor.make_task("slow", [&] {
+    started = true;
+    std::this_thread::sleep_for(100ms);
+    finished = true;
+    return true;
+  }, 1h);
+  executor.start_task(*task);
+  BOOST_REQUIRE(wait_for([&] { return started.load(); }));
+  executor.stop_task(*task);
+  BOOST_CHECK(finished.load());
+  // It wanted to run again, but was stopped
+  std::this_thread::sleep_for(150ms);
+  BOOST_CHECK_EQUAL(task->get_stats().runs, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ManyTasksShareThreads)
+{
+  TaskExecutor executor(2, "test");
+  const int n_tasks = 20;
+  std::atomic<int> n_runs{ 0 };
+  std::vector<std::shared_ptr<TaskExecutor::Task>> tasks;
+  for (int i = 0; i < n_tasks; ++i) {
+    tasks.push_back(executor.make_task("spin", [&] {
+      auto start = std::chrono::steady_clock::now();
+      while (std::chrono::steady_clock::now() - start < 100us) {
+      }
+      ++n_runs;
+      return false;
+    }, 1h));
+    executor.start_task(*tasks.back());
+  }
+  for (int round = 0; round < 50; ++round) {
+    for (auto& task : tasks) {
+      task->notify();
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  for (auto& task : tasks) {
+    executor.stop_task(*task);
+  }
+  BOOST_CHECK_GE(n_runs.load(), n_tasks);
+  auto stats = executor.get_stats();
+  BOOST_CHECK_EQUAL(stats.n_threads, 2);
+  BOOST_CHECK_EQUAL(stats.runs, static_cast<uint64_t>(n_runs.load()));
+  std::chrono::nanoseconds cpu_time(0);
+  for (auto& task : tasks) {
+    cpu_time += task->get_stats().cpu_time;
+  }
+  // Each run spun for 100 us
+  BOOST_CHECK_GE(cpu_time.count(), (n_runs.load() * 50us).count());
+}
+
+BOOST_AUTO_TEST_CASE(SetRingNotifiesConsumer)
+{
+  TaskExecutor executor(2, "test");
+  SetRing<TPSet> ring(64);
+  const size_t n_sets = 10000;
+  std::atomic<size_t> n_received{ 0 };
+  bool in_order = true;
+  auto task = executor.make_task("consumer", [&] {
+    TPSet tpset;
+    for (int i = 0; i < 16; ++i) {
+      if (!ring.try_pop(tpset)) {
+        return false;
+      }
+      in_order = in_order && tpset.seqno == n_received.load();
+      ++n_received;
+    }
+    return true;
+  }, 1h);
+  ring.set_consumer_task(task.get());
+  executor.start_task(*task);
+
+  std::atomic<bool> pushed_all{ true };
+  std::thread producer([&] {
+    for (size_t i = 0; i < n_sets; ++i) {
+      TPSet tpset;
+      tpset.seqno = i;
+      if (!ring.push(std::move(tpset), 1s)) {
+        pushed_all = false;
+      }
+    }
+  });
+  producer.join();
+  BOOST_REQUIRE(pushed_all.load());
+  // Without polling, only the ring's notifications run the consumer
+  BOOST_CHECK(wait_for([&] { return n_received.load() == n_sets; }));
+  executor.stop_task(*task);
+  ring.set_consumer_task(nullptr);
+  BOOST_CHECK(in_order);
+}
+
+BOOST_AUTO_TEST_CASE(ThreadCpuTime)
+{
+  auto start = get_thread_cpu_time();
+  auto wall_start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - wall_start < 20ms) {
+  }
+  BOOST_CHECK_GT((get_thread_cpu_time() - start).count(), std::chrono::nanoseconds(10ms).count());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
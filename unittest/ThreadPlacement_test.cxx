@@ -0,0 +1,113 @@
+/**
+ * @file ThreadPlacement_test.cxx  ThreadPlacement Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/ThreadPlacement.hpp"
+
+#include "trigger/Issues.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE ThreadPlacement_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+using namespace dunedaq::trigger;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+BOOST_AUTO_TEST_CASE(CPUList)
+{
+  BOOST_CHECK(parse_cpu_list("").empty());
+  std::vector<int> expected = { 0, 1, 2, 3, 8, 10, 11 };
+  auto cpus = parse_cpu_list("0-3,8, 10-11");
+  BOOST_CHECK_EQUAL_COLLECTIONS(cpus.begin(), cpus.end(), expected.begin(), expected.end());
+  BOOST_CHECK_EQUAL(format_cpu_list(cpus), "0-3,8,10-11");
+  BOOST_CHECK_EQUAL(format_cpu_list({ 5, 4, 4, 7 }), "4-5,7");
+
+  BOOST_CHECK_THROW(parse_cpu_list("1-"), InvalidThreadPlacement);
+  BOOST_CHECK_THROW(parse_cpu_list("3-1"), InvalidThreadPlacement);
+  BOOST_CHECK_THROW(parse_cpu_list("a"), InvalidThreadPlacement);
+  BOOST_CHECK_THROW(parse_cpu_list("1x"), InvalidThreadPlacement);
+  BOOST_CHECK_THROW(parse_cpu_list("-1"), InvalidThreadPlacement);
+}
+
+BOOST_AUTO_TEST_CASE(MakePlacement)
+{
+  auto placement = make_thread_placement("", -1);
+  BOOST_CHECK(placement.is_default());
+  BOOST_CHECK_THROW(make_thread_placement("100000", -1), InvalidThreadPlacement);
+  BOOST_CHECK_THROW(make_thread_placement("", 100000), InvalidThreadPlacement);
+}
+
+BOOST_AUTO_TEST_CASE(ApplyToThread)
+{
+  cpu_set_t allowed;
+  BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    ++cpu;
+  }
+  auto placement = make_thread_placement(std::to_string(cpu), -1);
+
+  cpu_set_t applied;
+  std::string description;
+  std::thread thread([&] {
+    apply_thread_placement(placement, "test");
+    pthread_getaffinity_np(pthread_self(), sizeof(applied), &applied);
+    description = describe_thread_placement();
+  });
+  thread.join();
+  BOOST_CHECK_EQUAL(CPU_COUNT(&applied), 1);
+  BOOST_CHECK(CPU_ISSET(cpu, &applied));
+  BOOST_CHECK_EQUAL(description.find("running on CPUs " + std::to_string(cpu)), 0);
+
+  // Every Linux machine with NUMA support has a node 0
+  ThreadPlacement node_placement;
+  try {
+    node_placement = make_thread_placement("", 0);
+  } catch (const InvalidThreadPlacement&) {
+    BOOST_TEST_MESSAGE("No NUMA support");
+    return;
+  }
+  std::thread node_thread([&] {
+    apply_thread_placement(node_placement, "test");
+    description = describe_thread_placement();
+  });
+  node_thread.join();
+  BOOST_CHECK_NE(description.find("memory preferred on NUMA node 0"), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(HugePages)
+{
+  const size_t size = (5 << 20) + 123;
+  HugePageBuffer buffer(size, -1);
+  BOOST_REQUIRE(buffer.data() != nullptr);
+  BOOST_CHECK_EQUAL(buffer.size(), size);
+  BOOST_TEST_MESSAGE(buffer.describe());
+  auto* bytes = static_cast<uint8_t*>(buffer.data()); // NOLINT(build/unsigned)
+  // Zero-filled, and all of it is usable
+  BOOST_CHECK_EQUAL(bytes[0], 0);
+  BOOST_CHECK_EQUAL(bytes[size - 1], 0);
+  std::memset(bytes, 0xab, size);
+  BOOST_CHECK_EQUAL(bytes[size - 1], 0xab);
+  if (buffer.backing() != HugePageBuffer::Backing::kNormal) {
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(buffer.data()) % (2 << 20), 0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
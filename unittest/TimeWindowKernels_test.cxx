@@ -0,0 +1,168 @@
+/**
+ * @file TimeWindowKernels_test.cxx  Time window kernel Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "trigger/TimeWindowKernels.hpp"
+
+#include "detdataformats/trigger/TriggerPrimitive.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TimeWindowKernels_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::trigger;
+using dunedaq::daqdataformats::timestamp_t;
+using dunedaq::detdataformats::trigger::TriggerPrimitive;
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+namespace {
+// Every instruction set this machine can run, with the original one restored at the end
+struct EachIsa
+{
+  EachIsa()
+    : original(get_time_window_isa())
+  {
+    for (auto isa : { TimeWindowIsa::kScalar, TimeWindowIsa::kAVX2, TimeWindowIsa::kAVX512 }) {
+      if (is_time_window_isa_supported(isa)) {
+        isas.push_back(isa);
+      }
+    }
+  }
+  ~EachIsa() { set_time_window_isa(original); }
+  TimeWindowIsa original;
+  std::vector<TimeWindowIsa> isas;
+};
+
+bool
+in_window(timestamp_t t, timestamp_t begin, timestamp_t end)
+{
+  return t >= begin && t <= end;
+}
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n, std::mt19937_64& rng)
+{
+  std::vector<TriggerPrimitive> tps(n);
+  std::uniform_int_distribution<timestamp_t> dist(0, 1000);
+  for (size_t i = 0; i < n; ++i) {
+    tps[i].time_start = dist(rng);
+    tps[i].channel = i;
+  }
+  return tps;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ScalarAlwaysSupported)
+{
+  BOOST_CHECK(is_time_window_isa_supported(TimeWindowIsa::kScalar));
+  BOOST_CHECK(is_time_window_isa_supported(get_time_window_isa()));
+  BOOST_TEST_MESSAGE("Using " << get_time_window_isa_name(get_time_window_isa()));
+}
+
+BOOST_AUTO_TEST_CASE(MatchesNaiveLoops)
+{
+  EachIsa each;
+  std::mt19937_64 rng(1234);
+  for (auto isa : each.isas) {
+    BOOST_REQUIRE(set_time_window_isa(isa));
+    BOOST_TEST_CONTEXT(get_time_window_isa_name(isa))
+    {
+      for (size_t n : { 0, 1, 3, 4, 7, 8, 9, 63, 64, 65, 200 }) {
+        auto tps = make_tps(n, rng);
+        std::vector<timestamp_t> column;
+        for (auto const& tp : tps) {
+          column.push_back(tp.time_start);
+        }
+        for (auto [begin, end] : { std::pair<timestamp_t, timestamp_t>{ 200, 700 },
+                                   { 0, 1000 },
+                                   { 500, 500 },
+                                   { 700, 200 } }) {
+          size_t expected_count = 0;
+          size_t expected_first_outside = n;
+          std::vector<TriggerPrimitive> expected_selection;
+          for (size_t i = 0; i < n; ++i) {
+            if (in_window(tps[i].time_start, begin, end)) {
+              ++expected_count;
+              expected_selection.push_back(tps[i]);
+            } else if (expected_first_outside == n) {
+              expected_first_outside = i;
+            }
+          }
+
+          BOOST_CHECK_EQUAL(count_in_time_window(tps.data(), n, begin, end), expected_count);
+          BOOST_CHECK_EQUAL(count_in_time_window(column.data(), 1, n, begin, end), expected_count);
+          BOOST_CHECK_EQUAL(find_outside_time_window(tps.data(), n, 0, begin, end), expected_first_outside);
+          BOOST_CHECK_EQUAL(find_outside_time_window(column.data(), 1, n, begin, end), expected_first_outside);
+
+          std::vector<TriggerPrimitive> selection;
+          BOOST_CHECK_EQUAL(select_in_time_window(tps.data(), n, begin, end, selection), expected_count);
+          BOOST_REQUIRE_EQUAL(selection.size(), expected_selection.size());
+          for (size_t i = 0; i < selection.size(); ++i) {
+            BOOST_CHECK_EQUAL(selection[i].channel, expected_selection[i].channel);
+          }
+
+          size_t n_mask = std::min<size_t>(n, 64);
+          uint64_t mask = time_window_mask(column.data(), 1, n_mask, begin, end); // NOLINT(build/unsigned)
+          for (size_t i = 0; i < 64; ++i) {
+            BOOST_CHECK_EQUAL((mask >> i & 1) != 0, i < n_mask && in_window(column[i], begin, end));
+          }
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExtremeTimestamps)
+{
+  EachIsa each;
+  const timestamp_t max = std::numeric_limits<timestamp_t>::max();
+  // These would compare the wrong way as signed numbers
+  std::vector<timestamp_t> times = { 0, 1, max / 2, max / 2 + 1, max - 1, max, 0, max };
+  for (auto isa : each.isas) {
+    BOOST_REQUIRE(set_time_window_isa(isa));
+    BOOST_TEST_CONTEXT(get_time_window_isa_name(isa))
+    {
+      BOOST_CHECK_EQUAL(count_in_time_window(times.data(), 1, times.size(), 0, max), 8);
+      BOOST_CHECK_EQUAL(count_in_time_window(times.data(), 1, times.size(), max / 2 + 1, max), 4);
+      BOOST_CHECK_EQUAL(count_in_time_window(times.data(), 1, times.size(), 1, max - 1), 4);
+      BOOST_CHECK_EQUAL(find_outside_time_window(times.data(), 1, times.size(), 0, max / 2), 3);
+      BOOST_CHECK_EQUAL(time_window_mask(times.data(), 1, times.size(), max, max), 0xa0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LowerBound)
+{
+  EachIsa each;
+  std::mt19937_64 rng(5678);
+  for (auto isa : each.isas) {
+    BOOST_REQUIRE(set_time_window_isa(isa));
+    BOOST_TEST_CONTEXT(get_time_window_isa_name(isa))
+    {
+      for (size_t n : { 0, 1, 5, 64, 65, 1000 }) {
+        auto tps = make_tps(n, rng);
+        std::sort(tps.begin(), tps.end(), [](auto const& a, auto const& b) { return a.time_start < b.time_start; });
+        for (timestamp_t t : { 0, 1, 250, 500, 999, 1000, 1001 }) {
+          auto it = std::lower_bound(
+            tps.begin(), tps.end(), t, [](auto const& tp, timestamp_t value) { return tp.time_start < value; });
+          BOOST_CHECK_EQUAL(lower_bound_time_start(tps.data(), n, t), static_cast<size_t>(it - tps.begin()));
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -129,46 +129,51 @@ BOOST_AUTO_TEST_CASE(ZipperScenario1)
   auto in = dunedaq::get_iom_sender<trigger::TPSet>("zipper_input");
   auto out = dunedaq::get_iom_receiver<trigger::TPSet>("zipper_output");
 
-  auto zip = std::make_unique<trigger::TPZipper>("zs1");
+  // The zipper should behave the same on its own thread and on the executor
+  for (bool use_executor : { false, true }) {
+    TLOG() << "Running the zipper " << (use_executor ? "on the executor" : "on its own thread");
+    auto zip = std::make_unique<trigger::TPZipper>("zs1");
 
-  zip->set_input("zipper_input");
-  zip->set_output("zipper_output");
+    zip->set_input("zipper_input");
+    zip->set_output("zipper_output");
 
-  trigger::TPZipper::cfg_t cfg{ 2, 2000, 1 };
-  nlohmann::json jcfg = cfg, jempty;
-  zip->do_configure(jcfg);
+    trigger::TPZipper::cfg_t cfg{ 2, 2000, 1 };
+    cfg.use_executor = use_executor;
+    nlohmann::json jcfg = cfg, jempty;
+    zip->do_configure(jcfg);
 
-  TPSetSrc s1{ 1 }, s2{ 2 };
+    TPSetSrc s1{ 1 }, s2{ 2 };
 
-  zip->do_start(jempty);
+    zip->do_start(jempty);
 
-  push0(in, s1(10));
-  push0(in, s2(12));
+    push0(in, s1(10));
+    push0(in, s2(12));
 
-  pop_must_timeout(out);
+    pop_must_timeout(out);
 
-  push0(in, s1(11));
-  push0(in, s2(13));
+    push0(in, s1(11));
+    push0(in, s2(13));
 
-  auto got = pop_must_succeed(out);
-  BOOST_CHECK_EQUAL(got.start_time, 10);
+    auto got = pop_must_succeed(out);
+    BOOST_CHECK_EQUAL(got.start_time, 10);
 
-  push0(in, s1(14));
+    push0(in, s1(14));
 
-  got = pop_must_succeed(out);
-  BOOST_CHECK_EQUAL(got.start_time, 11);
+    got = pop_must_succeed(out);
+    BOOST_CHECK_EQUAL(got.start_time, 11);
 
-  zip->do_stop(jempty); // triggers a flush
+    zip->do_stop(jempty); // triggers a flush
 
-  got = pop_must_succeed(out);
-  BOOST_CHECK_EQUAL(got.start_time, 12);
-  got = pop_must_succeed(out);
-  BOOST_CHECK_EQUAL(got.start_time, 13);
-  got = pop_must_succeed(out);
-  BOOST_CHECK_EQUAL(got.start_time, 14);
+    got = pop_must_succeed(out);
+    BOOST_CHECK_EQUAL(got.start_time, 12);
+    got = pop_must_succeed(out);
+    BOOST_CHECK_EQUAL(got.start_time, 13);
+    got = pop_must_succeed(out);
+    BOOST_CHECK_EQUAL(got.start_time, 14);
 
-  TLOG() << "Deleteing TriggerZipper";
-  zip.reset(nullptr);
+    TLOG() << "Deleteing TriggerZipper";
+    zip.reset(nullptr);
+  }
 }
 
 BOOST_AUTO_TEST_SUITE_END()